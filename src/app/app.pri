@@ -5,6 +5,7 @@ HEADERS += \
     $$PWD/applicationinstancemanager.h \
     $$PWD/cmdoptions.h \
     $$PWD/filelogger.h \
+    $$PWD/jsonlogwriter.h \
     $$PWD/qtlocalpeer/qtlocalpeer.h \
     $$PWD/upgrade.h
 
@@ -13,6 +14,7 @@ SOURCES += \
     $$PWD/applicationinstancemanager.cpp \
     $$PWD/cmdoptions.cpp \
     $$PWD/filelogger.cpp \
+    $$PWD/jsonlogwriter.cpp \
     $$PWD/main.cpp \
     $$PWD/qtlocalpeer/qtlocalpeer.cpp \
     $$PWD/upgrade.cpp
@@ -102,6 +102,7 @@ namespace
     const QString KEY_FILELOGGER_MAXSIZEBYTES = FILELOGGER_SETTINGS_KEY("MaxSizeBytes");
     const QString KEY_FILELOGGER_AGE = FILELOGGER_SETTINGS_KEY("Age");
     const QString KEY_FILELOGGER_AGETYPE = FILELOGGER_SETTINGS_KEY("AgeType");
+    const QString KEY_FILELOGGER_JSONENABLED = FILELOGGER_SETTINGS_KEY("JsonEnabled");
 
     // just a shortcut
     inline SettingsStorage *settings() { return  SettingsStorage::instance(); }
@@ -127,6 +128,7 @@ Application::Application(const QString &id, int &argc, char **argv)
 #endif
 {
     qRegisterMetaType<Log::Msg>("Log::Msg");
+    qRegisterMetaType<QVector<Log::Msg>>("QVector<Log::Msg>");
 
     setApplicationName("qBittorrent");
     setOrganizationDomain("qbittorrent.org");
@@ -161,8 +163,10 @@ Application::Application(const QString &id, int &argc, char **argv)
     connect(m_instanceManager, &ApplicationInstanceManager::messageReceived, this, &Application::processMessage);
     connect(this, &QCoreApplication::aboutToQuit, this, &Application::cleanup);
 
-    if (isFileLoggerEnabled())
+    if (isFileLoggerEnabled()) {
         m_fileLogger = new FileLogger(fileLoggerPath(), isFileLoggerBackup(), fileLoggerMaxSize(), isFileLoggerDeleteOld(), fileLoggerAge(), static_cast<FileLogger::FileLogAgeType>(fileLoggerAgeType()));
+        m_fileLogger->setJsonEnabled(isFileLoggerJsonEnabled());
+    }
 
     Logger::instance()->addMessage(tr("qBittorrent %1 started", "qBittorrent v3.2.0alpha started").arg(QBT_VERSION));
 }
@@ -193,10 +197,13 @@ bool Application::isFileLoggerEnabled() const
 
 void Application::setFileLoggerEnabled(const bool value)
 {
-    if (value && !m_fileLogger)
+    if (value && !m_fileLogger) {
         m_fileLogger = new FileLogger(fileLoggerPath(), isFileLoggerBackup(), fileLoggerMaxSize(), isFileLoggerDeleteOld(), fileLoggerAge(), static_cast<FileLogger::FileLogAgeType>(fileLoggerAgeType()));
-    else if (!value)
+        m_fileLogger->setJsonEnabled(isFileLoggerJsonEnabled());
+    }
+    else if (!value) {
         delete m_fileLogger;
+    }
     settings()->storeValue(KEY_FILELOGGER_ENABLED, value);
 }
 
@@ -273,6 +280,18 @@ void Application::setFileLoggerAgeType(const int value)
     settings()->storeValue(KEY_FILELOGGER_AGETYPE, ((value < 0) || (value > 2)) ? 1 : value);
 }
 
+bool Application::isFileLoggerJsonEnabled() const
+{
+    return settings()->loadValue(KEY_FILELOGGER_JSONENABLED, false).toBool();
+}
+
+void Application::setFileLoggerJsonEnabled(const bool value)
+{
+    if (m_fileLogger)
+        m_fileLogger->setJsonEnabled(value);
+    settings()->storeValue(KEY_FILELOGGER_JSONENABLED, value);
+}
+
 void Application::processMessage(const QString &message)
 {
     const QStringList params = message.split(PARAMS_SEPARATOR, QString::SkipEmptyParts);
@@ -102,6 +102,8 @@ public:
     void setFileLoggerAge(int value);
     int fileLoggerAgeType() const;
     void setFileLoggerAgeType(int value);
+    bool isFileLoggerJsonEnabled() const;
+    void setFileLoggerJsonEnabled(bool value);
 
 protected:
 #ifndef DISABLE_GUI
@@ -31,10 +31,19 @@
 #include <QDateTime>
 #include <QDir>
 #include <QTextStream>
+#include <QThread>
 
-#include "base/global.h"
 #include "base/logger.h"
 #include "base/utils/fs.h"
+#include "jsonlogwriter.h"
+
+namespace
+{
+    QString jsonLogPath(const QString &logPath)
+    {
+        return (Utils::Fs::branchPath(logPath) + QLatin1String("/qbittorrent.jsonl"));
+    }
+}
 
 FileLogger::FileLogger(const QString &path, const bool backup, const int maxSize, const bool deleteOld, const int age, const FileLogAgeType ageType)
     : m_backup(backup)
@@ -49,14 +58,17 @@ FileLogger::FileLogger(const QString &path, const bool backup, const int maxSize
         this->deleteOld(age, ageType);
 
     const Logger *const logger = Logger::instance();
-    for (const Log::Msg &msg : asConst(logger->getMessages()))
-        addLogMessage(msg);
+    addLogMessages(logger->getMessages());
 
-    connect(logger, &Logger::newLogMessage, this, &FileLogger::addLogMessage);
+    connect(logger, &Logger::newLogMessages, this, &FileLogger::addLogMessages);
 }
 
 FileLogger::~FileLogger()
 {
+    // write out whatever is still pending
+    Logger::instance()->flush();
+
+    stopJsonWriter();
     closeLogFile();
 }
 
@@ -72,6 +84,9 @@ void FileLogger::changePath(const QString &newPath)
         closeLogFile();
         m_logFile.setFileName(m_path);
         openLogFile();
+
+        if (m_jsonWriter)
+            QMetaObject::invokeMethod(m_jsonWriter, "changePath", Qt::QueuedConnection, Q_ARG(QString, jsonLogPath(m_path)));
     }
 }
 
@@ -79,7 +94,7 @@ void FileLogger::deleteOld(const int age, const FileLogAgeType ageType)
 {
     const QDateTime date = QDateTime::currentDateTime();
     const QDir dir(Utils::Fs::branchPath(m_path));
-    const QFileInfoList fileList = dir.entryInfoList(QStringList("qbittorrent.log.bak*")
+    const QFileInfoList fileList = dir.entryInfoList({QLatin1String("qbittorrent.log.bak*"), QLatin1String("qbittorrent.jsonl.bak*")}
         , (QDir::Files | QDir::Writable), (QDir::Time | QDir::Reversed));
 
     for (const QFileInfo &file : fileList) {
@@ -103,34 +118,77 @@ void FileLogger::deleteOld(const int age, const FileLogAgeType ageType)
 void FileLogger::setBackup(const bool value)
 {
     m_backup = value;
+    if (m_jsonWriter)
+        QMetaObject::invokeMethod(m_jsonWriter, "setBackup", Qt::QueuedConnection, Q_ARG(bool, value));
 }
 
 void FileLogger::setMaxSize(const int value)
 {
     m_maxSize = value;
+    if (m_jsonWriter)
+        QMetaObject::invokeMethod(m_jsonWriter, "setMaxSize", Qt::QueuedConnection, Q_ARG(int, value));
+}
+
+void FileLogger::setJsonEnabled(const bool value)
+{
+    if (!value) {
+        stopJsonWriter();
+        return;
+    }
+
+    if (m_jsonWriter) return;
+
+    m_jsonThread = new QThread(this);
+    m_jsonWriter = new JsonLogWriter(m_backup, m_maxSize);
+    m_jsonWriter->moveToThread(m_jsonThread);
+    connect(m_jsonThread, &QThread::finished, m_jsonWriter, &QObject::deleteLater);
+    m_jsonThread->start(QThread::LowPriority);
+
+    QMetaObject::invokeMethod(m_jsonWriter, "changePath", Qt::QueuedConnection, Q_ARG(QString, jsonLogPath(m_path)));
+    QMetaObject::invokeMethod(m_jsonWriter, "addLogMessages", Qt::QueuedConnection
+        , Q_ARG(QVector<Log::Msg>, Logger::instance()->getMessages()));
+    connect(Logger::instance(), &Logger::newLogMessages, m_jsonWriter, &JsonLogWriter::addLogMessages);
 }
 
-void FileLogger::addLogMessage(const Log::Msg &msg)
+void FileLogger::stopJsonWriter()
+{
+    if (!m_jsonWriter) return;
+
+    disconnect(Logger::instance(), nullptr, m_jsonWriter, nullptr);
+    // make sure the batches already queued are written out
+    QMetaObject::invokeMethod(m_jsonWriter, "closeLogFile", Qt::BlockingQueuedConnection);
+    m_jsonThread->quit();
+    m_jsonThread->wait();
+    delete m_jsonThread;
+
+    m_jsonThread = nullptr;
+    m_jsonWriter = nullptr;
+}
+
+void FileLogger::addLogMessages(const QVector<Log::Msg> &messages)
 {
     if (!m_logFile.isOpen()) return;
 
     QTextStream str(&m_logFile);
 
-    switch (msg.type) {
-    case Log::INFO:
-        str << "(I) ";
-        break;
-    case Log::WARNING:
-        str << "(W) ";
-        break;
-    case Log::CRITICAL:
-        str << "(C) ";
-        break;
-    default:
-        str << "(N) ";
-    }
+    for (const Log::Msg &msg : messages) {
+        switch (msg.type) {
+        case Log::INFO:
+            str << "(I) ";
+            break;
+        case Log::WARNING:
+            str << "(W) ";
+            break;
+        case Log::CRITICAL:
+            str << "(C) ";
+            break;
+        default:
+            str << "(N) ";
+        }
 
-    str << QDateTime::fromMSecsSinceEpoch(msg.timestamp).toString(Qt::ISODate) << " - " << msg.message << endl;
+        str << QDateTime::fromMSecsSinceEpoch(msg.timestamp).toString(Qt::ISODate) << " - " << msg.message << '\n';
+    }
+    str.flush();
 
     if (m_backup && (m_logFile.size() >= m_maxSize)) {
         closeLogFile();
@@ -32,6 +32,10 @@
 #include <QFile>
 #include <QObject>
 #include <QTimer>
+#include <QVector>
+
+class QThread;
+class JsonLogWriter;
 
 namespace Log
 {
@@ -58,20 +62,24 @@ public:
     void deleteOld(int age, FileLogAgeType ageType);
     void setBackup(bool value);
     void setMaxSize(int value);
+    void setJsonEnabled(bool value);
 
 private slots:
-    void addLogMessage(const Log::Msg &msg);
+    void addLogMessages(const QVector<Log::Msg> &messages);
     void flushLog();
 
 private:
     void openLogFile();
     void closeLogFile();
+    void stopJsonWriter();
 
     QString m_path;
     bool m_backup;
     int m_maxSize;
     QFile m_logFile;
     QTimer m_flusher;
+    QThread *m_jsonThread = nullptr;
+    JsonLogWriter *m_jsonWriter = nullptr;
 };
 
 #endif // FILELOGGER_H
@@ -0,0 +1,136 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2019  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#include "jsonlogwriter.h"
+
+#include <QJsonDocument>
+#include <QJsonObject>
+
+#include "base/logger.h"
+
+namespace
+{
+    const char KEY_ID[] = "id";
+    const char KEY_TIMESTAMP[] = "timestamp";
+    const char KEY_TYPE[] = "type";
+    const char KEY_MESSAGE[] = "message";
+
+    QString msgTypeName(const Log::MsgType type)
+    {
+        switch (type) {
+        case Log::INFO:
+            return QLatin1String("info");
+        case Log::WARNING:
+            return QLatin1String("warning");
+        case Log::CRITICAL:
+            return QLatin1String("critical");
+        default:
+            return QLatin1String("normal");
+        }
+    }
+}
+
+JsonLogWriter::JsonLogWriter(const bool backup, const int maxSize)
+    : m_backup(backup)
+    , m_maxSize(maxSize)
+{
+}
+
+JsonLogWriter::~JsonLogWriter()
+{
+    closeLogFile();
+}
+
+void JsonLogWriter::changePath(const QString &newPath)
+{
+    if (newPath == m_path) return;
+
+    m_path = newPath;
+
+    closeLogFile();
+    m_logFile.setFileName(m_path);
+    openLogFile();
+}
+
+void JsonLogWriter::setBackup(const bool value)
+{
+    m_backup = value;
+}
+
+void JsonLogWriter::setMaxSize(const int value)
+{
+    m_maxSize = value;
+}
+
+void JsonLogWriter::addLogMessages(const QVector<Log::Msg> &messages)
+{
+    if (!m_logFile.isOpen()) return;
+
+    QByteArray data;
+    for (const Log::Msg &msg : messages) {
+        const QJsonObject record {
+            {KEY_ID, msg.id},
+            {KEY_TIMESTAMP, msg.timestamp},
+            {KEY_TYPE, msgTypeName(msg.type)},
+            {KEY_MESSAGE, msg.message}
+        };
+        data += QJsonDocument(record).toJson(QJsonDocument::Compact);
+        data += '\n';
+    }
+
+    m_logFile.write(data);
+    m_logFile.flush();
+
+    if (m_backup && (m_logFile.size() >= m_maxSize)) {
+        closeLogFile();
+        int counter = 0;
+        QString backupLogFilename = m_path + ".bak";
+
+        while (QFile::exists(backupLogFilename)) {
+            ++counter;
+            backupLogFilename = m_path + ".bak" + QString::number(counter);
+        }
+
+        QFile::rename(m_path, backupLogFilename);
+        openLogFile();
+    }
+}
+
+void JsonLogWriter::openLogFile()
+{
+    if (!m_logFile.open(QIODevice::WriteOnly | QIODevice::Append)
+        || !m_logFile.setPermissions(QFile::ReadOwner | QFile::WriteOwner)) {
+        m_logFile.close();
+        LogMsg(tr("An error occurred while trying to open the structured log file. Logging to it is disabled."), Log::CRITICAL);
+    }
+}
+
+void JsonLogWriter::closeLogFile()
+{
+    m_logFile.close();
+}
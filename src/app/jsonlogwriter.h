@@ -1,6 +1,6 @@
 /*
  * Bittorrent Client using Qt and libtorrent.
- * Copyright (C) 2006-2012  Christophe Dumez <chris@qbittorrent.org>
+ * Copyright (C) 2019  qBittorrent project
  *
  * This program is free software; you can redistribute it and/or
  * modify it under the terms of the GNU General Public License
@@ -26,45 +26,41 @@
  * exception statement from your version.
  */
 
-#ifndef TORRENTCONTENTMODELFOLDER_H
-#define TORRENTCONTENTMODELFOLDER_H
+#pragma once
 
-#include "torrentcontentmodelitem.h"
+#include <QFile>
+#include <QObject>
+#include <QVector>
 
-namespace BitTorrent
+namespace Log
 {
-    enum class DownloadPriority;
+    struct Msg;
 }
 
-class TorrentContentModelFolder : public TorrentContentModelItem
+// Writes log messages as JSON lines (one JSON object per message).
+// It is meant to live in its own thread so that writing never
+// blocks the thread producing the messages.
+class JsonLogWriter : public QObject
 {
-public:
-    // Folder constructor
-    TorrentContentModelFolder(const QString &name, TorrentContentModelFolder *parent);
-
-    // Invisible root item constructor
-    explicit TorrentContentModelFolder(const QVector<QVariant> &data);
-
-    ~TorrentContentModelFolder() override;
-
-    ItemType itemType() const override;
+    Q_OBJECT
+    Q_DISABLE_COPY(JsonLogWriter)
 
-    void increaseSize(qulonglong delta);
-    void recalculateProgress();
-    void recalculateAvailability();
-    void updatePriority();
-
-    void setPriority(BitTorrent::DownloadPriority newPriority, bool updateParent = true) override;
+public:
+    JsonLogWriter(bool backup, int maxSize);
+    ~JsonLogWriter() override;
 
-    void deleteAllChildren();
-    const QVector<TorrentContentModelItem*> &children() const;
-    void appendChild(TorrentContentModelItem *item);
-    TorrentContentModelItem *child(int row) const;
-    TorrentContentModelFolder *childFolderWithName(const QString &name) const;
-    int childCount() const;
+public slots:
+    void changePath(const QString &newPath);
+    void setBackup(bool value);
+    void setMaxSize(int value);
+    void addLogMessages(const QVector<Log::Msg> &messages);
+    void closeLogFile();
 
 private:
-    QVector<TorrentContentModelItem*> m_childItems;
-};
+    void openLogFile();
 
-#endif // TORRENTCONTENTMODELFOLDER_H
+    QString m_path;
+    bool m_backup;
+    int m_maxSize;
+    QFile m_logFile;
+};
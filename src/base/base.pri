@@ -2,12 +2,14 @@ HEADERS += \
     $$PWD/algorithm.h \
     $$PWD/asyncfilestorage.h \
     $$PWD/bittorrent/addtorrentparams.h  \
+    $$PWD/bittorrent/bandwidthclass.h \
     $$PWD/bittorrent/cachestatus.h \
     $$PWD/bittorrent/downloadpriority.h \
     $$PWD/bittorrent/infohash.h \
     $$PWD/bittorrent/magneturi.h \
     $$PWD/bittorrent/peeraddress.h \
     $$PWD/bittorrent/peerinfo.h \
+    $$PWD/bittorrent/private/alertreader.h \
     $$PWD/bittorrent/private/bandwidthscheduler.h \
     $$PWD/bittorrent/private/filterparserthread.h \
     $$PWD/bittorrent/private/ltunderlyingtype.h \
@@ -15,13 +17,16 @@ HEADERS += \
     $$PWD/bittorrent/private/resumedatasavingmanager.h \
     $$PWD/bittorrent/private/speedmonitor.h \
     $$PWD/bittorrent/private/statistics.h \
+    $$PWD/bittorrent/private/torrentdatafetcher.h \
     $$PWD/bittorrent/session.h \
+    $$PWD/bittorrent/sessionmetric.h \
     $$PWD/bittorrent/sessionstatus.h \
     $$PWD/bittorrent/torrentcreatorthread.h \
     $$PWD/bittorrent/torrenthandle.h \
     $$PWD/bittorrent/torrentinfo.h \
     $$PWD/bittorrent/tracker.h \
     $$PWD/bittorrent/trackerentry.h \
+    $$PWD/bittorrent/trackerhostindex.h \
     $$PWD/exceptions.h \
     $$PWD/filesystemwatcher.h \
     $$PWD/global.h \
@@ -59,6 +64,7 @@ HEADERS += \
     $$PWD/search/searchhandler.h \
     $$PWD/search/searchdownloadhandler.h \
     $$PWD/search/searchpluginmanager.h \
+    $$PWD/search/searchresultstore.h \
     $$PWD/settingsstorage.h \
     $$PWD/settingvalue.h \
     $$PWD/torrentfileguard.h \
@@ -66,6 +72,7 @@ HEADERS += \
     $$PWD/tristatebool.h \
     $$PWD/types.h \
     $$PWD/unicodestrings.h \
+    $$PWD/utils/bitarray.h \
     $$PWD/utils/bytearray.h \
     $$PWD/utils/foreignapps.h \
     $$PWD/utils/fs.h \
@@ -84,18 +91,21 @@ SOURCES += \
     $$PWD/bittorrent/magneturi.cpp \
     $$PWD/bittorrent/peeraddress.cpp \
     $$PWD/bittorrent/peerinfo.cpp \
+    $$PWD/bittorrent/private/alertreader.cpp \
     $$PWD/bittorrent/private/bandwidthscheduler.cpp \
     $$PWD/bittorrent/private/filterparserthread.cpp \
     $$PWD/bittorrent/private/portforwarderimpl.cpp \
     $$PWD/bittorrent/private/resumedatasavingmanager.cpp \
     $$PWD/bittorrent/private/speedmonitor.cpp \
     $$PWD/bittorrent/private/statistics.cpp \
+    $$PWD/bittorrent/private/torrentdatafetcher.cpp \
     $$PWD/bittorrent/session.cpp \
     $$PWD/bittorrent/torrentcreatorthread.cpp \
     $$PWD/bittorrent/torrenthandle.cpp \
     $$PWD/bittorrent/torrentinfo.cpp \
     $$PWD/bittorrent/tracker.cpp \
     $$PWD/bittorrent/trackerentry.cpp \
+    $$PWD/bittorrent/trackerhostindex.cpp \
     $$PWD/exceptions.cpp \
     $$PWD/filesystemwatcher.cpp \
     $$PWD/http/connection.cpp \
@@ -129,10 +139,12 @@ SOURCES += \
     $$PWD/search/searchdownloadhandler.cpp \
     $$PWD/search/searchhandler.cpp \
     $$PWD/search/searchpluginmanager.cpp \
+    $$PWD/search/searchresultstore.cpp \
     $$PWD/settingsstorage.cpp \
     $$PWD/torrentfileguard.cpp \
     $$PWD/torrentfilter.cpp \
     $$PWD/tristatebool.cpp \
+    $$PWD/utils/bitarray.cpp \
     $$PWD/utils/bytearray.cpp \
     $$PWD/utils/foreignapps.cpp \
     $$PWD/utils/fs.cpp \
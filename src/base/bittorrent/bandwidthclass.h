@@ -1,6 +1,6 @@
 /*
  * Bittorrent Client using Qt and libtorrent.
- * Copyright (C) 2006-2012  Christophe Dumez <chris@qbittorrent.org>
+ * Copyright (C) 2019  qBittorrent project
  *
  * This program is free software; you can redistribute it and/or
  * modify it under the terms of the GNU General Public License
@@ -26,30 +26,25 @@
  * exception statement from your version.
  */
 
-#ifndef TORRENTCONTENTMODELFILE_H
-#define TORRENTCONTENTMODELFILE_H
-
-#include "torrentcontentmodelitem.h"
+#ifndef BITTORRENT_BANDWIDTHCLASS_H
+#define BITTORRENT_BANDWIDTHCLASS_H
 
 namespace BitTorrent
 {
-    enum class DownloadPriority;
-}
-
-class TorrentContentModelFile : public TorrentContentModelItem
-{
-public:
-    TorrentContentModelFile(const QString &fileName, qulonglong fileSize,
-                            TorrentContentModelFolder *parent, int fileIndex);
-
-    int fileIndex() const;
-    void setPriority(BitTorrent::DownloadPriority newPriority, bool updateParent = true) override;
-    void setProgress(qreal progress);
-    void setAvailability(qreal availability);
-    ItemType itemType() const override;
+    // Bandwidth settings shared by the torrents of a category or a tag
+    struct BandwidthClass
+    {
+        // Rate limits for the whole class in bytes per second, 0 means unlimited
+        int uploadLimit = 0;
+        int downloadLimit = 0;
+        // Relative share of the global rate limits, 1..255
+        int priority = 1;
 
-private:
-    int m_fileIndex;
-};
+        bool isDefault() const
+        {
+            return (uploadLimit == 0) && (downloadLimit == 0) && (priority == 1);
+        }
+    };
+}
 
-#endif // TORRENTCONTENTMODELFILE_H
+#endif // BITTORRENT_BANDWIDTHCLASS_H
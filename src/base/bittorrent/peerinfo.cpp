@@ -33,6 +33,7 @@
 #include "base/bittorrent/torrenthandle.h"
 #include "base/net/geoipmanager.h"
 #include "base/unicodestrings.h"
+#include "base/utils/bitarray.h"
 #include "peeraddress.h"
 
 using namespace BitTorrent;
@@ -204,13 +205,7 @@ qlonglong PeerInfo::totalDownload() const
 
 QBitArray PeerInfo::pieces() const
 {
-    QBitArray result(m_nativeInfo.pieces.size());
-
-    int i = 0;
-    for (const bool bit : m_nativeInfo.pieces)
-        result.setBit(i++, bit);
-
-    return result;
+    return Utils::BitArray::fromMsbFirst(m_nativeInfo.pieces.data(), m_nativeInfo.pieces.size());
 }
 
 QString PeerInfo::connectionType() const
@@ -233,19 +228,10 @@ QString PeerInfo::connectionType() const
 
 void PeerInfo::calcRelevance(const TorrentHandle *torrent)
 {
-    const QBitArray allPieces = torrent->pieces();
-    const QBitArray peerPieces = pieces();
-
-    int localMissing = 0;
-    int remoteHaves = 0;
+    const QBitArray missingPieces = ~torrent->pieces();
 
-    for (int i = 0; i < allPieces.size(); ++i) {
-        if (!allPieces[i]) {
-            ++localMissing;
-            if (peerPieces[i])
-                ++remoteHaves;
-        }
-    }
+    const int localMissing = missingPieces.count(true);
+    const int remoteHaves = (localMissing > 0) ? (missingPieces & pieces()).count(true) : 0;
 
     if (localMissing == 0)
         m_relevance = 0.0;
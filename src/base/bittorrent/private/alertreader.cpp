@@ -0,0 +1,405 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2019  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+
+#include "alertreader.h"
+
+#include <algorithm>
+#include <iterator>
+#include <map>
+#include <set>
+#include <utility>
+
+#include <libtorrent/alert_types.hpp>
+#include <libtorrent/session.hpp>
+#include <libtorrent/version.hpp>
+
+#if (LIBTORRENT_VERSION_NUM >= 10200)
+#include <libtorrent/write_resume_data.hpp>
+#endif
+
+#include <QMutexLocker>
+
+namespace
+{
+    AlertData torrentAlertData(const lt::torrent_alert *p)
+    {
+        AlertData data;
+        data.handle = p->handle;
+        data.infoHash = p->handle.info_hash();
+        return data;
+    }
+
+    // Copies the data of the alerts that are handled by Session and TorrentHandle,
+    // the string members of lt::alert point to the alert storage so they are copied too
+    bool copyAlert(lt::alert *a, AlertData &data)
+    {
+        switch (a->type()) {
+        case lt::add_torrent_alert::alert_type: {
+                const auto *p = static_cast<const lt::add_torrent_alert *>(a);
+                data = torrentAlertData(p);
+                data.error = p->error;
+                if (p->error)
+                    data.message = p->message();
+            }
+            break;
+        case lt::torrent_removed_alert::alert_type:
+            data.infoHash = static_cast<const lt::torrent_removed_alert *>(a)->info_hash;
+            break;
+        case lt::torrent_deleted_alert::alert_type:
+            data.infoHash = static_cast<const lt::torrent_deleted_alert *>(a)->info_hash;
+            break;
+        case lt::torrent_delete_failed_alert::alert_type: {
+                const auto *p = static_cast<const lt::torrent_delete_failed_alert *>(a);
+                data.infoHash = p->info_hash;
+                data.error = p->error;
+            }
+            break;
+        case lt::torrent_checked_alert::alert_type:
+        case lt::torrent_finished_alert::alert_type:
+        case lt::torrent_paused_alert::alert_type:
+        case lt::torrent_resumed_alert::alert_type:
+        case lt::metadata_received_alert::alert_type:
+            data = torrentAlertData(static_cast<const lt::torrent_alert *>(a));
+            break;
+        case lt::file_renamed_alert::alert_type: {
+                const auto *p = static_cast<const lt::file_renamed_alert *>(a);
+                data = torrentAlertData(p);
+                data.fileIndex = static_cast<int>(p->index);
+                data.path = p->new_name();
+            }
+            break;
+        case lt::file_rename_failed_alert::alert_type: {
+                const auto *p = static_cast<const lt::file_rename_failed_alert *>(a);
+                data = torrentAlertData(p);
+                data.fileIndex = static_cast<int>(p->index);
+                data.error = p->error;
+            }
+            break;
+        case lt::file_completed_alert::alert_type: {
+                const auto *p = static_cast<const lt::file_completed_alert *>(a);
+                data = torrentAlertData(p);
+                data.fileIndex = static_cast<int>(p->index);
+            }
+            break;
+        case lt::file_error_alert::alert_type: {
+                const auto *p = static_cast<const lt::file_error_alert *>(a);
+                data = torrentAlertData(p);
+                data.path = p->filename();
+                data.message = p->message();
+            }
+            break;
+        case lt::save_resume_data_alert::alert_type: {
+                auto *p = static_cast<lt::save_resume_data_alert *>(a);
+                data = torrentAlertData(p);
+#if (LIBTORRENT_VERSION_NUM < 10200)
+                if (p->resume_data)
+                    data.resumeData = std::make_shared<lt::entry>(std::move(*p->resume_data));
+#else
+                data.resumeData = std::make_shared<lt::entry>(lt::write_resume_data(p->params));
+#endif
+            }
+            break;
+        case lt::save_resume_data_failed_alert::alert_type: {
+                const auto *p = static_cast<const lt::save_resume_data_failed_alert *>(a);
+                data = torrentAlertData(p);
+                data.error = p->error;
+            }
+            break;
+        case lt::fastresume_rejected_alert::alert_type: {
+                const auto *p = static_cast<const lt::fastresume_rejected_alert *>(a);
+                data = torrentAlertData(p);
+                data.error = p->error;
+                data.message = p->message();
+            }
+            break;
+        case lt::storage_moved_alert::alert_type: {
+                const auto *p = static_cast<const lt::storage_moved_alert *>(a);
+                data = torrentAlertData(p);
+                data.path = p->storage_path();
+            }
+            break;
+        case lt::storage_moved_failed_alert::alert_type: {
+                const auto *p = static_cast<const lt::storage_moved_failed_alert *>(a);
+                data = torrentAlertData(p);
+                data.message = p->message();
+            }
+            break;
+        case lt::tracker_reply_alert::alert_type: {
+                const auto *p = static_cast<const lt::tracker_reply_alert *>(a);
+                data = torrentAlertData(p);
+                data.url = p->tracker_url();
+                data.numPeers = p->num_peers;
+            }
+            break;
+        case lt::tracker_warning_alert::alert_type: {
+                const auto *p = static_cast<const lt::tracker_warning_alert *>(a);
+                data = torrentAlertData(p);
+                data.url = p->tracker_url();
+                data.trackerMessage = p->warning_message();
+            }
+            break;
+        case lt::tracker_error_alert::alert_type: {
+                const auto *p = static_cast<const lt::tracker_error_alert *>(a);
+                data = torrentAlertData(p);
+                data.url = p->tracker_url();
+                data.trackerMessage = p->error_message();
+            }
+            break;
+        case lt::url_seed_alert::alert_type: {
+                const auto *p = static_cast<const lt::url_seed_alert *>(a);
+                data.url = p->server_url();
+                data.message = p->message();
+            }
+            break;
+        case lt::portmap_alert::alert_type:
+        case lt::portmap_error_alert::alert_type:
+            data.message = a->message();
+            break;
+        case lt::peer_blocked_alert::alert_type: {
+                const auto *p = static_cast<const lt::peer_blocked_alert *>(a);
+#if (LIBTORRENT_VERSION_NUM < 10200)
+                data.address = p->ip;
+#else
+                data.address = p->endpoint.address();
+#endif
+                data.reason = p->reason;
+            }
+            break;
+        case lt::peer_ban_alert::alert_type: {
+                const auto *p = static_cast<const lt::peer_ban_alert *>(a);
+#if (LIBTORRENT_VERSION_NUM < 10200)
+                data.address = p->ip.address();
+#else
+                data.address = p->endpoint.address();
+#endif
+            }
+            break;
+        case lt::listen_succeeded_alert::alert_type: {
+                const auto *p = static_cast<const lt::listen_succeeded_alert *>(a);
+#if (LIBTORRENT_VERSION_NUM < 10200)
+                data.address = p->endpoint.address();
+                data.port = p->endpoint.port();
+                data.socketType = p->sock_type;
+#else
+                data.address = p->address;
+                data.port = p->port;
+                data.socketType = static_cast<int>(p->socket_type);
+#endif
+            }
+            break;
+        case lt::listen_failed_alert::alert_type: {
+                const auto *p = static_cast<const lt::listen_failed_alert *>(a);
+#if (LIBTORRENT_VERSION_NUM < 10200)
+                data.address = p->endpoint.address();
+                data.port = p->endpoint.port();
+                data.socketType = p->sock_type;
+#else
+                data.address = p->address;
+                data.port = p->port;
+                data.socketType = static_cast<int>(p->socket_type);
+#endif
+                data.error = p->error;
+            }
+            break;
+        case lt::external_ip_alert::alert_type:
+            data.address = static_cast<const lt::external_ip_alert *>(a)->external_address;
+            break;
+        case lt::session_stats_alert::alert_type: {
+                const auto *p = static_cast<const lt::session_stats_alert *>(a);
+#if (LIBTORRENT_VERSION_NUM < 10200)
+                data.counters.assign(std::begin(p->values), std::end(p->values));
+#else
+                const auto counters = p->counters();
+                data.counters.assign(counters.begin(), counters.end());
+#endif
+            }
+            break;
+#if (LIBTORRENT_VERSION_NUM >= 10200)
+        case lt::alerts_dropped_alert::alert_type:
+            break;
+#endif
+        default:
+            return false;
+        }
+
+        data.type = a->type();
+        data.timestamp = a->timestamp();
+        return true;
+    }
+}
+
+AlertReader::AlertReader(lt::session *session, QObject *parent)
+    : QThread(parent)
+    , m_session(session)
+{
+}
+
+AlertReader::~AlertReader()
+{
+    stop();
+}
+
+void AlertReader::stop()
+{
+    requestInterruption();
+    wait();
+}
+
+bool AlertReader::takeBatch(AlertBatch &batch)
+{
+    QMutexLocker locker(&m_mutex);
+    if (m_batch.alerts.empty() && !m_batch.hasStateUpdate)
+        return false;
+
+    batch = std::move(m_batch);
+    m_batch = {};
+    return true;
+}
+
+BitTorrent::AlertStatistics AlertReader::statistics() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_statistics;
+}
+
+void AlertReader::run()
+{
+    while (!isInterruptionRequested()) {
+        // wake up from time to time to check whether we should stop
+        if (!m_session->wait_for_alert(lt::milliseconds(500)) || isInterruptionRequested())
+            continue;
+
+        std::vector<lt::alert *> alerts;
+        m_session->pop_alerts(&alerts);
+        if (alerts.empty())
+            continue;
+
+        AlertBatch batch = makeBatch(alerts);
+        if (!batch.alerts.empty() || batch.hasStateUpdate)
+            appendBatch(std::move(batch));
+    }
+}
+
+// Alerts are examined starting from the newest one so that only
+// the latest of the redundant alerts are kept
+AlertBatch AlertReader::makeBatch(std::vector<lt::alert *> &alerts)
+{
+    AlertBatch batch;
+    batch.alerts.reserve(alerts.size());
+
+    qint64 coalescedCount = 0;
+    qint64 droppedCount = 0;
+    bool hasSessionStats = false;
+    std::set<lt::sha1_hash> updatedTorrents;
+    std::set<std::pair<lt::sha1_hash, std::string>> repliedTrackers;
+
+    for (auto i = alerts.rbegin(); i != alerts.rend(); ++i) {
+        lt::alert *a = *i;
+        switch (a->type()) {
+        case lt::state_update_alert::alert_type:
+            if (batch.hasStateUpdate)
+                ++coalescedCount;
+            batch.hasStateUpdate = true;
+
+            for (lt::torrent_status &status : static_cast<lt::state_update_alert *>(a)->status) {
+                if (updatedTorrents.insert(status.info_hash).second)
+                    batch.torrentStatuses.push_back(std::move(status));
+            }
+            continue;
+        case lt::tracker_reply_alert::alert_type: {
+                const auto *p = static_cast<const lt::tracker_reply_alert *>(a);
+                if (!repliedTrackers.emplace(p->handle.info_hash(), p->tracker_url()).second) {
+                    ++coalescedCount;
+                    continue;
+                }
+            }
+            break;
+        case lt::session_stats_alert::alert_type:
+            if (hasSessionStats) {
+                ++coalescedCount;
+                continue;
+            }
+            hasSessionStats = true;
+            break;
+#if (LIBTORRENT_VERSION_NUM >= 10200)
+        case lt::alerts_dropped_alert::alert_type:
+            droppedCount += static_cast<const lt::alerts_dropped_alert *>(a)->dropped_alerts.count();
+            break;
+#endif
+        }
+
+        AlertData data;
+        if (copyAlert(a, data))
+            batch.alerts.push_back(std::move(data));
+    }
+
+    std::reverse(batch.alerts.begin(), batch.alerts.end());
+
+    QMutexLocker locker(&m_mutex);
+    ++m_statistics.batches;
+    m_statistics.receivedAlerts += static_cast<qint64>(alerts.size());
+    m_statistics.coalescedAlerts += coalescedCount;
+    if (droppedCount > 0) {
+        ++m_statistics.queueOverflows;
+        m_statistics.droppedAlertTypes += droppedCount;
+    }
+
+    return batch;
+}
+
+// Joins the batch with the one that isn't taken yet,
+// a torrent status replaces the older status of the same torrent
+void AlertReader::appendBatch(AlertBatch &&batch)
+{
+    QMutexLocker locker(&m_mutex);
+
+    const bool isPending = !m_batch.alerts.empty() || m_batch.hasStateUpdate;
+    if (!isPending) {
+        m_batch = std::move(batch);
+        emit batchReady();
+        return;
+    }
+
+    m_batch.alerts.insert(m_batch.alerts.end()
+        , std::make_move_iterator(batch.alerts.begin()), std::make_move_iterator(batch.alerts.end()));
+    m_batch.hasStateUpdate = m_batch.hasStateUpdate || batch.hasStateUpdate;
+
+    std::map<lt::sha1_hash, std::size_t> statusIndices;
+    for (std::size_t i = 0; i < m_batch.torrentStatuses.size(); ++i)
+        statusIndices.emplace(m_batch.torrentStatuses[i].info_hash, i);
+
+    for (lt::torrent_status &status : batch.torrentStatuses) {
+        const auto iter = statusIndices.find(status.info_hash);
+        if (iter != statusIndices.end())
+            m_batch.torrentStatuses[iter->second] = std::move(status);
+        else
+            m_batch.torrentStatuses.push_back(std::move(status));
+    }
+    // batchReady is already emitted for the pending batch
+}
@@ -0,0 +1,123 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2019  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <libtorrent/address.hpp>
+#include <libtorrent/entry.hpp>
+#include <libtorrent/error_code.hpp>
+#include <libtorrent/fwd.hpp>
+#include <libtorrent/sha1_hash.hpp>
+#include <libtorrent/time.hpp>
+#include <libtorrent/torrent_handle.hpp>
+#include <libtorrent/torrent_status.hpp>
+
+#include <QMutex>
+#include <QThread>
+
+#include "base/bittorrent/sessionmetric.h"
+
+// Copy of the alert data used by Session and TorrentHandle.
+// Unlike lt::alert it stays valid after libtorrent reuses its alert storage.
+struct AlertData
+{
+    int type = 0;
+    lt::time_point timestamp;
+    std::string message;
+    lt::error_code error;
+    // torrent alerts only
+    lt::torrent_handle handle;
+    lt::sha1_hash infoHash;
+    // tracker or URL seed URL
+    std::string url;
+    // tracker warning or error message
+    std::string trackerMessage;
+    // new storage path, new file name or the name of the file that failed
+    std::string path;
+    int fileIndex = -1;
+    int numPeers = 0;
+    // peer_blocked_alert reason
+    int reason = 0;
+    // peer, listen or external address
+    lt::address address;
+    int port = 0;
+    int socketType = 0;
+    std::shared_ptr<lt::entry> resumeData;
+    std::vector<std::int64_t> counters;
+};
+
+// Alerts read from libtorrent with the redundant ones left out
+struct AlertBatch
+{
+    // in the order they were posted
+    std::vector<AlertData> alerts;
+    // the latest status of each torrent from all state updates
+    std::vector<lt::torrent_status> torrentStatuses;
+    // set even if no torrent status has changed
+    bool hasStateUpdate = false;
+};
+
+// Drains the libtorrent alert queue in its own thread, so that it doesn't wait
+// for the main thread to become idle. Alerts are copied as soon as they are read,
+// the ones the main thread hasn't taken yet are accumulated in a single batch.
+class AlertReader : public QThread
+{
+    Q_OBJECT
+    Q_DISABLE_COPY(AlertReader)
+
+public:
+    explicit AlertReader(lt::session *session, QObject *parent = nullptr);
+    ~AlertReader() override;
+
+    // Stops reading, the alerts that are already read can still be taken
+    void stop();
+    bool takeBatch(AlertBatch &batch);
+    // Used to read alerts directly once the reader is stopped
+    AlertBatch makeBatch(std::vector<lt::alert *> &alerts);
+    BitTorrent::AlertStatistics statistics() const;
+
+signals:
+    void batchReady();
+
+protected:
+    void run() override;
+
+private:
+    void appendBatch(AlertBatch &&batch);
+
+    lt::session *const m_session;
+    mutable QMutex m_mutex;
+    AlertBatch m_batch;
+    BitTorrent::AlertStatistics m_statistics;
+};
@@ -29,6 +29,7 @@
 #include "resumedatasavingmanager.h"
 
 #include <QByteArray>
+#include <QFile>
 #include <QSaveFile>
 
 #include "base/logger.h"
@@ -59,3 +60,21 @@ void ResumeDataSavingManager::remove(const QString &filename) const
 
     Utils::Fs::forceRemove(filepath);
 }
+
+void ResumeDataSavingManager::exportTorrent(const QString &filename, const QString &exportFolderPath, const QString &exportName) const
+{
+    const QString torrentPath = m_resumeDataDir.absoluteFilePath(filename);
+    const QDir exportDir {exportFolderPath};
+    if (!exportDir.exists() && !exportDir.mkpath(exportDir.absolutePath()))
+        return;
+
+    QString newTorrentPath = exportDir.absoluteFilePath(QString("%1.torrent").arg(exportName));
+    int counter = 0;
+    while (QFile::exists(newTorrentPath) && !Utils::Fs::sameFiles(torrentPath, newTorrentPath)) {
+        // Append number to torrent name to make it unique
+        newTorrentPath = exportDir.absoluteFilePath(QString("%1 %2.torrent").arg(exportName).arg(++counter));
+    }
+
+    if (!QFile::exists(newTorrentPath))
+        QFile::copy(torrentPath, newTorrentPath);
+}
@@ -44,6 +44,8 @@ public:
 public slots:
     void save(const QString &filename, const QByteArray &data) const;
     void remove(const QString &filename) const;
+    // Copies the stored .torrent file to the export folder under a name not taken by another torrent
+    void exportTorrent(const QString &filename, const QString &exportFolderPath, const QString &exportName) const;
 
 private:
     QDir m_resumeDataDir;
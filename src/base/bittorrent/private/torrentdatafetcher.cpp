@@ -0,0 +1,143 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2019  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#include "torrentdatafetcher.h"
+
+#include <vector>
+
+#include <libtorrent/version.hpp>
+
+#include <QFileInfo>
+
+#include "base/bittorrent/torrentinfo.h"
+#include "base/logger.h"
+#include "base/utils/fs.h"
+#include "ltunderlyingtype.h"
+
+namespace
+{
+#if (LIBTORRENT_VERSION_NUM < 10200)
+    using LTPieceIndex = int;
+#else
+    using LTPieceIndex = lt::piece_index_t;
+#endif
+
+    const int MAX_EXAMINED_TORRENT_FILES = 100;
+    const qint64 MAX_EXAMINED_TORRENT_BYTES = 64 * 1024 * 1024;
+
+    const int TorrentHandleTypeId = qRegisterMetaType<lt::torrent_handle>();
+}
+
+void TorrentDataFetcher::fetchFilesProgress(const QString &hash, const lt::torrent_handle &nativeHandle)
+{
+    QVector<qreal> result;
+
+    try {
+        const BitTorrent::TorrentInfo info {nativeHandle.torrent_file()};
+        if (info.isValid()) {
+            std::vector<boost::int64_t> fp;
+            nativeHandle.file_progress(fp, lt::torrent_handle::piece_granularity);
+
+            const int count = qMin(static_cast<int>(fp.size()), info.filesCount());
+            result.reserve(count);
+            for (int i = 0; i < count; ++i) {
+                const qlonglong size = info.fileSize(i);
+                if ((size <= 0) || (fp[i] == size))
+                    result << 1;
+                else
+                    result << (fp[i] / static_cast<qreal>(size));
+            }
+        }
+    }
+    catch (const std::exception &exc) {
+        qDebug("Couldn't fetch files progress of torrent %s: %s", qUtf8Printable(hash), exc.what());
+    }
+
+    emit filesProgressFetched(hash, result);
+}
+
+void TorrentDataFetcher::fetchPieceAvailability(const QString &hash, const lt::torrent_handle &nativeHandle)
+{
+    std::vector<int> avail;
+
+    try {
+        nativeHandle.piece_availability(avail);
+    }
+    catch (const std::exception &exc) {
+        qDebug("Couldn't fetch piece availability of torrent %s: %s", qUtf8Printable(hash), exc.what());
+    }
+
+    emit pieceAvailabilityFetched(hash, QVector<int>::fromStdVector(avail));
+}
+
+void TorrentDataFetcher::fetchDownloadingPieces(const QString &hash, const lt::torrent_handle &nativeHandle)
+{
+    QBitArray result;
+
+    try {
+        const BitTorrent::TorrentInfo info {nativeHandle.torrent_file()};
+        result.resize(info.isValid() ? info.piecesCount() : 0);
+
+        std::vector<lt::partial_piece_info> queue;
+        nativeHandle.get_download_queue(queue);
+
+        for (const lt::partial_piece_info &pieceInfo : queue) {
+#if (LIBTORRENT_VERSION_NUM < 10200)
+            const int pieceIndex = pieceInfo.piece_index;
+#else
+            const int pieceIndex = LTUnderlyingType<LTPieceIndex> {pieceInfo.piece_index};
+#endif
+            if (pieceIndex < result.size())
+                result.setBit(pieceIndex);
+        }
+    }
+    catch (const std::exception &exc) {
+        qDebug("Couldn't fetch downloading pieces of torrent %s: %s", qUtf8Printable(hash), exc.what());
+    }
+
+    emit downloadingPiecesFetched(hash, result);
+}
+
+void TorrentDataFetcher::findEmbeddedTorrent(const QString &hash, const QStringList &filePaths)
+{
+    qint64 examinedBytes = 0;
+    const int filesCount = qMin(filePaths.size(), MAX_EXAMINED_TORRENT_FILES);
+    for (int i = 0; i < filesCount; ++i) {
+        const QString &filePath = filePaths[i];
+        examinedBytes += QFileInfo(filePath).size();
+        if (examinedBytes > MAX_EXAMINED_TORRENT_BYTES)
+            break;
+
+        if (BitTorrent::TorrentInfo::loadFromFile(filePath).isValid()) {
+            emit embeddedTorrentFound(hash);
+            return;
+        }
+
+        LogMsg(tr("Unable to decode '%1' torrent file.").arg(Utils::Fs::toNativePath(filePath)), Log::CRITICAL);
+    }
+}
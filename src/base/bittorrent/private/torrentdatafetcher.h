@@ -0,0 +1,64 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2019  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#pragma once
+
+#include <libtorrent/torrent_handle.hpp>
+
+#include <QBitArray>
+#include <QMetaType>
+#include <QObject>
+#include <QStringList>
+#include <QVector>
+
+// Runs the libtorrent queries that block until the network thread answers,
+// so they don't stall the thread that requested them
+class TorrentDataFetcher : public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY(TorrentDataFetcher)
+
+public:
+    TorrentDataFetcher() = default;
+
+public slots:
+    void fetchFilesProgress(const QString &hash, const lt::torrent_handle &nativeHandle);
+    void fetchPieceAvailability(const QString &hash, const lt::torrent_handle &nativeHandle);
+    void fetchDownloadingPieces(const QString &hash, const lt::torrent_handle &nativeHandle);
+    // Looks for a valid torrent among the given files, gives up
+    // after examining too many of them to keep the thread responsive
+    void findEmbeddedTorrent(const QString &hash, const QStringList &filePaths);
+
+signals:
+    void filesProgressFetched(const QString &hash, const QVector<qreal> &filesProgress);
+    void pieceAvailabilityFetched(const QString &hash, const QVector<int> &pieceAvailability);
+    void downloadingPiecesFetched(const QString &hash, const QBitArray &downloadingPieces);
+    void embeddedTorrentFound(const QString &hash);
+};
+
+Q_DECLARE_METATYPE(lt::torrent_handle)
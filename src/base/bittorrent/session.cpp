@@ -31,6 +31,9 @@
 
 #include <algorithm>
 #include <cstdlib>
+#include <iterator>
+#include <limits>
+#include <numeric>
 #include <queue>
 #include <string>
 
@@ -39,6 +42,7 @@
 #include <iphlpapi.h>
 #endif
 
+#include <QDateTime>
 #include <QDebug>
 #include <QDir>
 #include <QHostAddress>
@@ -84,15 +88,18 @@
 #include "base/utils/net.h"
 #include "base/utils/random.h"
 #include "magneturi.h"
+#include "private/alertreader.h"
 #include "private/bandwidthscheduler.h"
 #include "private/filterparserthread.h"
 #include "private/ltunderlyingtype.h"
 #include "private/portforwarderimpl.h"
 #include "private/resumedatasavingmanager.h"
 #include "private/statistics.h"
+#include "private/torrentdatafetcher.h"
 #include "torrenthandle.h"
 #include "tracker.h"
 #include "trackerentry.h"
+#include "trackerhostindex.h"
 
 #if defined(Q_OS_WIN) && (_WIN32_WINNT < 0x0600)
 using NETIO_STATUS = LONG;
@@ -101,6 +108,9 @@ using NETIO_STATUS = LONG;
 static const char PEER_ID[] = "qB";
 static const char RESUME_FOLDER[] = "BT_backup";
 static const char USER_AGENT[] = "qBittorrent/" QBT_VERSION_2;
+// Peers that haven't been banned by libtorrent for this long have their ban count reset
+static const qint64 PEER_BAN_COUNT_LIFETIME = 24 * 3600 * 1000;
+static const int MAX_PEER_BAN_COUNTS = 4096;
 
 using namespace BitTorrent;
 
@@ -150,6 +160,156 @@ namespace
         return result;
     }
 
+    QHash<QString, BandwidthClass> toBandwidthClasses(const QVariantMap &map)
+    {
+        QHash<QString, BandwidthClass> result;
+        for (auto i = map.cbegin(); i != map.cend(); ++i) {
+            const QVariantMap data = i.value().toMap();
+            BandwidthClass bandwidthClass;
+            bandwidthClass.uploadLimit = std::max(0, data.value("UploadLimit").toInt());
+            bandwidthClass.downloadLimit = std::max(0, data.value("DownloadLimit").toInt());
+            bandwidthClass.priority = qBound(1, data.value("Priority", 1).toInt(), 255);
+            if (!bandwidthClass.isDefault())
+                result[i.key()] = bandwidthClass;
+        }
+        return result;
+    }
+
+    QVariantMap fromBandwidthClasses(const QHash<QString, BandwidthClass> &classes)
+    {
+        QVariantMap result;
+        for (auto i = classes.cbegin(); i != classes.cend(); ++i) {
+            result[i.key()] = QVariantMap {
+                {"UploadLimit", i.value().uploadLimit},
+                {"DownloadLimit", i.value().downloadLimit},
+                {"Priority", i.value().priority}
+            };
+        }
+        return result;
+    }
+
+    // Smallest rate limit assigned by bandwidth classes. libtorrent treats 0 as unlimited
+    // so a torrent must never get it, and it shouldn't be starved either.
+    const qint64 MIN_CLASS_RATE_LIMIT = 1024;
+    // Transferring torrents are allowed to grow by this much (or by a quarter of
+    // their current rate if it is more) on each update
+    const qint64 CLASS_RATE_HEADROOM = 16 * 1024;
+
+    // Weighted max-min fair split of `capacity` between consumers.
+    // Consumers demanding less than their fair share get what they demand
+    // and the rest is split again between the others. If the capacity
+    // exceeds the total demand the remainder is split by weight as well,
+    // so the consumers can grow.
+    QVector<qint64> splitBandwidth(const qint64 capacity, const QVector<qint64> &demands, const QVector<int> &weights)
+    {
+        const int count = demands.size();
+        QVector<qint64> shares(count, 0);
+        if (count == 0)
+            return shares;
+
+        QVector<int> order(count);
+        std::iota(order.begin(), order.end(), 0);
+        std::sort(order.begin(), order.end(), [&demands, &weights](const int left, const int right)
+        {
+            return ((demands[left] * weights[right]) < (demands[right] * weights[left]));
+        });
+
+        const qint64 totalWeight = std::accumulate(weights.cbegin(), weights.cend(), qint64 {0});
+        qint64 remaining = capacity;
+        qint64 remainingWeight = totalWeight;
+        int satisfied = 0;
+        for (; satisfied < count; ++satisfied) {
+            const int i = order[satisfied];
+            if ((demands[i] * remainingWeight) > (remaining * weights[i]))
+                break;
+
+            shares[i] = demands[i];
+            remaining -= demands[i];
+            remainingWeight -= weights[i];
+        }
+
+        if (satisfied < count) {
+            for (int j = satisfied; j < count; ++j) {
+                const int i = order[j];
+                shares[i] = remaining * weights[i] / remainingWeight;
+            }
+        }
+        else if (remaining > 0) {
+            for (int i = 0; i < count; ++i)
+                shares[i] += remaining * weights[i] / totalWeight;
+        }
+
+        return shares;
+    }
+
+    // Keeps 4 significant bits so that small rate fluctuations
+    // don't result in passing new limits to libtorrent on each update
+    int roundClassRateLimit(const qint64 limit)
+    {
+        if (limit <= MIN_CLASS_RATE_LIMIT)
+            return MIN_CLASS_RATE_LIMIT;
+
+        int shift = 0;
+        for (qint64 value = limit; value >= 16; value >>= 1)
+            ++shift;
+        return static_cast<int>(std::min<qint64>((limit >> shift) << shift, std::numeric_limits<int>::max()));
+    }
+
+    enum TorrentStatusFlag : uint
+    {
+        StatusDownloading = 1 << 0,
+        StatusSeeding = 1 << 1,
+        StatusCompleted = 1 << 2,
+        StatusPaused = 1 << 3,
+        StatusResumed = 1 << 4,
+        StatusActive = 1 << 5,
+        StatusInactive = 1 << 6,
+        StatusErrored = 1 << 7
+    };
+
+    uint torrentStatusFlags(const TorrentHandle *torrent)
+    {
+        uint flags = 0;
+        if (torrent->isDownloading())
+            flags |= StatusDownloading;
+        if (torrent->isUploading())
+            flags |= StatusSeeding;
+        if (torrent->isCompleted())
+            flags |= StatusCompleted;
+        if (torrent->isPaused())
+            flags |= StatusPaused;
+        if (torrent->isResumed())
+            flags |= StatusResumed;
+        if (torrent->isActive())
+            flags |= StatusActive;
+        if (torrent->isInactive())
+            flags |= StatusInactive;
+        if (torrent->isErrored())
+            flags |= StatusErrored;
+        return flags;
+    }
+
+    // delta is +1 to count a torrent with the given flags and -1 to uncount it
+    void addToStatusReport(TorrentStatusReport &report, const uint flags, const int delta)
+    {
+        if (flags & StatusDownloading)
+            report.nbDownloading += delta;
+        if (flags & StatusSeeding)
+            report.nbSeeding += delta;
+        if (flags & StatusCompleted)
+            report.nbCompleted += delta;
+        if (flags & StatusPaused)
+            report.nbPaused += delta;
+        if (flags & StatusResumed)
+            report.nbResumed += delta;
+        if (flags & StatusActive)
+            report.nbActive += delta;
+        if (flags & StatusInactive)
+            report.nbInactive += delta;
+        if (flags & StatusErrored)
+            report.nbErrored += delta;
+    }
+
     template <typename LTStr>
     QString fromLTString(const LTStr &str)
     {
@@ -256,6 +416,19 @@ namespace
             return value;
         };
     }
+
+    lt::address toLTAddress(const QHostAddress &address)
+    {
+        bool isIPv4 = false;
+        const quint32 ipv4 = address.toIPv4Address(&isIPv4);
+        if (isIPv4)
+            return lt::address_v4(ipv4);
+
+        const Q_IPV6ADDR ipv6 = address.toIPv6Address();
+        lt::address_v6::bytes_type bytes;
+        std::copy(std::begin(ipv6.c), std::end(ipv6.c), bytes.begin());
+        return lt::address_v6(bytes);
+    }
 }
 
 // Session
@@ -270,6 +443,7 @@ Session::Session(QObject *parent)
     , m_deferredConfigureScheduled(false)
     , m_IPFilteringChanged(false)
     , m_listenInterfaceChanged(true)
+    , m_pendingBansScheduled(false)
     , m_isDHTEnabled(BITTORRENT_SESSION_KEY("DHTEnabled"), true)
     , m_isLSDEnabled(BITTORRENT_SESSION_KEY("LSDEnabled"), true)
     , m_isPeXEnabled(BITTORRENT_SESSION_KEY("PeXEnabled"), true)
@@ -351,6 +525,8 @@ Session::Session(QObject *parent)
         , clampValue(SeedChokingAlgorithm::RoundRobin, SeedChokingAlgorithm::AntiLeech))
     , m_storedCategories(BITTORRENT_SESSION_KEY("Categories"))
     , m_storedTags(BITTORRENT_SESSION_KEY("Tags"))
+    , m_storedCategoryBandwidthClasses(BITTORRENT_SESSION_KEY("CategoryBandwidthClasses"))
+    , m_storedTagBandwidthClasses(BITTORRENT_SESSION_KEY("TagBandwidthClasses"))
     , m_maxRatioAction(BITTORRENT_SESSION_KEY("MaxRatioAction"), Pause)
     , m_defaultSavePath(BITTORRENT_SESSION_KEY("DefaultSavePath"), specialFolderLocation(SpecialFolder::Downloads), normalizePath)
     , m_tempPath(BITTORRENT_SESSION_KEY("TempPath"), defaultSavePath() + "temp/", normalizePath)
@@ -370,6 +546,8 @@ Session::Session(QObject *parent)
                             return tmp;
                         }
                  )
+    , m_isPeerAutoBanEnabled(BITTORRENT_SESSION_KEY("PeerAutoBanEnabled"), false)
+    , m_peerAutoBanThreshold(BITTORRENT_SESSION_KEY("PeerAutoBanThreshold"), 2, lowerLimited(1))
     , m_wasPexEnabled(m_isPeXEnabled)
     , m_numResumeData(0)
     , m_extraLimit(0)
@@ -384,8 +562,9 @@ Session::Session(QObject *parent)
     m_recentErroredTorrentsTimer->setInterval(1000);
     connect(m_recentErroredTorrentsTimer, &QTimer::timeout, this, [this]() { m_recentErroredTorrents.clear(); });
 
+    m_shareLimitClock.start();
     m_seedingLimitTimer = new QTimer(this);
-    m_seedingLimitTimer->setInterval(10000);
+    m_seedingLimitTimer->setSingleShot(true);
     connect(m_seedingLimitTimer, &QTimer::timeout, this, &Session::processShareLimits);
 
     // Set severity level of libtorrent session
@@ -432,14 +611,9 @@ Session::Session(QObject *parent)
     configure(pack);
 
     m_nativeSession = new lt::session {pack, LTSessionFlags {0}};
-    m_nativeSession->set_alert_notify([this]()
-    {
-#if (QT_VERSION >= QT_VERSION_CHECK(5, 10, 0))
-        QMetaObject::invokeMethod(this, &Session::readAlerts, Qt::QueuedConnection);
-#else
-        QMetaObject::invokeMethod(this, "readAlerts", Qt::QueuedConnection);
-#endif
-    });
+    m_alertReader = new AlertReader(m_nativeSession, this);
+    connect(m_alertReader, &AlertReader::batchReady, this, &Session::readAlerts);
+    m_alertReader->start();
 
     configurePeerClasses();
 
@@ -462,6 +636,9 @@ Session::Session(QObject *parent)
     if (isBandwidthSchedulerEnabled())
         enableBandwidthScheduler();
 
+    for (const QString &ip : asConst(m_bannedIPs.value()))
+        m_bannedAddresses.insert(QHostAddress(ip));
+
     if (isIPFilteringEnabled()) {
         // Manually banned IPs are handled in that function too(in the slots)
         enableIPFilter();
@@ -482,14 +659,17 @@ Session::Session(QObject *parent)
 
     m_tags = QSet<QString>::fromList(m_storedTags.value());
 
+    m_categoryBandwidthClasses = toBandwidthClasses(m_storedCategoryBandwidthClasses);
+    m_tagBandwidthClasses = toBandwidthClasses(m_storedTagBandwidthClasses);
+
     m_refreshTimer = new QTimer(this);
     m_refreshTimer->setInterval(refreshInterval());
     connect(m_refreshTimer, &QTimer::timeout, this, &Session::refresh);
     m_refreshTimer->start();
 
     m_statistics = new Statistics(this);
+    m_trackerHostIndex = new TrackerHostIndex(this);
 
-    updateSeedingLimitTimer();
     populateAdditionalTrackers();
 
     enableTracker(isTrackerEnabled());
@@ -509,6 +689,16 @@ Session::Session(QObject *parent)
     connect(m_ioThread, &QThread::finished, m_resumeDataSavingManager, &QObject::deleteLater);
     m_ioThread->start();
 
+    m_dataFetchThread = new QThread(this);
+    m_dataFetcher = new TorrentDataFetcher;
+    m_dataFetcher->moveToThread(m_dataFetchThread);
+    connect(m_dataFetchThread, &QThread::finished, m_dataFetcher, &QObject::deleteLater);
+    connect(m_dataFetcher, &TorrentDataFetcher::filesProgressFetched, this, &Session::handleFilesProgressFetched);
+    connect(m_dataFetcher, &TorrentDataFetcher::pieceAvailabilityFetched, this, &Session::handlePieceAvailabilityFetched);
+    connect(m_dataFetcher, &TorrentDataFetcher::downloadingPiecesFetched, this, &Session::handleDownloadingPiecesFetched);
+    connect(m_dataFetcher, &TorrentDataFetcher::embeddedTorrentFound, this, &Session::handleEmbeddedTorrentFound);
+    m_dataFetchThread->start();
+
     // Regular saving of fastresume data
     m_resumeDataTimer = new QTimer(this);
     connect(m_resumeDataTimer, &QTimer::timeout, this, [this]() { generateResumeData(); });
@@ -782,6 +972,15 @@ bool Session::removeCategory(const QString &name)
         // update stored categories
         m_storedCategories = map_cast(m_categories);
         emit categoryRemoved(name);
+
+        const int classCount = m_categoryBandwidthClasses.size();
+        const QString test = name + '/';
+        Algorithm::removeIf(m_categoryBandwidthClasses, [&name, &test](const QString &category, const BandwidthClass &)
+        {
+            return ((category == name) || category.startsWith(test));
+        });
+        if (m_categoryBandwidthClasses.size() != classCount)
+            m_storedCategoryBandwidthClasses = fromBandwidthClasses(m_categoryBandwidthClasses);
     }
 
     return result;
@@ -846,12 +1045,50 @@ bool Session::removeTag(const QString &tag)
         for (TorrentHandle *const torrent : asConst(torrents()))
             torrent->removeTag(tag);
         m_storedTags = m_tags.toList();
+        if (m_tagBandwidthClasses.remove(tag) > 0)
+            m_storedTagBandwidthClasses = fromBandwidthClasses(m_tagBandwidthClasses);
         emit tagRemoved(tag);
         return true;
     }
     return false;
 }
 
+BandwidthClass Session::categoryBandwidthClass(const QString &categoryName) const
+{
+    return m_categoryBandwidthClasses.value(categoryName);
+}
+
+bool Session::setCategoryBandwidthClass(const QString &categoryName, const BandwidthClass &bandwidthClass)
+{
+    if (!m_categories.contains(categoryName))
+        return false;
+
+    if (bandwidthClass.isDefault())
+        m_categoryBandwidthClasses.remove(categoryName);
+    else
+        m_categoryBandwidthClasses[categoryName] = bandwidthClass;
+    m_storedCategoryBandwidthClasses = fromBandwidthClasses(m_categoryBandwidthClasses);
+    return true;
+}
+
+BandwidthClass Session::tagBandwidthClass(const QString &tag) const
+{
+    return m_tagBandwidthClasses.value(tag);
+}
+
+bool Session::setTagBandwidthClass(const QString &tag, const BandwidthClass &bandwidthClass)
+{
+    if (!hasTag(tag))
+        return false;
+
+    if (bandwidthClass.isDefault())
+        m_tagBandwidthClasses.remove(tag);
+    else
+        m_tagBandwidthClasses[tag] = bandwidthClass;
+    m_storedTagBandwidthClasses = fromBandwidthClasses(m_tagBandwidthClasses);
+    return true;
+}
+
 bool Session::isAutoTMMDisabledByDefault() const
 {
     return m_isAutoTMMDisabledByDefault;
@@ -929,7 +1166,7 @@ void Session::setGlobalMaxRatio(qreal ratio)
 
     if (ratio != globalMaxRatio()) {
         m_globalMaxRatio = ratio;
-        updateSeedingLimitTimer();
+        updateShareLimits();
     }
 }
 
@@ -945,7 +1182,7 @@ void Session::setGlobalMaxSeedingMinutes(int minutes)
 
     if (minutes != globalMaxSeedingMinutes()) {
         m_globalMaxSeedingMinutes = minutes;
-        updateSeedingLimitTimer();
+        updateShareLimits();
     }
 }
 
@@ -964,6 +1201,9 @@ Session::~Session()
     // we delete lt::session
     delete Net::PortForwarder::instance();
 
+    m_dataFetchThread->quit();
+    m_dataFetchThread->wait();
+
     qDebug("Deleting the session");
     delete m_nativeSession;
 
@@ -1033,12 +1273,9 @@ void Session::configure()
 void Session::processBannedIPs(lt::ip_filter &filter)
 {
     // First, import current filter
-    for (const QString &ip : asConst(m_bannedIPs.value())) {
-        boost::system::error_code ec;
-        const lt::address addr = lt::address::from_string(ip.toLatin1().constData(), ec);
-        Q_ASSERT(!ec);
-        if (!ec)
-            filter.add_rule(addr, addr, lt::ip_filter::blocked);
+    for (const QHostAddress &address : asConst(m_bannedAddresses)) {
+        const lt::address addr = toLTAddress(address);
+        filter.add_rule(addr, addr, lt::ip_filter::blocked);
     }
 }
 
@@ -1137,6 +1374,22 @@ void Session::initMetrics()
 
     m_metricIndices.disk.diskJobTime = lt::find_metric_idx("disk.disk_job_time");
     Q_ASSERT(m_metricIndices.disk.diskJobTime >= 0);
+
+    // Keep track of every metric for the exporters
+    const std::vector<lt::stats_metric> allMetrics = lt::session_stats_metrics();
+    m_metrics.reserve(static_cast<int>(allMetrics.size()));
+    m_metricValueIndices.reserve(static_cast<int>(allMetrics.size()));
+    for (const lt::stats_metric &metric : allMetrics) {
+        SessionMetric sessionMetric;
+        sessionMetric.name = QString::fromLatin1(metric.name);
+#if (LIBTORRENT_VERSION_NUM < 10200)
+        sessionMetric.isGauge = (metric.type == lt::stats_metric::type_gauge);
+#else
+        sessionMetric.isGauge = (metric.type == lt::metric_type_t::gauge);
+#endif
+        m_metrics.append(sessionMetric);
+        m_metricValueIndices.append(metric.value_index);
+    }
 }
 
 void Session::configure(lt::settings_pack &settingsPack)
@@ -1474,6 +1727,139 @@ void Session::configurePeerClasses()
     m_nativeSession->set_peer_class_type_filter(peerClassTypeFilter);
 }
 
+// libtorrent doesn't allow to assign peer classes to torrents so bandwidth
+// classes are applied as per torrent rate limits, recalculated on each state
+// update according to the current torrent rates
+void Session::applyBandwidthClasses()
+{
+    if (m_categoryBandwidthClasses.isEmpty() && m_tagBandwidthClasses.isEmpty()) {
+        if (m_hasBandwidthClassLimits) {
+            for (TorrentHandle *const torrent : asConst(m_torrents))
+                torrent->setBandwidthClassLimits(0, 0);
+            m_hasBandwidthClassLimits = false;
+        }
+        return;
+    }
+    m_hasBandwidthClassLimits = true;
+
+    const auto findCategoryClass = [this](const QString &category) -> const BandwidthClass *
+    {
+        if (!isSubcategoriesEnabled()) {
+            const auto iter = m_categoryBandwidthClasses.constFind(category);
+            return ((iter != m_categoryBandwidthClasses.cend()) ? &iter.value() : nullptr);
+        }
+
+        // the nearest category having a class applies
+        const QStringList categories = expandCategory(category);
+        for (auto it = categories.crbegin(); it != categories.crend(); ++it) {
+            const auto iter = m_categoryBandwidthClasses.constFind(*it);
+            if (iter != m_categoryBandwidthClasses.cend())
+                return &iter.value();
+        }
+        return nullptr;
+    };
+
+    QVector<TorrentHandle *> torrents;
+    torrents.reserve(m_torrents.size());
+    QVector<int> weights;
+    weights.reserve(m_torrents.size());
+    QHash<const BandwidthClass *, QVector<int>> classMembers;
+
+    for (TorrentHandle *const torrent : asConst(m_torrents)) {
+        const int index = torrents.size();
+        torrents << torrent;
+
+        int weight = 1;
+        const auto addToClass = [&classMembers, &weight, index](const BandwidthClass *bandwidthClass)
+        {
+            classMembers[bandwidthClass] << index;
+            weight = std::max(weight, bandwidthClass->priority);
+        };
+
+        if (const BandwidthClass *bandwidthClass = findCategoryClass(torrent->category()))
+            addToClass(bandwidthClass);
+        for (const QString &tag : asConst(torrent->tags())) {
+            const auto iter = m_tagBandwidthClasses.constFind(tag);
+            if (iter != m_tagBandwidthClasses.cend())
+                addToClass(&iter.value());
+        }
+
+        weights << weight;
+    }
+
+    // Returns limits for torrents in one direction, 0 means unlimited
+    const auto calculateLimits = [&torrents, &weights, &classMembers](const int globalLimit
+            , int BandwidthClass::*classLimit, int (TorrentHandle::*payloadRate)() const
+            , const bool isDownload) -> QVector<int>
+    {
+        QVector<bool> isActive(torrents.size(), false);
+        QVector<qint64> demands(torrents.size(), 0);
+        for (int i = 0; i < torrents.size(); ++i) {
+            const TorrentHandle *torrent = torrents[i];
+            isActive[i] = !torrent->isPaused() && (!isDownload || torrent->isDownloading());
+            if (isActive[i]) {
+                const qint64 rate = (torrent->*payloadRate)();
+                demands[i] = rate + std::max(rate / 4, CLASS_RATE_HEADROOM);
+            }
+        }
+
+        QVector<qint64> limits(torrents.size(), 0);
+        const auto applyShares = [&limits](const QVector<int> &indexes, const QVector<qint64> &shares)
+        {
+            for (int j = 0; j < indexes.size(); ++j) {
+                qint64 &limit = limits[indexes[j]];
+                limit = ((limit > 0) ? std::min(limit, shares[j]) : shares[j]);
+            }
+        };
+
+        // Split the class limits between the class torrents
+        for (auto it = classMembers.cbegin(); it != classMembers.cend(); ++it) {
+            const int limit = it.key()->*classLimit;
+            if (limit <= 0)
+                continue;
+
+            QVector<int> indexes;
+            QVector<qint64> memberDemands;
+            for (const int i : it.value()) {
+                if (isActive[i]) {
+                    indexes << i;
+                    memberDemands << demands[i];
+                }
+            }
+            applyShares(indexes, splitBandwidth(limit, memberDemands, QVector<int>(indexes.size(), 1)));
+        }
+
+        // Split the global limit between all the torrents according to class priorities
+        if (globalLimit > 0) {
+            QVector<int> indexes;
+            QVector<qint64> cappedDemands;
+            QVector<int> activeWeights;
+            for (int i = 0; i < torrents.size(); ++i) {
+                if (isActive[i]) {
+                    indexes << i;
+                    cappedDemands << ((limits[i] > 0) ? std::min(demands[i], limits[i]) : demands[i]);
+                    activeWeights << weights[i];
+                }
+            }
+            applyShares(indexes, splitBandwidth(globalLimit, cappedDemands, activeWeights));
+        }
+
+        QVector<int> result(torrents.size(), 0);
+        for (int i = 0; i < torrents.size(); ++i) {
+            if (isActive[i] && (limits[i] > 0))
+                result[i] = roundClassRateLimit(limits[i]);
+        }
+        return result;
+    };
+
+    const QVector<int> uploadLimits = calculateLimits(uploadSpeedLimit(), &BandwidthClass::uploadLimit
+            , &TorrentHandle::uploadPayloadRate, false);
+    const QVector<int> downloadLimits = calculateLimits(downloadSpeedLimit(), &BandwidthClass::downloadLimit
+            , &TorrentHandle::downloadPayloadRate, true);
+    for (int i = 0; i < torrents.size(); ++i)
+        torrents[i]->setBandwidthClassLimits(uploadLimits[i], downloadLimits[i]);
+}
+
 void Session::enableTracker(const bool enable)
 {
     if (enable) {
@@ -1512,59 +1898,141 @@ void Session::populateAdditionalTrackers()
     }
 }
 
+// Handles the seeding time deadlines that have passed.
+// Their torrents are rechecked with fresh status since a torrent
+// could have been seeding slower than predicted (e.g. while finished).
 void Session::processShareLimits()
 {
     qDebug("Processing share limits...");
 
-    for (TorrentHandle *const torrent : asConst(torrents())) {
-        if (torrent->isSeed() && !torrent->isForced()) {
-            if (torrent->ratioLimit() != TorrentHandle::NO_RATIO_LIMIT) {
-                const qreal ratio = torrent->realRatio();
-                qreal ratioLimit = torrent->ratioLimit();
-                if (ratioLimit == TorrentHandle::USE_GLOBAL_RATIO)
-                    // If Global Max Ratio is really set...
-                    ratioLimit = globalMaxRatio();
-
-                if (ratioLimit >= 0) {
-                    qDebug("Ratio: %f (limit: %f)", ratio, ratioLimit);
-
-                    if ((ratio <= TorrentHandle::MAX_RATIO) && (ratio >= ratioLimit)) {
-                        if (m_maxRatioAction == Remove) {
-                            LogMsg(tr("'%1' reached the maximum ratio you set. Removed.").arg(torrent->name()));
-                            deleteTorrent(torrent->hash());
-                        }
-                        else if (!torrent->isPaused()) {
-                            torrent->pause();
-                            LogMsg(tr("'%1' reached the maximum ratio you set. Paused.").arg(torrent->name()));
-                        }
-                        continue;
-                    }
+    const qint64 now = m_shareLimitClock.elapsed();
+    QVector<InfoHash> dueTorrents;
+    for (auto i = m_seedingTimeDeadlines.cbegin(); (i != m_seedingTimeDeadlines.cend()) && (i.key() <= now); ++i)
+        dueTorrents << i.value();
+
+    QVector<TorrentHandle *> updatedTorrents;
+    updatedTorrents.reserve(dueTorrents.size());
+    for (const InfoHash &hash : asConst(dueTorrents)) {
+        removeShareLimitDeadline(hash);
+        TorrentHandle *const torrent = m_torrents.value(hash);
+        if (!torrent) continue;
+
+        torrent->handleStateUpdate(torrent->nativeHandle().status());
+        updateTorrentStatusReport(torrent);
+        updatedTorrents.push_back(torrent);
+    }
+
+    if (!updatedTorrents.isEmpty())
+        emit torrentsUpdated(updatedTorrents);
+
+    // Limits are applied after the update is reported since they can remove torrents
+    for (TorrentHandle *const torrent : asConst(updatedTorrents)) {
+        if (!applyShareLimits(torrent))
+            updateShareLimitDeadline(torrent);
+    }
+
+    updateSeedingLimitTimer();
+}
+
+// Returns true if the torrent has reached one of its limits
+bool Session::applyShareLimits(TorrentHandle *const torrent)
+{
+    if (!torrent->isSeed() || torrent->isForced())
+        return false;
+
+    if (torrent->ratioLimit() != TorrentHandle::NO_RATIO_LIMIT) {
+        const qreal ratioLimit = torrent->maxRatio();
+        if (ratioLimit >= 0) {
+            const qreal ratio = torrent->realRatio();
+            qDebug("Ratio: %f (limit: %f)", ratio, ratioLimit);
+
+            if ((ratio <= TorrentHandle::MAX_RATIO) && (ratio >= ratioLimit)) {
+                removeShareLimitDeadline(torrent->hash());
+                if (m_maxRatioAction == Remove) {
+                    LogMsg(tr("'%1' reached the maximum ratio you set. Removed.").arg(torrent->name()));
+                    deleteTorrent(torrent->hash());
                 }
+                else if (!torrent->isPaused()) {
+                    torrent->pause();
+                    LogMsg(tr("'%1' reached the maximum ratio you set. Paused.").arg(torrent->name()));
+                }
+                return true;
             }
+        }
+    }
 
-            if (torrent->seedingTimeLimit() != TorrentHandle::NO_SEEDING_TIME_LIMIT) {
-                const qlonglong seedingTimeInMinutes = torrent->seedingTime() / 60;
-                int seedingTimeLimit = torrent->seedingTimeLimit();
-                if (seedingTimeLimit == TorrentHandle::USE_GLOBAL_SEEDING_TIME) {
-                     // If Global Seeding Time Limit is really set...
-                    seedingTimeLimit = globalMaxSeedingMinutes();
+    if (torrent->seedingTimeLimit() != TorrentHandle::NO_SEEDING_TIME_LIMIT) {
+        const int seedingTimeLimit = torrent->maxSeedingTime();
+        if (seedingTimeLimit >= 0) {
+            const qlonglong seedingTimeInMinutes = torrent->seedingTime() / 60;
+            if ((seedingTimeInMinutes <= TorrentHandle::MAX_SEEDING_TIME) && (seedingTimeInMinutes >= seedingTimeLimit)) {
+                removeShareLimitDeadline(torrent->hash());
+                if (m_maxRatioAction == Remove) {
+                    LogMsg(tr("'%1' reached the maximum seeding time you set. Removed.").arg(torrent->name()));
+                    deleteTorrent(torrent->hash());
                 }
-
-                if (seedingTimeLimit >= 0) {
-                    if ((seedingTimeInMinutes <= TorrentHandle::MAX_SEEDING_TIME) && (seedingTimeInMinutes >= seedingTimeLimit)) {
-                        if (m_maxRatioAction == Remove) {
-                            LogMsg(tr("'%1' reached the maximum seeding time you set. Removed.").arg(torrent->name()));
-                            deleteTorrent(torrent->hash());
-                        }
-                        else if (!torrent->isPaused()) {
-                            torrent->pause();
-                            LogMsg(tr("'%1' reached the maximum seeding time you set. Paused.").arg(torrent->name()));
-                        }
-                    }
+                else if (!torrent->isPaused()) {
+                    torrent->pause();
+                    LogMsg(tr("'%1' reached the maximum seeding time you set. Paused.").arg(torrent->name()));
                 }
+                return true;
             }
         }
     }
+
+    return false;
+}
+
+// Predicts when the torrent reaches its seeding time limit.
+// Seeding time only grows while the torrent is seeding, and any change
+// of its state comes with a status update that reschedules the deadline.
+void Session::updateShareLimitDeadline(TorrentHandle *const torrent)
+{
+    const int seedingTimeLimit = (torrent->seedingTimeLimit() == TorrentHandle::NO_SEEDING_TIME_LIMIT)
+        ? TorrentHandle::NO_SEEDING_TIME_LIMIT : torrent->maxSeedingTime();
+    // Seeding time beyond MAX_SEEDING_TIME is never checked against the limit
+    if ((seedingTimeLimit < 0) || !torrent->isSeed() || torrent->isForced() || torrent->isPaused()
+            || ((torrent->seedingTime() / 60) > TorrentHandle::MAX_SEEDING_TIME)) {
+        removeShareLimitDeadline(torrent->hash());
+        return;
+    }
+
+    const qint64 remaining = std::max<qint64>(0, (seedingTimeLimit * 60LL) - torrent->seedingTime());
+    const qint64 deadline = m_shareLimitClock.elapsed() + (remaining * 1000);
+
+    const auto indexIter = m_seedingTimeDeadlineIndex.find(torrent->hash());
+    if (indexIter != m_seedingTimeDeadlineIndex.end()) {
+        // Status updates come every second for active torrents, don't reorder the queue needlessly
+        if (qAbs(indexIter.value() - deadline) < 1000)
+            return;
+
+        m_seedingTimeDeadlines.remove(indexIter.value(), torrent->hash());
+        indexIter.value() = deadline;
+    }
+    else {
+        m_seedingTimeDeadlineIndex.insert(torrent->hash(), deadline);
+    }
+    m_seedingTimeDeadlines.insert(deadline, torrent->hash());
+}
+
+void Session::removeShareLimitDeadline(const InfoHash &hash)
+{
+    const auto indexIter = m_seedingTimeDeadlineIndex.find(hash);
+    if (indexIter == m_seedingTimeDeadlineIndex.end()) return;
+
+    m_seedingTimeDeadlines.remove(indexIter.value(), hash);
+    m_seedingTimeDeadlineIndex.erase(indexIter);
+}
+
+// Reevaluates all torrents, used when the global limits are changed
+void Session::updateShareLimits()
+{
+    for (TorrentHandle *const torrent : asConst(torrents())) {
+        if (!applyShareLimits(torrent))
+            updateShareLimitDeadline(torrent);
+    }
+
+    updateSeedingLimitTimer();
 }
 
 // Add to BitTorrent session the downloaded torrent file
@@ -1616,72 +2084,135 @@ bool Session::hasRunningSeed() const
 
 void Session::banIP(const QString &ip)
 {
-    QStringList bannedIPs = m_bannedIPs;
-    if (!bannedIPs.contains(ip)) {
+    banIPs({ip});
+}
+
+void Session::banIPs(const QStringList &ips)
+{
+    for (const QString &ip : ips) {
+        const QHostAddress address {ip};
+        Q_ASSERT(!address.isNull());
+        if (address.isNull() || m_bannedAddresses.contains(address))
+            continue;
+
+        m_bannedAddresses.insert(address);
+        m_pendingBans.append(address);
+    }
+
+    // Bans are collected and applied to the session filter in one go
+    if (!m_pendingBans.isEmpty() && !m_pendingBansScheduled) {
+#if (QT_VERSION >= QT_VERSION_CHECK(5, 10, 0))
+        QMetaObject::invokeMethod(this, &Session::applyPendingBans, Qt::QueuedConnection);
+#else
+        QMetaObject::invokeMethod(this, "applyPendingBans", Qt::QueuedConnection);
+#endif
+        m_pendingBansScheduled = true;
+    }
+}
+
+void Session::applyPendingBans()
+{
+    m_pendingBansScheduled = false;
+    if (m_pendingBans.isEmpty()) return;
+
+    // The filter is going to be rebuilt from m_bannedAddresses anyway
+    if (!m_IPFilteringChanged) {
         lt::ip_filter filter = m_nativeSession->get_ip_filter();
-        boost::system::error_code ec;
-        const lt::address addr = lt::address::from_string(ip.toLatin1().constData(), ec);
-        Q_ASSERT(!ec);
-        if (ec) return;
-        filter.add_rule(addr, addr, lt::ip_filter::blocked);
+        for (const QHostAddress &address : asConst(m_pendingBans)) {
+            const lt::address addr = toLTAddress(address);
+            filter.add_rule(addr, addr, lt::ip_filter::blocked);
+        }
         m_nativeSession->set_ip_filter(filter);
-
-        bannedIPs << ip;
-        bannedIPs.sort();
-        m_bannedIPs = bannedIPs;
     }
+
+    QStringList newBannedIPs;
+    newBannedIPs.reserve(m_pendingBans.size());
+    for (const QHostAddress &address : asConst(m_pendingBans))
+        newBannedIPs << address.toString();
+    m_pendingBans.clear();
+
+    QStringList bannedIPs = m_bannedIPs + newBannedIPs;
+    bannedIPs.sort();
+    m_bannedIPs = bannedIPs;
+
+    emit IPsBanned(newBannedIPs);
 }
 
 // Delete a torrent from the session, given its hash
 // deleteLocalFiles = true means that the torrent will be removed from the hard-drive too
 bool Session::deleteTorrent(const QString &hash, const bool deleteLocalFiles)
 {
-    TorrentHandle *const torrent = m_torrents.take(hash);
-    if (!torrent) return false;
+    return (deleteTorrents({hash}, deleteLocalFiles) > 0);
+}
+
+// Torrents are announced to be removed all at once before any of them
+// is deleted, so that listeners can process them as a single batch
+int Session::deleteTorrents(const QStringList &hashes, const bool deleteLocalFiles)
+{
+    QVector<TorrentHandle *> torrents;
+    torrents.reserve(hashes.size());
+    for (const QString &hash : hashes) {
+        TorrentHandle *const torrent = m_torrents.take(hash);
+        if (torrent) {
+            removeShareLimitDeadline(torrent->hash());
+            removeFromTorrentStatusReport(torrent->hash());
+            torrents << torrent;
+        }
+    }
+
+    updateSeedingLimitTimer();
 
-    qDebug("Deleting torrent with hash: %s", qUtf8Printable(torrent->hash()));
-    emit torrentAboutToBeRemoved(torrent);
+    if (torrents.isEmpty()) return 0;
 
-    // Remove it from session
-    if (deleteLocalFiles) {
-        const QString rootPath = torrent->rootPath(true);
-        if (!rootPath.isEmpty())
-            // torrent with root folder
-            m_removingTorrents[torrent->hash()] = {torrent->name(), rootPath, deleteLocalFiles};
-        else if (torrent->useTempPath())
-            // torrent without root folder still has it in its temporary save path
-            m_removingTorrents[torrent->hash()] = {torrent->name(), torrent->savePath(true), deleteLocalFiles};
-        else
+    emit torrentsAboutToBeRemoved(torrents);
+
+    for (TorrentHandle *const torrent : asConst(torrents)) {
+        qDebug("Deleting torrent with hash: %s", qUtf8Printable(torrent->hash()));
+        emit torrentAboutToBeRemoved(torrent);
+        m_trackerHostIndex->removeTorrent(torrent->hash());
+
+        // Remove it from session
+        if (deleteLocalFiles) {
+            const QString rootPath = torrent->rootPath(true);
+            if (!rootPath.isEmpty())
+                // torrent with root folder
+                m_removingTorrents[torrent->hash()] = {torrent->name(), rootPath, deleteLocalFiles};
+            else if (torrent->useTempPath())
+                // torrent without root folder still has it in its temporary save path
+                m_removingTorrents[torrent->hash()] = {torrent->name(), torrent->savePath(true), deleteLocalFiles};
+            else
+                m_removingTorrents[torrent->hash()] = {torrent->name(), "", deleteLocalFiles};
+            m_nativeSession->remove_torrent(torrent->nativeHandle(), lt::session::delete_files);
+        }
+        else {
             m_removingTorrents[torrent->hash()] = {torrent->name(), "", deleteLocalFiles};
-        m_nativeSession->remove_torrent(torrent->nativeHandle(), lt::session::delete_files);
-    }
-    else {
-        m_removingTorrents[torrent->hash()] = {torrent->name(), "", deleteLocalFiles};
-        QStringList unwantedFiles;
-        if (torrent->hasMetadata())
-            unwantedFiles = torrent->absoluteFilePathsUnwanted();
-        m_nativeSession->remove_torrent(torrent->nativeHandle(), lt::session::delete_partfile);
-        // Remove unwanted and incomplete files
-        for (const QString &unwantedFile : asConst(unwantedFiles)) {
-            qDebug("Removing unwanted file: %s", qUtf8Printable(unwantedFile));
-            Utils::Fs::forceRemove(unwantedFile);
-            const QString parentFolder = Utils::Fs::branchPath(unwantedFile);
-            qDebug("Attempt to remove parent folder (if empty): %s", qUtf8Printable(parentFolder));
-            QDir().rmdir(parentFolder);
+            QStringList unwantedFiles;
+            if (torrent->hasMetadata())
+                unwantedFiles = torrent->absoluteFilePathsUnwanted();
+            m_nativeSession->remove_torrent(torrent->nativeHandle(), lt::session::delete_partfile);
+            // Remove unwanted and incomplete files
+            for (const QString &unwantedFile : asConst(unwantedFiles)) {
+                qDebug("Removing unwanted file: %s", qUtf8Printable(unwantedFile));
+                Utils::Fs::forceRemove(unwantedFile);
+                const QString parentFolder = Utils::Fs::branchPath(unwantedFile);
+                qDebug("Attempt to remove parent folder (if empty): %s", qUtf8Printable(parentFolder));
+                QDir().rmdir(parentFolder);
+            }
         }
+
+        // Remove it from torrent resume directory
+        const QDir resumeDataDir(m_resumeFolderPath);
+        QStringList filters;
+        filters << QString("%1.*").arg(torrent->hash());
+        const QStringList files = resumeDataDir.entryList(filters, QDir::Files, QDir::Unsorted);
+        for (const QString &file : files)
+            Utils::Fs::forceRemove(resumeDataDir.absoluteFilePath(file));
+
+        delete torrent;
+        qDebug("Torrent deleted.");
     }
 
-    // Remove it from torrent resume directory
-    const QDir resumeDataDir(m_resumeFolderPath);
-    QStringList filters;
-    filters << QString("%1.*").arg(torrent->hash());
-    const QStringList files = resumeDataDir.entryList(filters, QDir::Files, QDir::Unsorted);
-    for (const QString &file : files)
-        Utils::Fs::forceRemove(resumeDataDir.absoluteFilePath(file));
-
-    delete torrent;
-    qDebug("Torrent deleted.");
-    return true;
+    return torrents.size();
 }
 
 bool Session::cancelLoadMetadata(const InfoHash &hash)
@@ -1818,6 +2349,11 @@ TorrentStatusReport Session::torrentStatusReport() const
     return m_torrentStatusReport;
 }
 
+const TrackerHostIndex *Session::trackerHostIndex() const
+{
+    return m_trackerHostIndex;
+}
+
 bool Session::addTorrent(const QString &source, const AddTorrentParams &params)
 {
     // `source`: .torrent file path/url or magnet uri
@@ -2149,21 +2685,18 @@ void Session::exportTorrentFile(TorrentHandle *const torrent, TorrentExportFolde
 
     const QString validName = Utils::Fs::toValidFileSystemName(torrent->name());
     const QString torrentFilename = QString("%1.torrent").arg(torrent->hash());
-    QString torrentExportFilename = QString("%1.torrent").arg(validName);
-    const QString torrentPath = QDir(m_resumeFolderPath).absoluteFilePath(torrentFilename);
-    const QDir exportPath(folder == TorrentExportFolder::Regular ? torrentExportDirectory() : finishedTorrentExportDirectory());
-    if (exportPath.exists() || exportPath.mkpath(exportPath.absolutePath())) {
-        QString newTorrentPath = exportPath.absoluteFilePath(torrentExportFilename);
-        int counter = 0;
-        while (QFile::exists(newTorrentPath) && !Utils::Fs::sameFiles(torrentPath, newTorrentPath)) {
-            // Append number to torrent name to make it unique
-            torrentExportFilename = QString("%1 %2.torrent").arg(validName).arg(++counter);
-            newTorrentPath = exportPath.absoluteFilePath(torrentExportFilename);
-        }
-
-        if (!QFile::exists(newTorrentPath))
-            QFile::copy(torrentPath, newTorrentPath);
-    }
+    const QString exportPath = (folder == TorrentExportFolder::Regular) ? torrentExportDirectory() : finishedTorrentExportDirectory();
+    // Copying is done by the I/O thread after the .torrent file is saved in the resume folder
+#if (QT_VERSION >= QT_VERSION_CHECK(5, 10, 0))
+    QMetaObject::invokeMethod(m_resumeDataSavingManager
+        , [this, torrentFilename, exportPath, validName]()
+    {
+        m_resumeDataSavingManager->exportTorrent(torrentFilename, exportPath, validName);
+    });
+#else
+    QMetaObject::invokeMethod(m_resumeDataSavingManager, "exportTorrent"
+        , Q_ARG(QString, torrentFilename), Q_ARG(QString, exportPath), Q_ARG(QString, validName));
+#endif
 }
 
 void Session::generateResumeData(const bool final)
@@ -2194,22 +2727,32 @@ void Session::saveResumeData()
         saveTorrentsQueue();
     generateResumeData(true);
 
+    // Alerts are read here directly from now on, starting
+    // with the ones that the reader thread has already read
+    m_alertReader->stop();
+    AlertBatch batch;
+    m_alertReader->takeBatch(batch);
+
     while (m_numResumeData > 0) {
-        std::vector<lt::alert *> alerts;
-        getPendingAlerts(alerts, 30 * 1000);
-        if (alerts.empty()) {
-            fprintf(stderr, " aborting with %d outstanding torrents to save resume data for\n", m_numResumeData);
-            break;
+        if (batch.alerts.empty()) {
+            std::vector<lt::alert *> alerts;
+            getPendingAlerts(alerts, 30 * 1000);
+            if (alerts.empty()) {
+                fprintf(stderr, " aborting with %d outstanding torrents to save resume data for\n", m_numResumeData);
+                break;
+            }
+            batch = m_alertReader->makeBatch(alerts);
         }
 
-        for (const auto a : alerts) {
-            switch (a->type()) {
+        for (const AlertData &a : batch.alerts) {
+            switch (a.type) {
             case lt::save_resume_data_failed_alert::alert_type:
             case lt::save_resume_data_alert::alert_type:
                 dispatchTorrentAlert(a);
                 break;
             }
         }
+        batch.alerts.clear();
     }
 }
 
@@ -2747,6 +3290,10 @@ void Session::setBannedIPs(const QStringList &newList)
     // also here we have to recreate filter list including 3rd party ban file
     // and install it again into m_session
     m_bannedIPs = filteredList;
+    m_bannedAddresses.clear();
+    for (const QString &ip : asConst(filteredList))
+        m_bannedAddresses.insert(QHostAddress(ip));
+    m_pendingBans.clear();
     m_IPFilteringChanged = true;
     configureDeferred();
 }
@@ -2756,6 +3303,30 @@ QStringList Session::bannedIPs() const
     return m_bannedIPs;
 }
 
+bool Session::isPeerAutoBanEnabled() const
+{
+    return m_isPeerAutoBanEnabled;
+}
+
+void Session::setPeerAutoBanEnabled(const bool enabled)
+{
+    if (enabled == m_isPeerAutoBanEnabled) return;
+
+    m_isPeerAutoBanEnabled = enabled;
+    if (!enabled)
+        m_peerBanCounts.clear();
+}
+
+int Session::peerAutoBanThreshold() const
+{
+    return m_peerAutoBanThreshold;
+}
+
+void Session::setPeerAutoBanThreshold(const int threshold)
+{
+    m_peerAutoBanThreshold = std::max(1, threshold);
+}
+
 int Session::maxConnectionsPerTorrent() const
 {
     return m_maxConnectionsPerTorrent;
@@ -3327,21 +3898,44 @@ bool Session::isKnownTorrent(const InfoHash &hash) const
             || m_loadedMetadata.contains(hash));
 }
 
+// Schedules the timer to the nearest seeding time deadline
 void Session::updateSeedingLimitTimer()
 {
-    if ((globalMaxRatio() == TorrentHandle::NO_RATIO_LIMIT) && !hasPerTorrentRatioLimit()
-        && (globalMaxSeedingMinutes() == TorrentHandle::NO_SEEDING_TIME_LIMIT) && !hasPerTorrentSeedingTimeLimit()) {
-        if (m_seedingLimitTimer->isActive())
-            m_seedingLimitTimer->stop();
-    }
-    else if (!m_seedingLimitTimer->isActive()) {
-        m_seedingLimitTimer->start();
+    if (m_seedingTimeDeadlines.isEmpty()) {
+        m_seedingLimitTimer->stop();
+        return;
     }
+
+    // Distant deadlines are reached in several steps since timer interval is limited
+    const qint64 maxInterval = 24 * 60 * 60 * 1000;
+    const qint64 interval = m_seedingTimeDeadlines.firstKey() - m_shareLimitClock.elapsed();
+    const int newInterval = static_cast<int>(qBound<qint64>(0, interval, maxInterval));
+    if (!m_seedingLimitTimer->isActive() || (m_seedingLimitTimer->remainingTime() > newInterval))
+        m_seedingLimitTimer->start(newInterval);
+}
+
+// Only the torrents that changed their state are recounted
+void Session::updateTorrentStatusReport(const TorrentHandle *torrent)
+{
+    const uint flags = torrentStatusFlags(torrent);
+    uint &countedFlags = m_torrentStatusFlags[torrent->hash()];
+    if (flags == countedFlags) return;
+
+    addToStatusReport(m_torrentStatusReport, countedFlags, -1);
+    addToStatusReport(m_torrentStatusReport, flags, 1);
+    countedFlags = flags;
+}
+
+void Session::removeFromTorrentStatusReport(const InfoHash &hash)
+{
+    addToStatusReport(m_torrentStatusReport, m_torrentStatusFlags.take(hash), -1);
 }
 
 void Session::handleTorrentShareLimitChanged(TorrentHandle *const torrent)
 {
     torrent->saveResumeData();
+    if (!applyShareLimits(torrent))
+        updateShareLimitDeadline(torrent);
     updateSeedingLimitTimer();
 }
 
@@ -3386,6 +3980,7 @@ void Session::handleTorrentTrackersAdded(TorrentHandle *const torrent, const QVe
 
     for (const TrackerEntry &newTracker : newTrackers)
         LogMsg(tr("Tracker '%1' was added to torrent '%2'").arg(newTracker.url(), torrent->name()));
+    m_trackerHostIndex->updateTorrent(torrent);
     emit trackersAdded(torrent, newTrackers);
     if (torrent->trackers().size() == newTrackers.size())
         emit trackerlessStateChanged(torrent, false);
@@ -3398,6 +3993,7 @@ void Session::handleTorrentTrackersRemoved(TorrentHandle *const torrent, const Q
 
     for (const TrackerEntry &deletedTracker : deletedTrackers)
         LogMsg(tr("Tracker '%1' was deleted from torrent '%2'").arg(deletedTracker.url(), torrent->name()));
+    m_trackerHostIndex->updateTorrent(torrent);
     emit trackersRemoved(torrent, deletedTrackers);
     if (torrent->trackers().size() == 0)
         emit trackerlessStateChanged(torrent, true);
@@ -3407,6 +4003,7 @@ void Session::handleTorrentTrackersRemoved(TorrentHandle *const torrent, const Q
 void Session::handleTorrentTrackersChanged(TorrentHandle *const torrent)
 {
     torrent->saveResumeData();
+    m_trackerHostIndex->updateTorrent(torrent);
     emit trackersChanged(torrent);
 }
 
@@ -3465,24 +4062,23 @@ void Session::handleTorrentFinished(TorrentHandle *const torrent)
     emit torrentFinished(torrent);
 
     qDebug("Checking if the torrent contains torrent files to download");
-    // Check if there are torrent files inside
+    // Check if there are torrent files inside, they are decoded in the data fetching thread
+    QStringList torrentFilePaths;
     for (int i = 0; i < torrent->filesCount(); ++i) {
         const QString torrentRelpath = torrent->filePath(i);
-        if (torrentRelpath.endsWith(".torrent", Qt::CaseInsensitive)) {
-            qDebug("Found possible recursive torrent download.");
-            const QString torrentFullpath = torrent->savePath(true) + '/' + torrentRelpath;
-            qDebug("Full subtorrent path is %s", qUtf8Printable(torrentFullpath));
-            TorrentInfo torrentInfo = TorrentInfo::loadFromFile(torrentFullpath);
-            if (torrentInfo.isValid()) {
-                qDebug("emitting recursiveTorrentDownloadPossible()");
-                emit recursiveTorrentDownloadPossible(torrent);
-                break;
-            }
-            else {
-                qDebug("Caught error loading torrent");
-                LogMsg(tr("Unable to decode '%1' torrent file.").arg(Utils::Fs::toNativePath(torrentFullpath)), Log::CRITICAL);
-            }
-        }
+        if (torrentRelpath.endsWith(".torrent", Qt::CaseInsensitive))
+            torrentFilePaths << (torrent->savePath(true) + '/' + torrentRelpath);
+    }
+    if (!torrentFilePaths.isEmpty()) {
+        qDebug("Found possible recursive torrent download.");
+        const QString hash = torrent->hash();
+#if (QT_VERSION >= QT_VERSION_CHECK(5, 10, 0))
+        QMetaObject::invokeMethod(m_dataFetcher
+            , [this, hash, torrentFilePaths]() { m_dataFetcher->findEmbeddedTorrent(hash, torrentFilePaths); });
+#else
+        QMetaObject::invokeMethod(m_dataFetcher, "findEmbeddedTorrent"
+                                  , Q_ARG(QString, hash), Q_ARG(QStringList, torrentFilePaths));
+#endif
     }
 
     // Move .torrent file to another folder
@@ -3522,33 +4118,87 @@ void Session::handleTorrentResumeDataFailed(TorrentHandle *const torrent)
 
 void Session::handleTorrentTrackerReply(TorrentHandle *const torrent, const QString &trackerUrl)
 {
+    m_trackerHostIndex->handleTrackerReply(torrent->hash(), trackerUrl);
     emit trackerSuccess(torrent, trackerUrl);
 }
 
 void Session::handleTorrentTrackerError(TorrentHandle *const torrent, const QString &trackerUrl)
 {
+    m_trackerHostIndex->handleTrackerError(torrent->hash(), trackerUrl);
     emit trackerError(torrent, trackerUrl);
 }
 
 void Session::handleTorrentTrackerWarning(TorrentHandle *const torrent, const QString &trackerUrl)
 {
+    m_trackerHostIndex->handleTrackerWarning(torrent->hash(), trackerUrl);
     emit trackerWarning(torrent, trackerUrl);
 }
 
-bool Session::hasPerTorrentRatioLimit() const
+void Session::fetchTorrentFilesProgress(const TorrentHandle *torrent)
 {
-    return std::any_of(m_torrents.cbegin(), m_torrents.cend(), [](const TorrentHandle *torrent)
-    {
-        return (torrent->ratioLimit() >= 0);
-    });
+    const QString hash = torrent->hash();
+    const lt::torrent_handle nativeHandle = torrent->nativeHandle();
+#if (QT_VERSION >= QT_VERSION_CHECK(5, 10, 0))
+    QMetaObject::invokeMethod(m_dataFetcher
+        , [this, hash, nativeHandle]() { m_dataFetcher->fetchFilesProgress(hash, nativeHandle); });
+#else
+    QMetaObject::invokeMethod(m_dataFetcher, "fetchFilesProgress"
+                              , Q_ARG(QString, hash), Q_ARG(lt::torrent_handle, nativeHandle));
+#endif
 }
 
-bool Session::hasPerTorrentSeedingTimeLimit() const
+void Session::fetchTorrentPieceAvailability(const TorrentHandle *torrent)
 {
-    return std::any_of(m_torrents.cbegin(), m_torrents.cend(), [](const TorrentHandle *torrent)
-    {
-        return (torrent->seedingTimeLimit() >= 0);
-    });
+    const QString hash = torrent->hash();
+    const lt::torrent_handle nativeHandle = torrent->nativeHandle();
+#if (QT_VERSION >= QT_VERSION_CHECK(5, 10, 0))
+    QMetaObject::invokeMethod(m_dataFetcher
+        , [this, hash, nativeHandle]() { m_dataFetcher->fetchPieceAvailability(hash, nativeHandle); });
+#else
+    QMetaObject::invokeMethod(m_dataFetcher, "fetchPieceAvailability"
+                              , Q_ARG(QString, hash), Q_ARG(lt::torrent_handle, nativeHandle));
+#endif
+}
+
+void Session::fetchTorrentDownloadingPieces(const TorrentHandle *torrent)
+{
+    const QString hash = torrent->hash();
+    const lt::torrent_handle nativeHandle = torrent->nativeHandle();
+#if (QT_VERSION >= QT_VERSION_CHECK(5, 10, 0))
+    QMetaObject::invokeMethod(m_dataFetcher
+        , [this, hash, nativeHandle]() { m_dataFetcher->fetchDownloadingPieces(hash, nativeHandle); });
+#else
+    QMetaObject::invokeMethod(m_dataFetcher, "fetchDownloadingPieces"
+                              , Q_ARG(QString, hash), Q_ARG(lt::torrent_handle, nativeHandle));
+#endif
+}
+
+void Session::handleFilesProgressFetched(const QString &hash, const QVector<qreal> &filesProgress)
+{
+    TorrentHandle *const torrent = m_torrents.value(hash);
+    if (torrent)
+        emit torrentFilesProgressFetched(torrent, filesProgress);
+}
+
+void Session::handlePieceAvailabilityFetched(const QString &hash, const QVector<int> &pieceAvailability)
+{
+    TorrentHandle *const torrent = m_torrents.value(hash);
+    if (torrent)
+        emit torrentPieceAvailabilityFetched(torrent, pieceAvailability);
+}
+
+void Session::handleDownloadingPiecesFetched(const QString &hash, const QBitArray &downloadingPieces)
+{
+    TorrentHandle *const torrent = m_torrents.value(hash);
+    if (torrent)
+        emit torrentDownloadingPiecesFetched(torrent, downloadingPieces);
+}
+
+void Session::handleEmbeddedTorrentFound(const QString &hash)
+{
+    TorrentHandle *const torrent = m_torrents.value(hash);
+    if (torrent)
+        emit recursiveTorrentDownloadPossible(torrent);
 }
 
 void Session::initResumeFolder()
@@ -3645,6 +4295,16 @@ const CacheStatus &Session::cacheStatus() const
     return m_cacheStatus;
 }
 
+const QVector<SessionMetric> &Session::metrics() const
+{
+    return m_metrics;
+}
+
+AlertStatistics Session::alertStatistics() const
+{
+    return m_alertReader->statistics();
+}
+
 // Will resume torrents in backup directory
 void Session::startUpTorrents()
 {
@@ -3825,20 +4485,24 @@ void Session::setCreateTorrentSubfolder(const bool value)
     m_isCreateTorrentSubfolder = value;
 }
 
-// Read alerts sent by the BitTorrent session
+// Handle alerts sent by the BitTorrent session, they are read in a separate thread
 void Session::readAlerts()
 {
-    std::vector<lt::alert *> alerts;
-    getPendingAlerts(alerts);
+    AlertBatch batch;
+    if (!m_alertReader->takeBatch(batch)) return;
 
-    for (const auto a : alerts)
+    // Statuses go first so that they don't overwrite the newer ones
+    // that alert handlers fetch, torrents added by this batch fetch their own
+    if (batch.hasStateUpdate)
+        handleStateUpdate(batch.torrentStatuses);
+    for (const AlertData &a : batch.alerts)
         handleAlert(a);
 }
 
-void Session::handleAlert(const lt::alert *a)
+void Session::handleAlert(const AlertData &a)
 {
     try {
-        switch (a->type()) {
+        switch (a.type) {
         case lt::file_renamed_alert::alert_type:
         case lt::file_completed_alert::alert_type:
         case lt::torrent_finished_alert::alert_type:
@@ -3856,51 +4520,53 @@ void Session::handleAlert(const lt::alert *a)
         case lt::metadata_received_alert::alert_type:
             dispatchTorrentAlert(a);
             break;
-        case lt::state_update_alert::alert_type:
-            handleStateUpdateAlert(static_cast<const lt::state_update_alert*>(a));
-            break;
         case lt::session_stats_alert::alert_type:
-            handleSessionStatsAlert(static_cast<const lt::session_stats_alert*>(a));
+            handleSessionStatsAlert(a);
             break;
         case lt::file_error_alert::alert_type:
-            handleFileErrorAlert(static_cast<const lt::file_error_alert*>(a));
+            handleFileErrorAlert(a);
             break;
         case lt::add_torrent_alert::alert_type:
-            handleAddTorrentAlert(static_cast<const lt::add_torrent_alert*>(a));
+            handleAddTorrentAlert(a);
             break;
         case lt::torrent_removed_alert::alert_type:
-            handleTorrentRemovedAlert(static_cast<const lt::torrent_removed_alert*>(a));
+            handleTorrentRemovedAlert(a);
             break;
         case lt::torrent_deleted_alert::alert_type:
-            handleTorrentDeletedAlert(static_cast<const lt::torrent_deleted_alert*>(a));
+            handleTorrentDeletedAlert(a);
             break;
         case lt::torrent_delete_failed_alert::alert_type:
-            handleTorrentDeleteFailedAlert(static_cast<const lt::torrent_delete_failed_alert*>(a));
+            handleTorrentDeleteFailedAlert(a);
             break;
         case lt::portmap_error_alert::alert_type:
-            handlePortmapWarningAlert(static_cast<const lt::portmap_error_alert*>(a));
+            handlePortmapWarningAlert(a);
             break;
         case lt::portmap_alert::alert_type:
-            handlePortmapAlert(static_cast<const lt::portmap_alert*>(a));
+            handlePortmapAlert(a);
             break;
         case lt::peer_blocked_alert::alert_type:
-            handlePeerBlockedAlert(static_cast<const lt::peer_blocked_alert*>(a));
+            handlePeerBlockedAlert(a);
             break;
         case lt::peer_ban_alert::alert_type:
-            handlePeerBanAlert(static_cast<const lt::peer_ban_alert*>(a));
+            handlePeerBanAlert(a);
             break;
         case lt::url_seed_alert::alert_type:
-            handleUrlSeedAlert(static_cast<const lt::url_seed_alert*>(a));
+            handleUrlSeedAlert(a);
             break;
         case lt::listen_succeeded_alert::alert_type:
-            handleListenSucceededAlert(static_cast<const lt::listen_succeeded_alert*>(a));
+            handleListenSucceededAlert(a);
             break;
         case lt::listen_failed_alert::alert_type:
-            handleListenFailedAlert(static_cast<const lt::listen_failed_alert*>(a));
+            handleListenFailedAlert(a);
             break;
         case lt::external_ip_alert::alert_type:
-            handleExternalIPAlert(static_cast<const lt::external_ip_alert*>(a));
+            handleExternalIPAlert(a);
+            break;
+#if (LIBTORRENT_VERSION_NUM >= 10200)
+        case lt::alerts_dropped_alert::alert_type:
+            LogMsg(tr("Some libtorrent alerts were dropped because the alert queue overflowed."), Log::WARNING);
             break;
+#endif
         }
     }
     catch (const std::exception &exc) {
@@ -3908,20 +4574,20 @@ void Session::handleAlert(const lt::alert *a)
     }
 }
 
-void Session::dispatchTorrentAlert(const lt::alert *a)
+void Session::dispatchTorrentAlert(const AlertData &a)
 {
-    TorrentHandle *const torrent = m_torrents.value(static_cast<const lt::torrent_alert*>(a)->handle.info_hash());
+    TorrentHandle *const torrent = m_torrents.value(a.infoHash);
     if (torrent) {
         torrent->handleAlert(a);
         return;
     }
 
-    switch (a->type()) {
+    switch (a.type) {
     case lt::torrent_paused_alert::alert_type:
-        handleTorrentPausedAlert(static_cast<const lt::torrent_paused_alert*>(a));
+        handleTorrentPausedAlert(a);
         break;
     case lt::metadata_received_alert::alert_type:
-        handleMetadataReceivedAlert(static_cast<const lt::metadata_received_alert*>(a));
+        handleMetadataReceivedAlert(a);
         break;
     }
 }
@@ -3935,6 +4601,7 @@ void Session::createTorrentHandle(const lt::torrent_handle &nativeHandle)
 
     TorrentHandle *const torrent = new TorrentHandle(this, nativeHandle, params);
     m_torrents.insert(torrent->hash(), torrent);
+    updateTorrentStatusReport(torrent);
 
     const bool fromMagnetUri = !torrent->hasMetadata();
 
@@ -3968,9 +4635,10 @@ void Session::createTorrentHandle(const lt::torrent_handle &nativeHandle)
         torrent->saveResumeData();
     }
 
-    if (((torrent->ratioLimit() >= 0) || (torrent->seedingTimeLimit() >= 0))
-        && !m_seedingLimitTimer->isActive())
-        m_seedingLimitTimer->start();
+    updateShareLimitDeadline(torrent);
+    updateSeedingLimitTimer();
+
+    m_trackerHostIndex->updateTorrent(torrent);
 
     // Send torrent addition signal
     emit torrentAdded(torrent);
@@ -3979,22 +4647,22 @@ void Session::createTorrentHandle(const lt::torrent_handle &nativeHandle)
         emit torrentNew(torrent);
 }
 
-void Session::handleAddTorrentAlert(const lt::add_torrent_alert *p)
+void Session::handleAddTorrentAlert(const AlertData &a)
 {
-    if (p->error) {
+    if (a.error) {
         qDebug("/!\\ Error: Failed to add torrent!");
-        QString msg = QString::fromStdString(p->message());
+        QString msg = QString::fromStdString(a.message);
         LogMsg(tr("Couldn't add torrent. Reason: %1").arg(msg), Log::WARNING);
         emit addTorrentFailed(msg);
     }
     else {
-        createTorrentHandle(p->handle);
+        createTorrentHandle(a.handle);
     }
 }
 
-void Session::handleTorrentRemovedAlert(const lt::torrent_removed_alert *p)
+void Session::handleTorrentRemovedAlert(const AlertData &a)
 {
-    const InfoHash infoHash {p->info_hash};
+    const InfoHash infoHash {a.infoHash};
 
     if (m_loadedMetadata.contains(infoHash))
         emit metadataLoaded(m_loadedMetadata.take(infoHash));
@@ -4008,9 +4676,9 @@ void Session::handleTorrentRemovedAlert(const lt::torrent_removed_alert *p)
     }
 }
 
-void Session::handleTorrentDeletedAlert(const lt::torrent_deleted_alert *p)
+void Session::handleTorrentDeletedAlert(const AlertData &a)
 {
-    const InfoHash infoHash {p->info_hash};
+    const InfoHash infoHash {a.infoHash};
 
     if (!m_removingTorrents.contains(infoHash))
         return;
@@ -4020,9 +4688,9 @@ void Session::handleTorrentDeletedAlert(const lt::torrent_deleted_alert *p)
     LogMsg(tr("'%1' was removed from the transfer list and hard disk.", "'xxx.avi' was removed...").arg(tmpRemovingTorrentData.name));
 }
 
-void Session::handleTorrentDeleteFailedAlert(const lt::torrent_delete_failed_alert *p)
+void Session::handleTorrentDeleteFailedAlert(const AlertData &a)
 {
-    const InfoHash infoHash {p->info_hash};
+    const InfoHash infoHash {a.infoHash};
 
     if (!m_removingTorrents.contains(infoHash))
         return;
@@ -4031,9 +4699,9 @@ void Session::handleTorrentDeleteFailedAlert(const lt::torrent_delete_failed_ale
     // so we remove the directory ourselves
     Utils::Fs::smartRemoveEmptyFolderTree(tmpRemovingTorrentData.savePathToRemove);
 
-    if (p->error) {
+    if (a.error) {
         LogMsg(tr("'%1' was removed from the transfer list but the files couldn't be deleted. Error: %2", "'xxx.avi' was removed...")
-                .arg(tmpRemovingTorrentData.name, QString::fromLocal8Bit(p->error.message().c_str()))
+                .arg(tmpRemovingTorrentData.name, QString::fromLocal8Bit(a.error.message().c_str()))
             , Log::WARNING);
     }
     else {
@@ -4041,25 +4709,25 @@ void Session::handleTorrentDeleteFailedAlert(const lt::torrent_delete_failed_ale
     }
 }
 
-void Session::handleMetadataReceivedAlert(const lt::metadata_received_alert *p)
+void Session::handleMetadataReceivedAlert(const AlertData &a)
 {
-    const InfoHash hash {p->handle.info_hash()};
+    const InfoHash hash {a.infoHash};
 
     if (m_loadedMetadata.contains(hash)) {
         --m_extraLimit;
         adjustLimits();
-        m_loadedMetadata[hash] = TorrentInfo(p->handle.torrent_file());
-        m_nativeSession->remove_torrent(p->handle, lt::session::delete_files);
+        m_loadedMetadata[hash] = TorrentInfo(a.handle.torrent_file());
+        m_nativeSession->remove_torrent(a.handle, lt::session::delete_files);
     }
 }
 
-void Session::handleTorrentPausedAlert(const libtorrent::torrent_paused_alert *p)
+void Session::handleTorrentPausedAlert(const AlertData &a)
 {
-    const InfoHash hash {p->handle.info_hash()};
+    const InfoHash hash {a.infoHash};
 
     if (m_addingTorrents.contains(hash)) {
         // Adding preloaded torrent
-        lt::torrent_handle handle = p->handle;
+        lt::torrent_handle handle = a.handle;
         --m_extraLimit;
 
         // Preloaded torrent is in "Upload mode" so we need to disable it
@@ -4076,9 +4744,9 @@ void Session::handleTorrentPausedAlert(const libtorrent::torrent_paused_alert *p
     }
 }
 
-void Session::handleFileErrorAlert(const lt::file_error_alert *p)
+void Session::handleFileErrorAlert(const AlertData &a)
 {
-    TorrentHandle *const torrent = m_torrents.value(p->handle.info_hash());
+    TorrentHandle *const torrent = m_torrents.value(a.infoHash);
     if (!torrent)
         return;
 
@@ -4087,9 +4755,9 @@ void Session::handleFileErrorAlert(const lt::file_error_alert *p)
     if (!m_recentErroredTorrents.contains(hash)) {
         m_recentErroredTorrents.insert(hash);
 
-        const QString msg = QString::fromStdString(p->message());
+        const QString msg = QString::fromStdString(a.message);
         LogMsg(tr("File error alert. Torrent: \"%1\". File: \"%2\". Reason: %3")
-                .arg(torrent->name(), p->filename(), msg)
+                .arg(torrent->name(), QString::fromStdString(a.path), msg)
             , Log::WARNING);
         emit fullDiskError(torrent, msg);
     }
@@ -4097,27 +4765,23 @@ void Session::handleFileErrorAlert(const lt::file_error_alert *p)
     m_recentErroredTorrentsTimer->start();
 }
 
-void Session::handlePortmapWarningAlert(const lt::portmap_error_alert *p)
+void Session::handlePortmapWarningAlert(const AlertData &a)
 {
-    LogMsg(tr("UPnP/NAT-PMP: Port mapping failure, message: %1").arg(QString::fromStdString(p->message())), Log::CRITICAL);
+    LogMsg(tr("UPnP/NAT-PMP: Port mapping failure, message: %1").arg(QString::fromStdString(a.message)), Log::CRITICAL);
 }
 
-void Session::handlePortmapAlert(const lt::portmap_alert *p)
+void Session::handlePortmapAlert(const AlertData &a)
 {
-    qDebug("UPnP Success, msg: %s", p->message().c_str());
-    LogMsg(tr("UPnP/NAT-PMP: Port mapping successful, message: %1").arg(QString::fromStdString(p->message())), Log::INFO);
+    qDebug("UPnP Success, msg: %s", a.message.c_str());
+    LogMsg(tr("UPnP/NAT-PMP: Port mapping successful, message: %1").arg(QString::fromStdString(a.message)), Log::INFO);
 }
 
-void Session::handlePeerBlockedAlert(const lt::peer_blocked_alert *p)
+void Session::handlePeerBlockedAlert(const AlertData &a)
 {
     boost::system::error_code ec;
-#if LIBTORRENT_VERSION_NUM < 10200
-    const std::string ip = p->ip.to_string(ec);
-#else
-    const std::string ip = p->endpoint.address().to_string(ec);
-#endif
+    const std::string ip = a.address.to_string(ec);
     QString reason;
-    switch (p->reason) {
+    switch (a.reason) {
     case lt::peer_blocked_alert::ip_filter:
         reason = tr("due to IP filter.", "this peer was blocked due to ip filter.");
         break;
@@ -4142,31 +4806,60 @@ void Session::handlePeerBlockedAlert(const lt::peer_blocked_alert *p)
         Logger::instance()->addPeer(QString::fromLatin1(ip.c_str()), true, reason);
 }
 
-void Session::handlePeerBanAlert(const lt::peer_ban_alert *p)
+void Session::handlePeerBanAlert(const AlertData &a)
 {
     boost::system::error_code ec;
-#if (LIBTORRENT_VERSION_NUM < 10200)
-    const std::string ip = p->ip.address().to_string(ec);
-#else
-    const std::string ip = p->endpoint.address().to_string(ec);
-#endif
+    const std::string ip = a.address.to_string(ec);
 
-    if (!ec)
-        Logger::instance()->addPeer(QString::fromLatin1(ip.c_str()), false);
+    if (ec) return;
+
+    const QString ipString = QString::fromLatin1(ip.c_str());
+    Logger::instance()->addPeer(ipString, false);
+
+    // libtorrent bans peers only for the torrent they have sent corrupt data to,
+    // repeat offenders get banned from the whole session
+    if (!isPeerAutoBanEnabled()) return;
+
+    const QHostAddress address {ipString};
+    if (address.isNull() || m_bannedAddresses.contains(address)) return;
+
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    if (!m_peerBanCounts.contains(address) && (m_peerBanCounts.size() >= MAX_PEER_BAN_COUNTS)) {
+        Algorithm::removeIf(m_peerBanCounts, [now](const QHostAddress &, const PeerBanCount &banCount)
+        {
+            return ((now - banCount.lastBanTime) > PEER_BAN_COUNT_LIFETIME);
+        });
+        // all of them are recent, forgetting them only delays the automatic bans
+        if (m_peerBanCounts.size() >= MAX_PEER_BAN_COUNTS)
+            m_peerBanCounts.clear();
+    }
+
+    PeerBanCount &peerBanCount = m_peerBanCounts[address];
+    if ((now - peerBanCount.lastBanTime) > PEER_BAN_COUNT_LIFETIME)
+        peerBanCount.count = 0;
+    peerBanCount.lastBanTime = now;
+
+    const int banCount = ++peerBanCount.count;
+    if (banCount < peerAutoBanThreshold()) return;
+
+    m_peerBanCounts.remove(address);
+    LogMsg(tr("Automatically banned peer '%1', it was banned %2 times for sending corrupt data.")
+        .arg(ipString).arg(banCount), Log::INFO);
+    banIP(ipString);
 }
 
-void Session::handleUrlSeedAlert(const lt::url_seed_alert *p)
+void Session::handleUrlSeedAlert(const AlertData &a)
 {
     LogMsg(tr("URL seed lookup failed for URL: '%1', message: %2")
-        .arg(QString::fromStdString(p->server_url()), QString::fromStdString(p->message()))
+        .arg(QString::fromStdString(a.url), QString::fromStdString(a.message))
         , Log::CRITICAL);
 }
 
-void Session::handleListenSucceededAlert(const lt::listen_succeeded_alert *p)
+void Session::handleListenSucceededAlert(const AlertData &a)
 {
     QString proto = "INVALID";
 #if (LIBTORRENT_VERSION_NUM < 10200)
-    switch (p->sock_type)
+    switch (a.socketType)
     {
     case lt::listen_succeeded_alert::udp:
         proto = "UDP";
@@ -4188,7 +4881,7 @@ void Session::handleListenSucceededAlert(const lt::listen_succeeded_alert *p)
         break;
     }
 #else
-    switch (p->socket_type)
+    switch (static_cast<lt::socket_type_t>(a.socketType))
     {
     case lt::socket_type_t::udp:
         proto = "UDP";
@@ -4214,22 +4907,18 @@ void Session::handleListenSucceededAlert(const lt::listen_succeeded_alert *p)
     boost::system::error_code ec;
     LogMsg(tr("qBittorrent is successfully listening on interface %1 port: %2/%3"
               , "e.g: qBittorrent is successfully listening on interface 192.168.0.1 port: TCP/6881")
-#if (LIBTORRENT_VERSION_NUM < 10200)
-            .arg(p->endpoint.address().to_string(ec).c_str(), proto, QString::number(p->endpoint.port())), Log::INFO);
-#else
-            .arg(p->address.to_string(ec).c_str(), proto, QString::number(p->port)), Log::INFO);
-#endif
+            .arg(a.address.to_string(ec).c_str(), proto, QString::number(a.port)), Log::INFO);
 
     // Force reannounce on all torrents because some trackers blacklist some ports
     for (const lt::torrent_handle &torrent : m_nativeSession->get_torrents())
         torrent.force_reannounce();
 }
 
-void Session::handleListenFailedAlert(const lt::listen_failed_alert *p)
+void Session::handleListenFailedAlert(const AlertData &a)
 {
     QString proto = "INVALID";
 #if (LIBTORRENT_VERSION_NUM < 10200)
-    switch (p->sock_type)
+    switch (a.socketType)
     {
     case lt::listen_failed_alert::udp:
         proto = "UDP";
@@ -4251,7 +4940,7 @@ void Session::handleListenFailedAlert(const lt::listen_failed_alert *p)
         break;
     }
 #else
-    switch (p->socket_type)
+    switch (static_cast<lt::socket_type_t>(a.socketType))
     {
     case lt::socket_type_t::udp:
         proto = "UDP";
@@ -4277,31 +4966,22 @@ void Session::handleListenFailedAlert(const lt::listen_failed_alert *p)
     boost::system::error_code ec;
     LogMsg(tr("qBittorrent failed listening on interface %1 port: %2/%3. Reason: %4."
               , "e.g: qBittorrent failed listening on interface 192.168.0.1 port: TCP/6881. Reason: already in use.")
-#if (LIBTORRENT_VERSION_NUM < 10200)
-        .arg(p->endpoint.address().to_string(ec).c_str(), proto, QString::number(p->endpoint.port())
-            , QString::fromLocal8Bit(p->error.message().c_str())), Log::CRITICAL);
-#else
-        .arg(p->address.to_string(ec).c_str(), proto, QString::number(p->port)
-            , QString::fromLocal8Bit(p->error.message().c_str())), Log::CRITICAL);
-#endif
+        .arg(a.address.to_string(ec).c_str(), proto, QString::number(a.port)
+            , QString::fromLocal8Bit(a.error.message().c_str())), Log::CRITICAL);
 }
 
-void Session::handleExternalIPAlert(const lt::external_ip_alert *p)
+void Session::handleExternalIPAlert(const AlertData &a)
 {
     boost::system::error_code ec;
-    LogMsg(tr("External IP: %1", "e.g. External IP: 192.168.0.1").arg(p->external_address.to_string(ec).c_str()), Log::INFO);
+    LogMsg(tr("External IP: %1", "e.g. External IP: 192.168.0.1").arg(a.address.to_string(ec).c_str()), Log::INFO);
 }
 
-void Session::handleSessionStatsAlert(const lt::session_stats_alert *p)
+void Session::handleSessionStatsAlert(const AlertData &a)
 {
-    const qreal interval = lt::total_milliseconds(p->timestamp() - m_statsLastTimestamp) / 1000.;
-    m_statsLastTimestamp = p->timestamp();
+    const qreal interval = lt::total_milliseconds(a.timestamp - m_statsLastTimestamp) / 1000.;
+    m_statsLastTimestamp = a.timestamp;
 
-#if (LIBTORRENT_VERSION_NUM < 10200)
-    const auto &stats = p->values;
-#else
-    const auto stats = p->counters();
-#endif
+    const std::vector<std::int64_t> &stats = a.counters;
 
     m_status.hasIncomingConnections = static_cast<bool>(stats[m_metricIndices.net.hasIncomingConnections]);
 
@@ -4361,41 +5041,50 @@ void Session::handleSessionStatsAlert(const lt::session_stats_alert *p)
     m_cacheStatus.averageJobTime = (totalJobs > 0)
                                    ? (stats[m_metricIndices.disk.diskJobTime] / totalJobs) : 0;
 
+    for (int i = 0; i < m_metrics.size(); ++i) {
+        SessionMetric &metric = m_metrics[i];
+        const qint64 value = stats[m_metricValueIndices[i]];
+        // Counters may be reset by libtorrent, don't report negative rates then
+        if (!metric.isGauge && m_hasMetricValues && (interval > 0) && (value >= metric.value))
+            metric.rate = (value - metric.value) / interval;
+        else
+            metric.rate = 0;
+        metric.value = value;
+    }
+    m_hasMetricValues = true;
+
     emit statsUpdated();
 }
 
-void Session::handleStateUpdateAlert(const lt::state_update_alert *p)
+void Session::handleStateUpdate(const std::vector<lt::torrent_status> &statuses)
 {
-    for (const lt::torrent_status &status : p->status) {
+    QVector<TorrentHandle *> updatedTorrents;
+    updatedTorrents.reserve(static_cast<int>(statuses.size()));
+
+    for (const lt::torrent_status &status : statuses) {
         TorrentHandle *const torrent = m_torrents.value(status.info_hash);
 
         if (!torrent)
             continue;
 
         torrent->handleStateUpdate(status);
+        updatedTorrents.push_back(torrent);
     }
 
-    m_torrentStatusReport = TorrentStatusReport();
-    for (const TorrentHandle *torrent : asConst(m_torrents)) {
-        if (torrent->isDownloading())
-            ++m_torrentStatusReport.nbDownloading;
-        if (torrent->isUploading())
-            ++m_torrentStatusReport.nbSeeding;
-        if (torrent->isCompleted())
-            ++m_torrentStatusReport.nbCompleted;
-        if (torrent->isPaused())
-            ++m_torrentStatusReport.nbPaused;
-        if (torrent->isResumed())
-            ++m_torrentStatusReport.nbResumed;
-        if (torrent->isActive())
-            ++m_torrentStatusReport.nbActive;
-        if (torrent->isInactive())
-            ++m_torrentStatusReport.nbInactive;
-        if (torrent->isErrored())
-            ++m_torrentStatusReport.nbErrored;
-    }
+    applyBandwidthClasses();
+
+    for (const TorrentHandle *torrent : asConst(updatedTorrents))
+        updateTorrentStatusReport(torrent);
+
+    emit torrentsUpdated(updatedTorrents);
 
-    emit torrentsUpdated();
+    // Only the torrents whose status has changed (e.g. they have uploaded something)
+    // can reach their limits here, the others are handled by seeding time deadlines
+    for (TorrentHandle *const torrent : asConst(updatedTorrents)) {
+        if (!applyShareLimits(torrent))
+            updateShareLimitDeadline(torrent);
+    }
+    updateSeedingLimitTimer();
 }
 
 namespace
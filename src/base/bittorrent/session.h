@@ -34,8 +34,12 @@
 
 #include <libtorrent/fwd.hpp>
 
+#include <QBitArray>
+#include <QElapsedTimer>
 #include <QFile>
 #include <QHash>
+#include <QHostAddress>
+#include <QMap>
 #include <QNetworkConfigurationManager>
 #include <QPointer>
 #include <QSet>
@@ -44,7 +48,9 @@
 #include "base/settingvalue.h"
 #include "base/types.h"
 #include "addtorrentparams.h"
+#include "bandwidthclass.h"
 #include "cachestatus.h"
+#include "sessionmetric.h"
 #include "sessionstatus.h"
 #include "torrentinfo.h"
 
@@ -54,10 +60,14 @@ class QString;
 class QStringList;
 class QUrl;
 
+class AlertReader;
 class FilterParserThread;
 class BandwidthScheduler;
 class Statistics;
 class ResumeDataSavingManager;
+class TorrentDataFetcher;
+
+struct AlertData;
 
 enum MaxRatioAction
 {
@@ -83,6 +93,7 @@ namespace BitTorrent
     class Tracker;
     class MagnetUri;
     class TrackerEntry;
+    class TrackerHostIndex;
     struct CreateTorrentParams;
 
     struct TorrentStatusReport
@@ -218,6 +229,18 @@ namespace BitTorrent
         bool addTag(const QString &tag);
         bool removeTag(const QString &tag);
 
+        // Bandwidth classes
+        //
+        // Torrents of a category (or of its nearest parent category having a class
+        // if subcategories are enabled) and torrents having a tag share the limits of
+        // the corresponding class. Class priorities weight the split of the global
+        // rate limits between all the transferring torrents, unclassified ones having
+        // priority 1. Setting a default class removes it.
+        BandwidthClass categoryBandwidthClass(const QString &categoryName) const;
+        bool setCategoryBandwidthClass(const QString &categoryName, const BandwidthClass &bandwidthClass);
+        BandwidthClass tagBandwidthClass(const QString &tag) const;
+        bool setTagBandwidthClass(const QString &tag, const BandwidthClass &bandwidthClass);
+
         // Torrent Management Mode subsystem (TMM)
         //
         // Each torrent can be either in Manual mode or in Automatic mode
@@ -390,16 +413,24 @@ namespace BitTorrent
         void setTrackerFilteringEnabled(bool enabled);
         QStringList bannedIPs() const;
         void setBannedIPs(const QStringList &newList);
+        bool isPeerAutoBanEnabled() const;
+        void setPeerAutoBanEnabled(bool enabled);
+        int peerAutoBanThreshold() const;
+        void setPeerAutoBanThreshold(int threshold);
 
         void startUpTorrents();
         TorrentHandle *findTorrent(const InfoHash &hash) const;
         QHash<InfoHash, TorrentHandle *> torrents() const;
         TorrentStatusReport torrentStatusReport() const;
+        const TrackerHostIndex *trackerHostIndex() const;
         bool hasActiveTorrents() const;
         bool hasUnfinishedTorrents() const;
         bool hasRunningSeed() const;
         const SessionStatus &status() const;
         const CacheStatus &cacheStatus() const;
+        // All values of the latest session_stats_alert
+        const QVector<SessionMetric> &metrics() const;
+        AlertStatistics alertStatistics() const;
         quint64 getAlltimeDL() const;
         quint64 getAlltimeUL() const;
         bool isListening() const;
@@ -408,11 +439,13 @@ namespace BitTorrent
         void setMaxRatioAction(MaxRatioAction act);
 
         void banIP(const QString &ip);
+        void banIPs(const QStringList &ips);
 
         bool isKnownTorrent(const InfoHash &hash) const;
         bool addTorrent(const QString &source, const AddTorrentParams &params = AddTorrentParams());
         bool addTorrent(const TorrentInfo &torrentInfo, const AddTorrentParams &params = AddTorrentParams());
         bool deleteTorrent(const QString &hash, bool deleteLocalFiles = false);
+        int deleteTorrents(const QStringList &hashes, bool deleteLocalFiles = false);
         bool loadMetadata(const MagnetUri &magnetUri);
         bool cancelLoadMetadata(const InfoHash &hash);
 
@@ -446,14 +479,18 @@ namespace BitTorrent
         void handleTorrentTrackerReply(TorrentHandle *const torrent, const QString &trackerUrl);
         void handleTorrentTrackerWarning(TorrentHandle *const torrent, const QString &trackerUrl);
         void handleTorrentTrackerError(TorrentHandle *const torrent, const QString &trackerUrl);
+        void fetchTorrentFilesProgress(const TorrentHandle *torrent);
+        void fetchTorrentPieceAvailability(const TorrentHandle *torrent);
+        void fetchTorrentDownloadingPieces(const TorrentHandle *torrent);
 
     signals:
         void statsUpdated();
-        void torrentsUpdated();
+        void torrentsUpdated(const QVector<BitTorrent::TorrentHandle *> &torrents);
         void addTorrentFailed(const QString &error);
         void torrentAdded(BitTorrent::TorrentHandle *const torrent);
         void torrentNew(BitTorrent::TorrentHandle *const torrent);
         void torrentAboutToBeRemoved(BitTorrent::TorrentHandle *const torrent);
+        void torrentsAboutToBeRemoved(const QVector<BitTorrent::TorrentHandle *> &torrents);
         void torrentPaused(BitTorrent::TorrentHandle *const torrent);
         void torrentResumed(BitTorrent::TorrentHandle *const torrent);
         void torrentFinished(BitTorrent::TorrentHandle *const torrent);
@@ -474,10 +511,15 @@ namespace BitTorrent
         void recursiveTorrentDownloadPossible(BitTorrent::TorrentHandle *const torrent);
         void speedLimitModeChanged(bool alternative);
         void IPFilterParsed(bool error, int ruleCount);
+        // emitted once the bans are applied to the session IP filter
+        void IPsBanned(const QStringList &ips);
         void trackersAdded(BitTorrent::TorrentHandle *const torrent, const QVector<BitTorrent::TrackerEntry> &trackers);
         void trackersRemoved(BitTorrent::TorrentHandle *const torrent, const QVector<BitTorrent::TrackerEntry> &trackers);
         void trackersChanged(BitTorrent::TorrentHandle *const torrent);
         void trackerlessStateChanged(BitTorrent::TorrentHandle *const torrent, bool trackerless);
+        void torrentFilesProgressFetched(BitTorrent::TorrentHandle *const torrent, const QVector<qreal> &filesProgress);
+        void torrentPieceAvailabilityFetched(BitTorrent::TorrentHandle *const torrent, const QVector<int> &pieceAvailability);
+        void torrentDownloadingPiecesFetched(BitTorrent::TorrentHandle *const torrent, const QBitArray &downloadingPieces);
         void downloadFromUrlFailed(const QString &url, const QString &reason);
         void downloadFromUrlFinished(const QString &url);
         void categoryAdded(const QString &categoryName);
@@ -494,7 +536,12 @@ namespace BitTorrent
         void generateResumeData(bool final = false);
         void handleIPFilterParsed(int ruleCount);
         void handleIPFilterError();
+        void applyPendingBans();
         void handleDownloadFinished(const Net::DownloadResult &result);
+        void handleFilesProgressFetched(const QString &hash, const QVector<qreal> &filesProgress);
+        void handlePieceAvailabilityFetched(const QString &hash, const QVector<int> &pieceAvailability);
+        void handleDownloadingPiecesFetched(const QString &hash, const QBitArray &downloadingPieces);
+        void handleEmbeddedTorrentFound(const QString &hash);
 
         // Session reconfiguration triggers
         void networkOnlineStateChanged(bool online);
@@ -511,15 +558,13 @@ namespace BitTorrent
         explicit Session(QObject *parent = nullptr);
         ~Session();
 
-        bool hasPerTorrentRatioLimit() const;
-        bool hasPerTorrentSeedingTimeLimit() const;
-
         void initResumeFolder();
 
         // Session configuration
         Q_INVOKABLE void configure();
         void configure(lt::settings_pack &settingsPack);
         void configurePeerClasses();
+        void applyBandwidthClasses();
         void adjustLimits(lt::settings_pack &settingsPack);
         void applyBandwidthLimits(lt::settings_pack &settingsPack) const;
         void initMetrics();
@@ -539,28 +584,34 @@ namespace BitTorrent
                              const QByteArray &fastresumeData = {});
         bool findIncompleteFiles(TorrentInfo &torrentInfo, QString &savePath) const;
 
+        bool applyShareLimits(TorrentHandle *const torrent);
+        void updateShareLimitDeadline(TorrentHandle *const torrent);
+        void removeShareLimitDeadline(const InfoHash &hash);
+        void updateShareLimits();
         void updateSeedingLimitTimer();
+        void updateTorrentStatusReport(const TorrentHandle *torrent);
+        void removeFromTorrentStatusReport(const InfoHash &hash);
         void exportTorrentFile(TorrentHandle *const torrent, TorrentExportFolder folder = TorrentExportFolder::Regular);
 
-        void handleAlert(const lt::alert *a);
-        void dispatchTorrentAlert(const lt::alert *a);
-        void handleAddTorrentAlert(const lt::add_torrent_alert *p);
-        void handleStateUpdateAlert(const lt::state_update_alert *p);
-        void handleMetadataReceivedAlert(const lt::metadata_received_alert *p);
-        void handleTorrentPausedAlert(const lt::torrent_paused_alert *p);
-        void handleFileErrorAlert(const lt::file_error_alert *p);
-        void handleTorrentRemovedAlert(const lt::torrent_removed_alert *p);
-        void handleTorrentDeletedAlert(const lt::torrent_deleted_alert *p);
-        void handleTorrentDeleteFailedAlert(const lt::torrent_delete_failed_alert *p);
-        void handlePortmapWarningAlert(const lt::portmap_error_alert *p);
-        void handlePortmapAlert(const lt::portmap_alert *p);
-        void handlePeerBlockedAlert(const lt::peer_blocked_alert *p);
-        void handlePeerBanAlert(const lt::peer_ban_alert *p);
-        void handleUrlSeedAlert(const lt::url_seed_alert *p);
-        void handleListenSucceededAlert(const lt::listen_succeeded_alert *p);
-        void handleListenFailedAlert(const lt::listen_failed_alert *p);
-        void handleExternalIPAlert(const lt::external_ip_alert *p);
-        void handleSessionStatsAlert(const lt::session_stats_alert *p);
+        void handleAlert(const AlertData &a);
+        void dispatchTorrentAlert(const AlertData &a);
+        void handleAddTorrentAlert(const AlertData &a);
+        void handleStateUpdate(const std::vector<lt::torrent_status> &statuses);
+        void handleMetadataReceivedAlert(const AlertData &a);
+        void handleTorrentPausedAlert(const AlertData &a);
+        void handleFileErrorAlert(const AlertData &a);
+        void handleTorrentRemovedAlert(const AlertData &a);
+        void handleTorrentDeletedAlert(const AlertData &a);
+        void handleTorrentDeleteFailedAlert(const AlertData &a);
+        void handlePortmapWarningAlert(const AlertData &a);
+        void handlePortmapAlert(const AlertData &a);
+        void handlePeerBlockedAlert(const AlertData &a);
+        void handlePeerBanAlert(const AlertData &a);
+        void handleUrlSeedAlert(const AlertData &a);
+        void handleListenSucceededAlert(const AlertData &a);
+        void handleListenFailedAlert(const AlertData &a);
+        void handleExternalIPAlert(const AlertData &a);
+        void handleSessionStatsAlert(const AlertData &a);
 
         void createTorrentHandle(const lt::torrent_handle &nativeHandle);
 
@@ -576,6 +627,7 @@ namespace BitTorrent
         bool m_deferredConfigureScheduled;
         bool m_IPFilteringChanged;
         bool m_listenInterfaceChanged; // optimization
+        bool m_pendingBansScheduled;
 
         CachedSettingValue<bool> m_isDHTEnabled;
         CachedSettingValue<bool> m_isLSDEnabled;
@@ -650,6 +702,8 @@ namespace BitTorrent
         CachedSettingValue<SeedChokingAlgorithm> m_seedChokingAlgorithm;
         CachedSettingValue<QVariantMap> m_storedCategories;
         CachedSettingValue<QStringList> m_storedTags;
+        CachedSettingValue<QVariantMap> m_storedCategoryBandwidthClasses;
+        CachedSettingValue<QVariantMap> m_storedTagBandwidthClasses;
         CachedSettingValue<int> m_maxRatioAction;
         CachedSettingValue<QString> m_defaultSavePath;
         CachedSettingValue<QString> m_tempPath;
@@ -661,6 +715,8 @@ namespace BitTorrent
         CachedSettingValue<bool> m_isDisableAutoTMMWhenCategorySavePathChanged;
         CachedSettingValue<bool> m_isTrackerEnabled;
         CachedSettingValue<QStringList> m_bannedIPs;
+        CachedSettingValue<bool> m_isPeerAutoBanEnabled;
+        CachedSettingValue<int> m_peerAutoBanThreshold;
 
         // Order is important. This needs to be declared after its CachedSettingsValue
         // counterpart, because it uses it for initialization in the constructor
@@ -675,16 +731,32 @@ namespace BitTorrent
 
         QTimer *m_refreshTimer;
         QTimer *m_seedingLimitTimer;
+        // Predicted moments (on m_shareLimitClock, in ms) when seeding torrents reach their seeding time limit
+        QElapsedTimer m_shareLimitClock;
+        QMultiMap<qint64, InfoHash> m_seedingTimeDeadlines;
+        QHash<InfoHash, qint64> m_seedingTimeDeadlineIndex;
         QTimer *m_resumeDataTimer;
         Statistics *m_statistics;
+        TrackerHostIndex *m_trackerHostIndex;
         // IP filtering
         QPointer<FilterParserThread> m_filterParser;
+        QSet<QHostAddress> m_bannedAddresses;
+        QVector<QHostAddress> m_pendingBans; // not yet applied to the session IP filter
+        struct PeerBanCount
+        {
+            int count = 0;
+            qint64 lastBanTime = 0;
+        };
+        QHash<QHostAddress, PeerBanCount> m_peerBanCounts; // libtorrent bans due to corrupt data
         QPointer<BandwidthScheduler> m_bwScheduler;
         // Tracker
         QPointer<Tracker> m_tracker;
         // fastresume data writing thread
+        AlertReader *m_alertReader;
         QThread *m_ioThread;
         ResumeDataSavingManager *m_resumeDataSavingManager;
+        QThread *m_dataFetchThread;
+        TorrentDataFetcher *m_dataFetcher;
 
         QHash<InfoHash, TorrentInfo> m_loadedMetadata;
         QHash<InfoHash, TorrentHandle *> m_torrents;
@@ -692,14 +764,21 @@ namespace BitTorrent
         QHash<QString, AddTorrentParams> m_downloadedTorrents;
         QHash<InfoHash, RemovingTorrentData> m_removingTorrents;
         TorrentStatusReport m_torrentStatusReport;
+        QHash<InfoHash, uint> m_torrentStatusFlags; // what each torrent is counted as in m_torrentStatusReport
         QStringMap m_categories;
         QSet<QString> m_tags;
+        QHash<QString, BandwidthClass> m_categoryBandwidthClasses;
+        QHash<QString, BandwidthClass> m_tagBandwidthClasses;
+        bool m_hasBandwidthClassLimits = false;
 
         // I/O errored torrents
         QSet<InfoHash> m_recentErroredTorrents;
         QTimer *m_recentErroredTorrentsTimer;
 
         SessionMetricIndices m_metricIndices;
+        QVector<SessionMetric> m_metrics;
+        QVector<int> m_metricValueIndices; // positions of m_metrics values in session_stats_alert
+        bool m_hasMetricValues = false;
         lt::time_point m_statsLastTimestamp = lt::clock_type::now();
 
         SessionStatus m_status;
@@ -0,0 +1,64 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2019  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+
+#ifndef BITTORRENT_SESSIONMETRIC_H
+#define BITTORRENT_SESSIONMETRIC_H
+
+#include <QString>
+
+namespace BitTorrent
+{
+    // A single value reported by libtorrent in session_stats_alert
+    struct SessionMetric
+    {
+        // libtorrent name, e.g. "net.sent_payload_bytes"
+        QString name;
+        // Gauges are current values (queue sizes, connected peers etc.),
+        // others are counters that only grow
+        bool isGauge = false;
+        qint64 value = 0;
+        // Per second change of a counter since the previous stats update
+        qreal rate = 0;
+    };
+
+    // Counters of the alert reading pipeline
+    struct AlertStatistics
+    {
+        qint64 receivedAlerts = 0;
+        // Left out of batches since newer alerts of the same kind superseded them
+        qint64 coalescedAlerts = 0;
+        qint64 batches = 0;
+        // How many times libtorrent reported that its alert queue overflowed
+        // and how many alert types were dropped then
+        qint64 queueOverflows = 0;
+        qint64 droppedAlertTypes = 0;
+    };
+}
+
+#endif // BITTORRENT_SESSIONMETRIC_H
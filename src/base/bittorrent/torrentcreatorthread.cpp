@@ -111,7 +111,7 @@ void TorrentCreatorThread::run()
                 dirIter.next();
                 dirs += dirIter.filePath();
             }
-            std::sort(dirs.begin(), dirs.end(), Utils::String::naturalLessThan<Qt::CaseInsensitive>);
+            Utils::String::naturalSort(dirs, Qt::CaseInsensitive);
 
             QStringList fileNames;
             QHash<QString, qint64> fileSizeMap;
@@ -128,7 +128,7 @@ void TorrentCreatorThread::run()
                     fileSizeMap[relFilePath] = fileIter.fileInfo().size();
                 }
 
-                std::sort(tmpNames.begin(), tmpNames.end(), Utils::String::naturalLessThan<Qt::CaseInsensitive>);
+                Utils::String::naturalSort(tmpNames, Qt::CaseInsensitive);
                 fileNames += tmpNames;
             }
 
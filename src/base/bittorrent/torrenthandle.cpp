@@ -45,10 +45,6 @@
 #include <libtorrent/time.hpp>
 #include <libtorrent/version.hpp>
 
-#if (LIBTORRENT_VERSION_NUM >= 10200)
-#include <libtorrent/write_resume_data.hpp>
-#endif
-
 #include <QBitArray>
 #include <QDateTime>
 #include <QDebug>
@@ -62,11 +58,13 @@
 #include "base/preferences.h"
 #include "base/profile.h"
 #include "base/tristatebool.h"
+#include "base/utils/bitarray.h"
 #include "base/utils/fs.h"
 #include "base/utils/string.h"
 #include "downloadpriority.h"
 #include "peeraddress.h"
 #include "peerinfo.h"
+#include "private/alertreader.h"
 #include "private/ltunderlyingtype.h"
 #include "session.h"
 #include "trackerentry.h"
@@ -122,6 +120,16 @@ namespace
             entryList.emplace_back(setValue.toStdString());
         return entryList;
     }
+
+    // Combines own torrent limit with the one assigned by its bandwidth classes
+    int effectiveRateLimit(const int limit, const int classLimit)
+    {
+        if (classLimit <= 0)
+            return limit;
+        if (limit <= 0)
+            return classLimit;
+        return std::min(limit, classLimit);
+    }
 }
 
 // AddTorrentData
@@ -215,6 +223,8 @@ TorrentHandle::TorrentHandle(Session *session, const lt::torrent_handle &nativeH
 
     updateStatus();
     m_hash = InfoHash(m_nativeStatus.info_hash);
+    m_uploadLimit = m_nativeHandle.upload_limit();
+    m_downloadLimit = m_nativeHandle.download_limit();
 
     // NB: the following two if statements are present because we don't want
     // to set either sequential download or first/last piece priority to false
@@ -1157,12 +1167,12 @@ qlonglong TorrentHandle::timeSinceActivity() const
 
 int TorrentHandle::downloadLimit() const
 {
-    return m_nativeHandle.download_limit();
+    return m_downloadLimit;
 }
 
 int TorrentHandle::uploadLimit() const
 {
-    return m_nativeHandle.upload_limit();
+    return m_uploadLimit;
 }
 
 bool TorrentHandle::superSeeding() const
@@ -1188,12 +1198,13 @@ QVector<PeerInfo> TorrentHandle::peers() const
 
 QBitArray TorrentHandle::pieces() const
 {
-    QBitArray result(m_nativeStatus.pieces.size());
-
-    for (int i = 0; i < m_nativeStatus.pieces.size(); ++i)
-        result.setBit(i, m_nativeStatus.pieces.get_bit(LTPieceIndex {i}));
+    const int size = m_nativeStatus.pieces.size();
+    if (m_nativeStatus.pieces.all_set())
+        return QBitArray(size, true);
+    if (m_nativeStatus.pieces.none_set())
+        return QBitArray(size);
 
-    return result;
+    return Utils::BitArray::fromMsbFirst(m_nativeStatus.pieces.data(), size);
 }
 
 QBitArray TorrentHandle::downloadingPieces() const
@@ -1221,6 +1232,26 @@ QVector<int> TorrentHandle::pieceAvailability() const
     return QVector<int>::fromStdVector(avail);
 }
 
+void TorrentHandle::fetchFilesProgress() const
+{
+    m_session->fetchTorrentFilesProgress(this);
+}
+
+void TorrentHandle::fetchPieceAvailability() const
+{
+    m_session->fetchTorrentPieceAvailability(this);
+}
+
+void TorrentHandle::fetchDownloadingPieces() const
+{
+    m_session->fetchTorrentDownloadingPieces(this);
+}
+
+quint64 TorrentHandle::statusStamp() const
+{
+    return m_statusStamp;
+}
+
 qreal TorrentHandle::distributedCopies() const
 {
     return m_nativeStatus.distributed_copies;
@@ -1558,14 +1589,14 @@ void TorrentHandle::handleStateUpdate(const lt::torrent_status &nativeStatus)
     updateStatus(nativeStatus);
 }
 
-void TorrentHandle::handleStorageMovedAlert(const lt::storage_moved_alert *p)
+void TorrentHandle::handleStorageMovedAlert(const AlertData &a)
 {
     if (!isMoveInProgress()) {
         qWarning() << "Unexpected " << Q_FUNC_INFO << " call.";
         return;
     }
 
-    const QString newPath(p->storage_path());
+    const QString newPath(QString::fromStdString(a.path));
     if (newPath != m_moveStorageInfo.newPath) {
         qWarning() << Q_FUNC_INFO << ": New path doesn't match a path in a queue.";
         return;
@@ -1599,7 +1630,7 @@ void TorrentHandle::handleStorageMovedAlert(const lt::storage_moved_alert *p)
         m_moveFinishedTriggers.takeFirst()();
 }
 
-void TorrentHandle::handleStorageMovedFailedAlert(const lt::storage_moved_failed_alert *p)
+void TorrentHandle::handleStorageMovedFailedAlert(const AlertData &a)
 {
     if (!isMoveInProgress()) {
         qWarning() << "Unexpected " << Q_FUNC_INFO << " call.";
@@ -1607,7 +1638,7 @@ void TorrentHandle::handleStorageMovedFailedAlert(const lt::storage_moved_failed
     }
 
     LogMsg(tr("Could not move torrent: '%1'. Reason: %2")
-        .arg(name(), QString::fromStdString(p->message())), Log::CRITICAL);
+        .arg(name(), QString::fromStdString(a.message)), Log::CRITICAL);
 
     m_moveStorageInfo.newPath.clear();
     updateStatus();
@@ -1621,20 +1652,20 @@ void TorrentHandle::handleStorageMovedFailedAlert(const lt::storage_moved_failed
         m_moveFinishedTriggers.takeFirst()();
 }
 
-void TorrentHandle::handleTrackerReplyAlert(const lt::tracker_reply_alert *p)
+void TorrentHandle::handleTrackerReplyAlert(const AlertData &a)
 {
-    const QString trackerUrl(p->tracker_url());
-    qDebug("Received a tracker reply from %s (Num_peers = %d)", qUtf8Printable(trackerUrl), p->num_peers);
+    const QString trackerUrl = QString::fromStdString(a.url);
+    qDebug("Received a tracker reply from %s (Num_peers = %d)", qUtf8Printable(trackerUrl), a.numPeers);
     // Connection was successful now. Remove possible old errors
-    m_trackerInfos[trackerUrl] = {{}, p->num_peers};
+    m_trackerInfos[trackerUrl] = {{}, a.numPeers};
 
     m_session->handleTorrentTrackerReply(this, trackerUrl);
 }
 
-void TorrentHandle::handleTrackerWarningAlert(const lt::tracker_warning_alert *p)
+void TorrentHandle::handleTrackerWarningAlert(const AlertData &a)
 {
-    const QString trackerUrl = p->tracker_url();
-    const QString message = p->warning_message();
+    const QString trackerUrl = QString::fromStdString(a.url);
+    const QString message = QString::fromStdString(a.trackerMessage);
 
     // Connection was successful now but there is a warning message
     m_trackerInfos[trackerUrl].lastMessage = message; // Store warning message
@@ -1642,19 +1673,19 @@ void TorrentHandle::handleTrackerWarningAlert(const lt::tracker_warning_alert *p
     m_session->handleTorrentTrackerWarning(this, trackerUrl);
 }
 
-void TorrentHandle::handleTrackerErrorAlert(const lt::tracker_error_alert *p)
+void TorrentHandle::handleTrackerErrorAlert(const AlertData &a)
 {
-    const QString trackerUrl = p->tracker_url();
-    const QString message = p->error_message();
+    const QString trackerUrl = QString::fromStdString(a.url);
+    const QString message = QString::fromStdString(a.trackerMessage);
 
     m_trackerInfos[trackerUrl].lastMessage = message;
 
     m_session->handleTorrentTrackerError(this, trackerUrl);
 }
 
-void TorrentHandle::handleTorrentCheckedAlert(const lt::torrent_checked_alert *p)
+void TorrentHandle::handleTorrentCheckedAlert(const AlertData &a)
 {
-    Q_UNUSED(p);
+    Q_UNUSED(a);
     qDebug("\"%s\" have just finished checking", qUtf8Printable(name()));
 
     if (m_startupState == Preparing) {
@@ -1693,9 +1724,9 @@ void TorrentHandle::handleTorrentCheckedAlert(const lt::torrent_checked_alert *p
     m_session->handleTorrentChecked(this);
 }
 
-void TorrentHandle::handleTorrentFinishedAlert(const lt::torrent_finished_alert *p)
+void TorrentHandle::handleTorrentFinishedAlert(const AlertData &a)
 {
-    Q_UNUSED(p);
+    Q_UNUSED(a);
     qDebug("Got a torrent finished alert for \"%s\"", qUtf8Printable(name()));
     qDebug("Torrent has seed status: %s", m_hasSeedStatus ? "yes" : "no");
     m_hasMissingFiles = false;
@@ -1720,9 +1751,9 @@ void TorrentHandle::handleTorrentFinishedAlert(const lt::torrent_finished_alert
     }
 }
 
-void TorrentHandle::handleTorrentPausedAlert(const lt::torrent_paused_alert *p)
+void TorrentHandle::handleTorrentPausedAlert(const AlertData &a)
 {
-    Q_UNUSED(p);
+    Q_UNUSED(a);
 
     if (m_startupState == Started) {
         if (!m_pauseWhenReady) {
@@ -1736,9 +1767,9 @@ void TorrentHandle::handleTorrentPausedAlert(const lt::torrent_paused_alert *p)
     }
 }
 
-void TorrentHandle::handleTorrentResumedAlert(const lt::torrent_resumed_alert *p)
+void TorrentHandle::handleTorrentResumedAlert(const AlertData &a)
 {
-    Q_UNUSED(p);
+    Q_UNUSED(a);
 
     if (m_startupState == Started)
         m_session->handleTorrentResumed(this);
@@ -1746,18 +1777,13 @@ void TorrentHandle::handleTorrentResumedAlert(const lt::torrent_resumed_alert *p
         m_startupState = Started;
 }
 
-void TorrentHandle::handleSaveResumeDataAlert(const lt::save_resume_data_alert *p)
+void TorrentHandle::handleSaveResumeDataAlert(const AlertData &a)
 {
-#if (LIBTORRENT_VERSION_NUM < 10200)
-    const bool useDummyResumeData = !(p && p->resume_data);
+    // resume data is converted to lt::entry by the alert reader
+    const bool useDummyResumeData = !a.resumeData;
     lt::entry dummyEntry;
 
-    lt::entry &resumeData = useDummyResumeData ? dummyEntry : *(p->resume_data);
-#else
-    const bool useDummyResumeData = !p;
-
-    lt::entry resumeData = useDummyResumeData ? lt::entry() : lt::write_resume_data(p->params);
-#endif
+    lt::entry &resumeData = useDummyResumeData ? dummyEntry : *a.resumeData;
 
     if (useDummyResumeData) {
         resumeData["qBt-magnetUri"] = toMagnetUri().toStdString();
@@ -1783,6 +1809,9 @@ void TorrentHandle::handleSaveResumeDataAlert(const lt::save_resume_data_alert *
     resumeData["qBt-tempPathDisabled"] = m_tempPathDisabled;
     resumeData["qBt-queuePosition"] = (static_cast<int>(nativeHandle().queue_position()) + 1); // qBt starts queue at 1
     resumeData["qBt-hasRootFolder"] = m_hasRootFolder;
+    // Native limits can be lowered by bandwidth classes so store own ones
+    resumeData["upload_rate_limit"] = m_uploadLimit;
+    resumeData["download_rate_limit"] = m_downloadLimit;
 
     if (m_pauseWhenReady) {
         // We need to redefine these values when torrent starting/rechecking
@@ -1795,36 +1824,37 @@ void TorrentHandle::handleSaveResumeDataAlert(const lt::save_resume_data_alert *
     m_session->handleTorrentResumeDataReady(this, resumeData);
 }
 
-void TorrentHandle::handleSaveResumeDataFailedAlert(const lt::save_resume_data_failed_alert *p)
+void TorrentHandle::handleSaveResumeDataFailedAlert(const AlertData &a)
 {
     // if torrent has no metadata we should save dummy fastresume data
     // containing Magnet URI and qBittorrent own resume data only
-    if (p->error.value() == lt::errors::no_metadata) {
-        handleSaveResumeDataAlert(nullptr);
+    if (a.error.value() == lt::errors::no_metadata) {
+        // the failed alert carries no resume data, so the dummy one is saved
+        handleSaveResumeDataAlert(a);
     }
     else {
         LogMsg(tr("Save resume data failed. Torrent: \"%1\", error: \"%2\"")
-            .arg(name(), QString::fromLocal8Bit(p->error.message().c_str())), Log::CRITICAL);
+            .arg(name(), QString::fromLocal8Bit(a.error.message().c_str())), Log::CRITICAL);
         m_session->handleTorrentResumeDataFailed(this);
     }
 }
 
-void TorrentHandle::handleFastResumeRejectedAlert(const lt::fastresume_rejected_alert *p)
+void TorrentHandle::handleFastResumeRejectedAlert(const AlertData &a)
 {
     m_fastresumeDataRejected = true;
 
-    if (p->error.value() == lt::errors::mismatching_file_size) {
+    if (a.error.value() == lt::errors::mismatching_file_size) {
         // Mismatching file size (files were probably moved)
         m_hasMissingFiles = true;
         LogMsg(tr("File sizes mismatch for torrent '%1', pausing it.").arg(name()), Log::CRITICAL);
     }
     else {
         LogMsg(tr("Fast resume data was rejected for torrent '%1'. Reason: %2. Checking again...")
-            .arg(name(), QString::fromStdString(p->message())), Log::WARNING);
+            .arg(name(), QString::fromStdString(a.message)), Log::WARNING);
     }
 }
 
-void TorrentHandle::handleFileRenamedAlert(const lt::file_renamed_alert *p)
+void TorrentHandle::handleFileRenamedAlert(const AlertData &a)
 {
     // We don't really need to call updateStatus() in this place.
     // All we need to do is make sure we have a valid instance of the TorrentInfo object.
@@ -1833,11 +1863,12 @@ void TorrentHandle::handleFileRenamedAlert(const lt::file_renamed_alert *p)
     // remove empty leftover folders
     // for example renaming "a/b/c" to "d/b/c", then folders "a/b" and "a" will
     // be removed if they are empty
-    const QString oldFilePath = m_oldPath[p->index].takeFirst();
-    const QString newFilePath = Utils::Fs::toUniformPath(p->new_name());
+    const LTFileIndex index {a.fileIndex};
+    const QString oldFilePath = m_oldPath[index].takeFirst();
+    const QString newFilePath = Utils::Fs::toUniformPath(QString::fromStdString(a.path));
 
-    if (m_oldPath[p->index].isEmpty())
-        m_oldPath.remove(p->index);
+    if (m_oldPath[index].isEmpty())
+        m_oldPath.remove(index);
 
     QVector<QStringRef> oldPathParts = oldFilePath.splitRef('/', QString::SkipEmptyParts);
     oldPathParts.removeLast();  // drop file name part
@@ -1870,15 +1901,16 @@ void TorrentHandle::handleFileRenamedAlert(const lt::file_renamed_alert *p)
         saveResumeData();  // otherwise the new path will not be saved
 }
 
-void TorrentHandle::handleFileRenameFailedAlert(const lt::file_rename_failed_alert *p)
+void TorrentHandle::handleFileRenameFailedAlert(const AlertData &a)
 {
     LogMsg(tr("File rename failed. Torrent: \"%1\", file: \"%2\", reason: \"%3\"")
-        .arg(name(), filePath(LTUnderlyingType<LTFileIndex> {p->index})
-             , QString::fromLocal8Bit(p->error.message().c_str())), Log::WARNING);
+        .arg(name(), filePath(a.fileIndex)
+             , QString::fromLocal8Bit(a.error.message().c_str())), Log::WARNING);
 
-    m_oldPath[p->index].removeFirst();
-    if (m_oldPath[p->index].isEmpty())
-        m_oldPath.remove(p->index);
+    const LTFileIndex index {a.fileIndex};
+    m_oldPath[index].removeFirst();
+    if (m_oldPath[index].isEmpty())
+        m_oldPath.remove(index);
 
     --m_renameCount;
     while (!isMoveInProgress() && (m_renameCount == 0) && !m_moveFinishedTriggers.isEmpty())
@@ -1888,7 +1920,7 @@ void TorrentHandle::handleFileRenameFailedAlert(const lt::file_rename_failed_ale
         saveResumeData();  // otherwise the new path will not be saved
 }
 
-void TorrentHandle::handleFileCompletedAlert(const lt::file_completed_alert *p)
+void TorrentHandle::handleFileCompletedAlert(const AlertData &a)
 {
     // We don't really need to call updateStatus() in this place.
     // All we need to do is make sure we have a valid instance of the TorrentInfo object.
@@ -1896,19 +1928,19 @@ void TorrentHandle::handleFileCompletedAlert(const lt::file_completed_alert *p)
 
     qDebug("A file completed download in torrent \"%s\"", qUtf8Printable(name()));
     if (m_session->isAppendExtensionEnabled()) {
-        QString name = filePath(LTUnderlyingType<LTFileIndex> {p->index});
+        QString name = filePath(a.fileIndex);
         if (name.endsWith(QB_EXT)) {
             const QString oldName = name;
             name.chop(QB_EXT.size());
             qDebug("Renaming %s to %s", qUtf8Printable(oldName), qUtf8Printable(name));
-            renameFile(LTUnderlyingType<LTFileIndex> {p->index}, name);
+            renameFile(a.fileIndex, name);
         }
     }
 }
 
-void TorrentHandle::handleMetadataReceivedAlert(const lt::metadata_received_alert *p)
+void TorrentHandle::handleMetadataReceivedAlert(const AlertData &a)
 {
-    Q_UNUSED(p);
+    Q_UNUSED(a);
     qDebug("Metadata received for torrent %s.", qUtf8Printable(name()));
     updateStatus();
     if (m_session->isAppendExtensionEnabled())
@@ -1934,9 +1966,9 @@ void TorrentHandle::handleMetadataReceivedAlert(const lt::metadata_received_aler
     }
 }
 
-void TorrentHandle::handlePerformanceAlert(const lt::performance_alert *p) const
+void TorrentHandle::handlePerformanceAlert(const AlertData &a) const
 {
-    LogMsg((tr("Performance alert: ") + QString::fromStdString(p->message()))
+    LogMsg((tr("Performance alert: ") + QString::fromStdString(a.message))
            , Log::INFO);
 }
 
@@ -1958,59 +1990,59 @@ void TorrentHandle::handleAppendExtensionToggled()
     manageIncompleteFiles();
 }
 
-void TorrentHandle::handleAlert(const lt::alert *a)
+void TorrentHandle::handleAlert(const AlertData &a)
 {
-    switch (a->type()) {
+    switch (a.type) {
     case lt::file_renamed_alert::alert_type:
-        handleFileRenamedAlert(static_cast<const lt::file_renamed_alert*>(a));
+        handleFileRenamedAlert(a);
         break;
     case lt::file_rename_failed_alert::alert_type:
-        handleFileRenameFailedAlert(static_cast<const lt::file_rename_failed_alert*>(a));
+        handleFileRenameFailedAlert(a);
         break;
     case lt::file_completed_alert::alert_type:
-        handleFileCompletedAlert(static_cast<const lt::file_completed_alert*>(a));
+        handleFileCompletedAlert(a);
         break;
     case lt::torrent_finished_alert::alert_type:
-        handleTorrentFinishedAlert(static_cast<const lt::torrent_finished_alert*>(a));
+        handleTorrentFinishedAlert(a);
         break;
     case lt::save_resume_data_alert::alert_type:
-        handleSaveResumeDataAlert(static_cast<const lt::save_resume_data_alert*>(a));
+        handleSaveResumeDataAlert(a);
         break;
     case lt::save_resume_data_failed_alert::alert_type:
-        handleSaveResumeDataFailedAlert(static_cast<const lt::save_resume_data_failed_alert*>(a));
+        handleSaveResumeDataFailedAlert(a);
         break;
     case lt::storage_moved_alert::alert_type:
-        handleStorageMovedAlert(static_cast<const lt::storage_moved_alert*>(a));
+        handleStorageMovedAlert(a);
         break;
     case lt::storage_moved_failed_alert::alert_type:
-        handleStorageMovedFailedAlert(static_cast<const lt::storage_moved_failed_alert*>(a));
+        handleStorageMovedFailedAlert(a);
         break;
     case lt::torrent_paused_alert::alert_type:
-        handleTorrentPausedAlert(static_cast<const lt::torrent_paused_alert*>(a));
+        handleTorrentPausedAlert(a);
         break;
     case lt::torrent_resumed_alert::alert_type:
-        handleTorrentResumedAlert(static_cast<const lt::torrent_resumed_alert*>(a));
+        handleTorrentResumedAlert(a);
         break;
     case lt::tracker_error_alert::alert_type:
-        handleTrackerErrorAlert(static_cast<const lt::tracker_error_alert*>(a));
+        handleTrackerErrorAlert(a);
         break;
     case lt::tracker_reply_alert::alert_type:
-        handleTrackerReplyAlert(static_cast<const lt::tracker_reply_alert*>(a));
+        handleTrackerReplyAlert(a);
         break;
     case lt::tracker_warning_alert::alert_type:
-        handleTrackerWarningAlert(static_cast<const lt::tracker_warning_alert*>(a));
+        handleTrackerWarningAlert(a);
         break;
     case lt::metadata_received_alert::alert_type:
-        handleMetadataReceivedAlert(static_cast<const lt::metadata_received_alert*>(a));
+        handleMetadataReceivedAlert(a);
         break;
     case lt::fastresume_rejected_alert::alert_type:
-        handleFastResumeRejectedAlert(static_cast<const lt::fastresume_rejected_alert*>(a));
+        handleFastResumeRejectedAlert(a);
         break;
     case lt::torrent_checked_alert::alert_type:
-        handleTorrentCheckedAlert(static_cast<const lt::torrent_checked_alert*>(a));
+        handleTorrentCheckedAlert(a);
         break;
     case lt::performance_alert::alert_type:
-        handlePerformanceAlert(static_cast<const lt::performance_alert*>(a));
+        handlePerformanceAlert(a);
         break;
     }
 }
@@ -2099,6 +2131,7 @@ void TorrentHandle::updateStatus()
 void TorrentHandle::updateStatus(const lt::torrent_status &nativeStatus)
 {
     m_nativeStatus = nativeStatus;
+    ++m_statusStamp;
 
     updateState();
     updateTorrentInfo();
@@ -2142,12 +2175,28 @@ void TorrentHandle::setSeedingTimeLimit(int limit)
 
 void TorrentHandle::setUploadLimit(const int limit)
 {
-    m_nativeHandle.set_upload_limit(limit);
+    m_uploadLimit = limit;
+    m_nativeHandle.set_upload_limit(effectiveRateLimit(m_uploadLimit, m_classUploadLimit));
+    ++m_statusStamp;
 }
 
 void TorrentHandle::setDownloadLimit(const int limit)
 {
-    m_nativeHandle.set_download_limit(limit);
+    m_downloadLimit = limit;
+    m_nativeHandle.set_download_limit(effectiveRateLimit(m_downloadLimit, m_classDownloadLimit));
+    ++m_statusStamp;
+}
+
+void TorrentHandle::setBandwidthClassLimits(const int uploadLimit, const int downloadLimit)
+{
+    if (uploadLimit != m_classUploadLimit) {
+        m_classUploadLimit = uploadLimit;
+        m_nativeHandle.set_upload_limit(effectiveRateLimit(m_uploadLimit, m_classUploadLimit));
+    }
+    if (downloadLimit != m_classDownloadLimit) {
+        m_classDownloadLimit = downloadLimit;
+        m_nativeHandle.set_download_limit(effectiveRateLimit(m_downloadLimit, m_classDownloadLimit));
+    }
 }
 
 void TorrentHandle::setSuperSeeding(const bool enable)
@@ -2257,11 +2306,17 @@ void TorrentHandle::prioritizeFiles(const QVector<DownloadPriority> &priorities)
 }
 
 QVector<qreal> TorrentHandle::availableFileFractions() const
+{
+    if (filesCount() < 0) return {};
+
+    return availableFileFractions(pieceAvailability());
+}
+
+QVector<qreal> TorrentHandle::availableFileFractions(const QVector<int> &piecesAvailability) const
 {
     const int filesCount = this->filesCount();
     if (filesCount < 0) return {};
 
-    const QVector<int> piecesAvailability = pieceAvailability();
     // libtorrent returns empty array for seeding only torrents
     if (piecesAvailability.empty()) return QVector<qreal>(filesCount, -1.);
 
@@ -54,6 +54,8 @@ class QDateTime;
 class QStringList;
 class QUrl;
 
+struct AlertData;
+
 namespace BitTorrent
 {
     enum class DownloadPriority;
@@ -291,6 +293,15 @@ namespace BitTorrent
         QBitArray pieces() const;
         QBitArray downloadingPieces() const;
         QVector<int> pieceAvailability() const;
+        // Non-blocking versions of filesProgress(), pieceAvailability() and downloadingPieces().
+        // The results are delivered by Session::torrentFilesProgressFetched(),
+        // Session::torrentPieceAvailabilityFetched() and Session::torrentDownloadingPiecesFetched().
+        void fetchFilesProgress() const;
+        void fetchPieceAvailability() const;
+        void fetchDownloadingPieces() const;
+        // Changes each time libtorrent reports an update of the torrent status
+        // or the torrent speed limits are changed
+        quint64 statusStamp() const;
         qreal distributedCopies() const;
         qreal maxRatio() const;
         int maxSeedingTime() const;
@@ -336,12 +347,15 @@ namespace BitTorrent
         // Session interface
         lt::torrent_handle nativeHandle() const;
 
-        void handleAlert(const lt::alert *a);
+        void handleAlert(const AlertData &a);
         void handleStateUpdate(const lt::torrent_status &nativeStatus);
         void handleTempPathChanged();
         void handleCategorySavePathChanged();
         void handleAppendExtensionToggled();
         void saveResumeData();
+        // Rate limits assigned by the bandwidth classes, 0 means unlimited.
+        // They never raise own torrent limits.
+        void setBandwidthClassLimits(int uploadLimit, int downloadLimit);
 
         /**
          * @brief fraction of file pieces that are available at least from one peer
@@ -350,6 +364,7 @@ namespace BitTorrent
          * that can be downloaded right now. It varies between 0 to 1.
          */
         QVector<qreal> availableFileFractions() const;
+        QVector<qreal> availableFileFractions(const QVector<int> &piecesAvailability) const;
 
     private:
         typedef std::function<void ()> EventTrigger;
@@ -365,23 +380,23 @@ namespace BitTorrent
         void updateState();
         void updateTorrentInfo();
 
-        void handleFastResumeRejectedAlert(const lt::fastresume_rejected_alert *p);
-        void handleFileCompletedAlert(const lt::file_completed_alert *p);
-        void handleFileRenamedAlert(const lt::file_renamed_alert *p);
-        void handleFileRenameFailedAlert(const lt::file_rename_failed_alert *p);
-        void handleMetadataReceivedAlert(const lt::metadata_received_alert *p);
-        void handlePerformanceAlert(const lt::performance_alert *p) const;
-        void handleSaveResumeDataAlert(const lt::save_resume_data_alert *p);
-        void handleSaveResumeDataFailedAlert(const lt::save_resume_data_failed_alert *p);
-        void handleStorageMovedAlert(const lt::storage_moved_alert *p);
-        void handleStorageMovedFailedAlert(const lt::storage_moved_failed_alert *p);
-        void handleTorrentCheckedAlert(const lt::torrent_checked_alert *p);
-        void handleTorrentFinishedAlert(const lt::torrent_finished_alert *p);
-        void handleTorrentPausedAlert(const lt::torrent_paused_alert *p);
-        void handleTorrentResumedAlert(const lt::torrent_resumed_alert *p);
-        void handleTrackerErrorAlert(const lt::tracker_error_alert *p);
-        void handleTrackerReplyAlert(const lt::tracker_reply_alert *p);
-        void handleTrackerWarningAlert(const lt::tracker_warning_alert *p);
+        void handleFastResumeRejectedAlert(const AlertData &a);
+        void handleFileCompletedAlert(const AlertData &a);
+        void handleFileRenamedAlert(const AlertData &a);
+        void handleFileRenameFailedAlert(const AlertData &a);
+        void handleMetadataReceivedAlert(const AlertData &a);
+        void handlePerformanceAlert(const AlertData &a) const;
+        void handleSaveResumeDataAlert(const AlertData &a);
+        void handleSaveResumeDataFailedAlert(const AlertData &a);
+        void handleStorageMovedAlert(const AlertData &a);
+        void handleStorageMovedFailedAlert(const AlertData &a);
+        void handleTorrentCheckedAlert(const AlertData &a);
+        void handleTorrentFinishedAlert(const AlertData &a);
+        void handleTorrentPausedAlert(const AlertData &a);
+        void handleTorrentResumedAlert(const AlertData &a);
+        void handleTrackerErrorAlert(const AlertData &a);
+        void handleTrackerReplyAlert(const AlertData &a);
+        void handleTrackerWarningAlert(const AlertData &a);
 
         void resume_impl(bool forced);
         bool isMoveInProgress() const;
@@ -442,6 +457,11 @@ namespace BitTorrent
         bool m_hasRootFolder;
         bool m_needsToSetFirstLastPiecePriority;
         bool m_needsToStartForced;
+        int m_uploadLimit = -1;
+        int m_downloadLimit = -1;
+
+        int m_classUploadLimit = 0;
+        int m_classDownloadLimit = 0;
 
         QHash<QString, TrackerInfo> m_trackerInfos;
 
@@ -457,6 +477,7 @@ namespace BitTorrent
         bool m_pauseWhenReady;
 
         bool m_unchecked = false;
+        quint64 m_statusStamp = 0;
     };
 }
 
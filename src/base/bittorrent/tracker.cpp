@@ -29,44 +29,153 @@
 
 #include "tracker.h"
 
+#include <algorithm>
+#include <cstring>
+
 #include <libtorrent/bencode.hpp>
 #include <libtorrent/entry.hpp>
 
+#include <QCryptographicHash>
+#include <QMessageAuthenticationCode>
+#include <QTimer>
+#include <QUdpSocket>
+#include <QtEndian>
+
+#include "base/global.h"
 #include "base/http/server.h"
+#include "base/logger.h"
 #include "base/preferences.h"
+#include "base/utils/random.h"
 
 // static limits
 static const int MAX_TORRENTS = 100;
 static const int MAX_PEERS_PER_TORRENT = 1000;
 static const int ANNOUNCE_INTERVAL = 1800; // 30min
+static const int DEFAULT_NUMWANT = 50;
+static const int MAX_NUMWANT = 200;
+// Peers that didn't announce again within this time are dropped
+static const int PEER_TIMEOUT = 2 * ANNOUNCE_INTERVAL;
+
+// UDP tracker protocol (BEP 15)
+static const quint64 UDP_PROTOCOL_ID = 0x41727101980;
+static const int UDP_CONNECTION_ID_LIFETIME = 60; // in seconds, an ID is accepted for two lifetimes
+static const int UDP_MAX_SCRAPE_HASHES = 74;
+static const int UDP_CONNECTION_ID_KEY_SIZE = 32;
+enum UdpAction : quint32
+{
+    UDP_ACTION_CONNECT = 0,
+    UDP_ACTION_ANNOUNCE = 1,
+    UDP_ACTION_SCRAPE = 2,
+    UDP_ACTION_ERROR = 3
+};
 
 using namespace BitTorrent;
 
-// Peer
-bool Peer::operator!=(const Peer &other) const
+namespace
 {
-    return uid() != other.uid();
+    template <typename T>
+    void appendBigEndian(QByteArray &data, const T value)
+    {
+        const int offset = data.size();
+        data.resize(offset + static_cast<int>(sizeof(T)));
+        qToBigEndian(value, reinterpret_cast<uchar *>(data.data() + offset));
+    }
+
+    QByteArray udpReplyHeader(const UdpAction action, const quint32 transactionId)
+    {
+        QByteArray reply;
+        appendBigEndian<quint32>(reply, action);
+        appendBigEndian<quint32>(reply, transactionId);
+        return reply;
+    }
+
+    QByteArray udpError(const quint32 transactionId, const char *message)
+    {
+        return udpReplyHeader(UDP_ACTION_ERROR, transactionId).append(message);
+    }
+
+    QByteArray randomKey(const int size)
+    {
+        QByteArray key;
+        key.reserve(size);
+        while (key.size() < size) {
+            const quint32 value = Utils::Random::rand();
+            key.append(reinterpret_cast<const char *>(&value), sizeof(value));
+        }
+        key.truncate(size);
+        return key;
+    }
+
+    // Returns the positions of up to "numwant" random peers other than the announcing one.
+    // If "addressSize" is not 0 only peers of the matching address family are considered.
+    QVector<int> selectPeers(const TrackedTorrent &torrent, const TrackerAnnounceRequest &announceReq, const int addressSize = 0)
+    {
+        const QByteArray ownAddress = announceReq.peer.compactAddress();
+        QVector<int> selected;
+        selected.reserve(torrent.peers.size());
+        for (int i = 0; i < torrent.peers.size(); ++i) {
+            const QByteArray &address = torrent.peers[i].address;
+            if ((address != ownAddress) && ((addressSize == 0) || (address.size() == addressSize)))
+                selected.append(i);
+        }
+
+        const int count = std::min(announceReq.numwant, selected.size());
+        for (int i = 0; i < count; ++i) {
+            const int j = i + static_cast<int>(Utils::Random::rand(0, (selected.size() - i - 1)));
+            std::swap(selected[i], selected[j]);
+        }
+        selected.resize(count);
+
+        return selected;
+    }
+
+    lt::entry toEntry(const TrackedPeer &peer, const bool noPeerId)
+    {
+        const int ipSize = peer.address.size() - 2;
+        const auto *data = reinterpret_cast<const uchar *>(peer.address.constData());
+        const QHostAddress ip = (ipSize == 4)
+            ? QHostAddress(qFromBigEndian<quint32>(data))
+            : QHostAddress(data);
+        const int port = qFromBigEndian<quint16>(data + ipSize);
+
+        lt::entry::dictionary_type peerMap;
+        if (!noPeerId)
+            peerMap["id"] = lt::entry(peer.peerId.toStdString());
+        peerMap["ip"] = lt::entry(ip.toString().toStdString());
+        peerMap["port"] = lt::entry(port);
+
+        return lt::entry(peerMap);
+    }
 }
 
-bool Peer::operator==(const Peer &other) const
+// Peer
+bool Peer::operator!=(const Peer &other) const
 {
-    return uid() == other.uid();
+    return compactAddress() != other.compactAddress();
 }
 
-QString Peer::uid() const
+bool Peer::operator==(const Peer &other) const
 {
-    return ip.toString() + ':' + QString::number(port);
+    return compactAddress() == other.compactAddress();
 }
 
-lt::entry Peer::toEntry(const bool noPeerId) const
+QByteArray Peer::compactAddress() const
 {
-    lt::entry::dictionary_type peerMap;
-    if (!noPeerId)
-        peerMap["id"] = lt::entry(peerId.toStdString());
-    peerMap["ip"] = lt::entry(ip.toString().toStdString());
-    peerMap["port"] = lt::entry(port);
+    QByteArray address;
+    bool isIPv4 = false;
+    const quint32 ipv4 = ip.toIPv4Address(&isIPv4);
+    if (isIPv4) {
+        address.resize(4 + 2);
+        qToBigEndian(ipv4, reinterpret_cast<uchar *>(address.data()));
+    }
+    else {
+        const Q_IPV6ADDR ipv6 = ip.toIPv6Address();
+        address.resize(16 + 2);
+        std::memcpy(address.data(), ipv6.c, 16);
+    }
+    qToBigEndian(static_cast<quint16>(port), reinterpret_cast<uchar *>(address.data() + address.size() - 2));
 
-    return lt::entry(peerMap);
+    return address;
 }
 
 // Tracker
@@ -74,7 +183,16 @@ lt::entry Peer::toEntry(const bool noPeerId) const
 Tracker::Tracker(QObject *parent)
     : QObject(parent)
     , m_server(new Http::Server(this, this))
+    , m_udpSocket(new QUdpSocket(this))
+    , m_expiryTimer(new QTimer(this))
+    , m_connectionIdKey {randomKey(UDP_CONNECTION_ID_KEY_SIZE)}
 {
+    m_clock.start();
+
+    connect(m_udpSocket, &QUdpSocket::readyRead, this, &Tracker::processUdpDatagrams);
+
+    connect(m_expiryTimer, &QTimer::timeout, this, qOverload<>(&Tracker::removeExpiredPeers));
+    m_expiryTimer->start(ANNOUNCE_INTERVAL * 1000);
 }
 
 Tracker::~Tracker()
@@ -88,6 +206,14 @@ bool Tracker::start()
 {
     const int listenPort = Preferences::instance()->getTrackerPort();
 
+    if ((m_udpSocket->state() == QAbstractSocket::BoundState) && (m_udpSocket->localPort() != listenPort))
+        m_udpSocket->close();
+    if ((m_udpSocket->state() != QAbstractSocket::BoundState)
+        && !m_udpSocket->bind(QHostAddress::Any, listenPort)) {
+        LogMsg(tr("Embedded tracker failed to listen on UDP port %1. Reason: %2")
+            .arg(listenPort).arg(m_udpSocket->errorString()), Log::WARNING);
+    }
+
     if (m_server->isListening()) {
         if (m_server->serverPort() == listenPort) {
             // Already listening on the right port, just return
@@ -112,16 +238,21 @@ Http::Response Tracker::processRequest(const Http::Request &request, const Http:
         qDebug("Tracker: Unsupported HTTP request: %s", qUtf8Printable(request.method));
         status(100, "Invalid request type");
     }
-    else if (!request.path.startsWith("/announce", Qt::CaseInsensitive)) {
-        qDebug("Tracker: Unrecognized path: %s", qUtf8Printable(request.path));
-        status(100, "Invalid request type");
-    }
-    else {
+    else if (request.path.startsWith("/announce", Qt::CaseInsensitive)) {
         // OK, this is a GET request
         m_request = request;
         m_env = env;
         respondToAnnounceRequest();
     }
+    else if (request.path.startsWith("/scrape", Qt::CaseInsensitive)) {
+        m_request = request;
+        m_env = env;
+        respondToScrapeRequest();
+    }
+    else {
+        qDebug("Tracker: Unrecognized path: %s", qUtf8Printable(request.path));
+        status(100, "Invalid request type");
+    }
 
     return response();
 }
@@ -186,21 +317,26 @@ void Tracker::respondToAnnounceRequest()
     }
 
     // 5. Get numwant
-    announceReq.numwant = 50;
+    announceReq.numwant = DEFAULT_NUMWANT;
     if (queryParams.contains("numwant")) {
-        int tmp = queryParams.value("numwant").toInt();
-        if (tmp > 0) {
+        const int tmp = queryParams.value("numwant").toInt(&ok);
+        if (ok && (tmp >= 0)) {
             qDebug("Tracker: numwant = %d", tmp);
-            announceReq.numwant = tmp;
+            announceReq.numwant = std::min(tmp, MAX_NUMWANT);
         }
     }
 
-    // 6. no_peer_id (extension)
+    // 6. Get left
+    announceReq.isSeed = (queryParams.contains("left") && (queryParams.value("left").toLongLong() == 0))
+        || (announceReq.event == "completed");
+
+    // 7. no_peer_id (extension)
     announceReq.noPeerId = false;
     if (queryParams.contains("no_peer_id"))
         announceReq.noPeerId = true;
 
-    // 7. TODO: support "compact" extension
+    // 8. compact (extension, BEP 23)
+    announceReq.compact = (queryParams.value("compact") == "1");
 
     // Done parsing, now let's reply
     if (announceReq.event == "stopped") {
@@ -212,36 +348,107 @@ void Tracker::respondToAnnounceRequest()
     }
 }
 
+void Tracker::respondToScrapeRequest()
+{
+    // Several "info_hash" parameters may be given, none means all torrents
+    QList<QByteArray> infoHashes = m_request.query.values("info_hash");
+    if (infoHashes.isEmpty())
+        infoHashes = m_torrents.keys();
+
+    lt::entry::dictionary_type files;
+    for (const QByteArray &infoHash : asConst(infoHashes)) {
+        const auto torrentIter = m_torrents.constFind(infoHash);
+        if (torrentIter == m_torrents.cend()) continue;
+
+        lt::entry::dictionary_type stats;
+        stats["complete"] = lt::entry(torrentIter->seeders);
+        stats["downloaded"] = lt::entry(torrentIter->completed);
+        stats["incomplete"] = lt::entry(torrentIter->peers.size() - torrentIter->seeders);
+        files[infoHash.toStdString()] = lt::entry(stats);
+    }
+
+    lt::entry::dictionary_type replyDict;
+    replyDict["files"] = lt::entry(files);
+
+    QByteArray reply;
+    lt::bencode(std::back_inserter(reply), lt::entry(replyDict));
+    print(reply, Http::CONTENT_TYPE_TXT);
+}
+
 void Tracker::registerPeer(const TrackerAnnounceRequest &announceReq)
 {
     if (announceReq.peer.port == 0) return;
 
+    const qint64 now = m_clock.elapsed() / 1000;
+
     if (!m_torrents.contains(announceReq.infoHash)) {
         // Unknown torrent
-        if (m_torrents.size() == MAX_TORRENTS) {
-            // Reached max size, remove a random torrent
-            m_torrents.erase(m_torrents.begin());
+        if (m_torrents.size() >= MAX_TORRENTS)
+            removeExpiredPeers();
+        if (m_torrents.size() >= MAX_TORRENTS) {
+            // Reached max size, remove the least recently announced torrent
+            const auto oldest = std::min_element(m_torrents.begin(), m_torrents.end()
+                , [](const TrackedTorrent &left, const TrackedTorrent &right)
+            {
+                return (left.lastAnnounce < right.lastAnnounce);
+            });
+            m_torrents.erase(oldest);
         }
     }
 
     // Register the user
-    PeerList &peers = m_torrents[announceReq.infoHash];
-    if (!peers.contains(announceReq.peer.uid())) {
-        // Unknown peer
-        if (peers.size() == MAX_PEERS_PER_TORRENT) {
-            // Too many peers, remove a random one
-            peers.erase(peers.begin());
+    TrackedTorrent &torrent = m_torrents[announceReq.infoHash];
+    torrent.lastAnnounce = now;
+    if (announceReq.event == "completed")
+        ++torrent.completed;
+
+    const QByteArray address = announceReq.peer.compactAddress();
+    const int index = torrent.peerIndexes.value(address, -1);
+    if (index >= 0) {
+        TrackedPeer &peer = torrent.peers[index];
+        peer.peerId = announceReq.peer.peerId;
+        peer.lastAnnounce = now;
+        if (peer.isSeed != announceReq.isSeed) {
+            peer.isSeed = announceReq.isSeed;
+            torrent.seeders += (peer.isSeed ? 1 : -1);
         }
+        return;
     }
-    peers[announceReq.peer.uid()] = announceReq.peer;
+
+    // Unknown peer
+    if (torrent.peers.size() >= MAX_PEERS_PER_TORRENT)
+        expirePeers(torrent, now);
+    if (torrent.peers.size() >= MAX_PEERS_PER_TORRENT) {
+        // Too many peers, remove the least recently announced one
+        const auto oldest = std::min_element(torrent.peers.cbegin(), torrent.peers.cend()
+            , [](const TrackedPeer &left, const TrackedPeer &right)
+        {
+            return (left.lastAnnounce < right.lastAnnounce);
+        });
+        removePeer(torrent, (oldest - torrent.peers.cbegin()));
+    }
+
+    torrent.peerIndexes.insert(address, torrent.peers.size());
+    torrent.peers.append({address, announceReq.peer.peerId, now, announceReq.isSeed});
+    if (announceReq.isSeed)
+        ++torrent.seeders;
 }
 
 void Tracker::unregisterPeer(const TrackerAnnounceRequest &announceReq)
 {
     if (announceReq.peer.port == 0) return;
 
-    if (m_torrents[announceReq.infoHash].remove(announceReq.peer.uid()) > 0)
-        qDebug("Tracker: Peer stopped downloading, deleting it from the list");
+    const auto torrentIter = m_torrents.find(announceReq.infoHash);
+    if (torrentIter == m_torrents.end()) return;
+
+    const int index = torrentIter->peerIndexes.value(announceReq.peer.compactAddress(), -1);
+    if (index < 0) return;
+
+    removePeer(*torrentIter, index);
+    qDebug("Tracker: Peer stopped downloading, deleting it from the list");
+
+    if (torrentIter->peers.isEmpty())
+        m_torrents.erase(torrentIter);
 }
 
 void Tracker::replyWithPeerList(const TrackerAnnounceRequest &announceReq)
@@ -250,10 +457,31 @@ void Tracker::replyWithPeerList(const TrackerAnnounceRequest &announceReq)
     lt::entry::dictionary_type replyDict;
     replyDict["interval"] = lt::entry(ANNOUNCE_INTERVAL);
 
-    lt::entry::list_type peerList;
-    for (const Peer &p : m_torrents.value(announceReq.infoHash))
-        peerList.push_back(p.toEntry(announceReq.noPeerId));
-    replyDict["peers"] = lt::entry(peerList);
+    const TrackedTorrent torrent = m_torrents.value(announceReq.infoHash);
+    replyDict["complete"] = lt::entry(torrent.seeders);
+    replyDict["incomplete"] = lt::entry(torrent.peers.size() - torrent.seeders);
+
+    const QVector<int> selected = selectPeers(torrent, announceReq);
+
+    if (announceReq.compact) {
+        // IPv4 peers go to "peers" (BEP 23), IPv6 ones to "peers6" (BEP 7)
+        std::string peers;
+        std::string peers6;
+        for (const int i : asConst(selected)) {
+            const QByteArray &address = torrent.peers[i].address;
+            std::string &target = (address.size() == (4 + 2)) ? peers : peers6;
+            target.append(address.constData(), address.size());
+        }
+        replyDict["peers"] = lt::entry(peers);
+        if (!peers6.empty())
+            replyDict["peers6"] = lt::entry(peers6);
+    }
+    else {
+        lt::entry::list_type peerList;
+        for (const int i : asConst(selected))
+            peerList.push_back(toEntry(torrent.peers[i], announceReq.noPeerId));
+        replyDict["peers"] = lt::entry(peerList);
+    }
 
     const lt::entry replyEntry(replyDict);
     // bencode
@@ -264,3 +492,177 @@ void Tracker::replyWithPeerList(const TrackerAnnounceRequest &announceReq)
     // HTTP reply
     print(reply, Http::CONTENT_TYPE_TXT);
 }
+
+void Tracker::removeExpiredPeers()
+{
+    const qint64 now = m_clock.elapsed() / 1000;
+    for (auto i = m_torrents.begin(); i != m_torrents.end();) {
+        expirePeers(*i, now);
+        if (i->peers.isEmpty())
+            i = m_torrents.erase(i);
+        else
+            ++i;
+    }
+}
+
+void Tracker::expirePeers(TrackedTorrent &torrent, const qint64 now)
+{
+    // Iterate backwards so the peers moved by removePeer() have already been checked
+    for (int i = (torrent.peers.size() - 1); i >= 0; --i) {
+        if ((now - torrent.peers[i].lastAnnounce) > PEER_TIMEOUT)
+            removePeer(torrent, i);
+    }
+}
+
+void Tracker::removePeer(TrackedTorrent &torrent, const int index)
+{
+    // Move the last peer into the freed slot to keep the storage contiguous
+    if (torrent.peers[index].isSeed)
+        --torrent.seeders;
+    torrent.peerIndexes.remove(torrent.peers[index].address);
+    const int lastIndex = torrent.peers.size() - 1;
+    if (index != lastIndex) {
+        torrent.peers[index] = torrent.peers[lastIndex];
+        torrent.peerIndexes[torrent.peers[index].address] = index;
+    }
+    torrent.peers.removeLast();
+}
+
+void Tracker::processUdpDatagrams()
+{
+    while (m_udpSocket->hasPendingDatagrams()) {
+        QByteArray request;
+        request.resize(static_cast<int>(std::max<qint64>(m_udpSocket->pendingDatagramSize(), 0)));
+        QHostAddress address;
+        quint16 port = 0;
+        const qint64 size = m_udpSocket->readDatagram(request.data(), request.size(), &address, &port);
+        if (size < 0) break;
+
+        request.resize(static_cast<int>(size));
+        const QByteArray reply = processUdpRequest(request, address, port);
+        if (!reply.isEmpty())
+            m_udpSocket->writeDatagram(reply, address, port);
+    }
+}
+
+QByteArray Tracker::processUdpRequest(const QByteArray &request, const QHostAddress &address, const quint16 port)
+{
+    // Every request starts with connection_id (64 bits), action and transaction_id (32 bits each)
+    if (request.size() < 16) return {};
+
+    const auto *data = reinterpret_cast<const uchar *>(request.constData());
+    const quint64 connectionId = qFromBigEndian<quint64>(data);
+    const quint32 action = qFromBigEndian<quint32>(data + 8);
+    const quint32 transactionId = qFromBigEndian<quint32>(data + 12);
+
+    if (action == UDP_ACTION_CONNECT) {
+        if (connectionId != UDP_PROTOCOL_ID) return {};
+
+        QByteArray reply = udpReplyHeader(UDP_ACTION_CONNECT, transactionId);
+        appendBigEndian<quint64>(reply, udpConnectionId(address, port, (m_clock.elapsed() / 1000 / UDP_CONNECTION_ID_LIFETIME)));
+        return reply;
+    }
+
+    // Connection IDs aren't stored, they are derived from the client address and the current time slot.
+    // Sources that didn't prove their address get no reply at all, it could be spoofed.
+    const qint64 timeSlot = m_clock.elapsed() / 1000 / UDP_CONNECTION_ID_LIFETIME;
+    if ((connectionId != udpConnectionId(address, port, timeSlot))
+        && (connectionId != udpConnectionId(address, port, (timeSlot - 1)))) {
+        return {};
+    }
+
+    switch (action) {
+    case UDP_ACTION_ANNOUNCE:
+        return processUdpAnnounce(request, transactionId, address);
+    case UDP_ACTION_SCRAPE:
+        return processUdpScrape(request, transactionId);
+    default:
+        return udpError(transactionId, "Invalid action");
+    }
+}
+
+QByteArray Tracker::processUdpAnnounce(const QByteArray &request, const quint32 transactionId, const QHostAddress &address)
+{
+    if (request.size() < 98)
+        return udpError(transactionId, "Malformed announce request");
+
+    const auto *data = reinterpret_cast<const uchar *>(request.constData());
+    TrackerAnnounceRequest announceReq;
+    announceReq.infoHash = request.mid(16, 20);
+    announceReq.peer.peerId = request.mid(36, 20);
+    const quint64 left = qFromBigEndian<quint64>(data + 64);
+    const quint32 event = qFromBigEndian<quint32>(data + 80);
+    const quint32 ip = qFromBigEndian<quint32>(data + 84);
+    const qint32 numwant = qFromBigEndian<qint32>(data + 92);
+    announceReq.peer.port = qFromBigEndian<quint16>(data + 96);
+    announceReq.peer.ip = (ip != 0) ? QHostAddress(ip) : address;
+
+    switch (event) {
+    case 1:
+        announceReq.event = QLatin1String("completed");
+        break;
+    case 2:
+        announceReq.event = QLatin1String("started");
+        break;
+    case 3:
+        announceReq.event = QLatin1String("stopped");
+        break;
+    default:
+        break;
+    }
+
+    announceReq.numwant = (numwant < 0) ? DEFAULT_NUMWANT : std::min<int>(numwant, MAX_NUMWANT);
+    announceReq.isSeed = (left == 0) || (announceReq.event == "completed");
+    announceReq.noPeerId = true;
+    announceReq.compact = true;
+
+    if (announceReq.event == "stopped")
+        unregisterPeer(announceReq);
+    else
+        registerPeer(announceReq);
+
+    const TrackedTorrent torrent = m_torrents.value(announceReq.infoHash);
+
+    QByteArray reply = udpReplyHeader(UDP_ACTION_ANNOUNCE, transactionId);
+    appendBigEndian<quint32>(reply, ANNOUNCE_INTERVAL);
+    appendBigEndian<quint32>(reply, (torrent.peers.size() - torrent.seeders));
+    appendBigEndian<quint32>(reply, torrent.seeders);
+
+    // Peers of the same address family as the request is sent over
+    bool isIPv4 = false;
+    address.toIPv4Address(&isIPv4);
+    if (announceReq.event != "stopped") {
+        for (const int i : asConst(selectPeers(torrent, announceReq, (isIPv4 ? (4 + 2) : (16 + 2)))))
+            reply.append(torrent.peers[i].address);
+    }
+
+    return reply;
+}
+
+QByteArray Tracker::processUdpScrape(const QByteArray &request, const quint32 transactionId) const
+{
+    QByteArray reply = udpReplyHeader(UDP_ACTION_SCRAPE, transactionId);
+
+    const int hashCount = std::min(((request.size() - 16) / 20), UDP_MAX_SCRAPE_HASHES);
+    for (int i = 0; i < hashCount; ++i) {
+        const TrackedTorrent torrent = m_torrents.value(request.mid((16 + (i * 20)), 20));
+        appendBigEndian<quint32>(reply, torrent.seeders);
+        appendBigEndian<quint32>(reply, torrent.completed);
+        appendBigEndian<quint32>(reply, (torrent.peers.size() - torrent.seeders));
+    }
+
+    return reply;
+}
+
+quint64 Tracker::udpConnectionId(const QHostAddress &address, const quint16 port, const qint64 timeSlot) const
+{
+    Peer client;
+    client.ip = address;
+    client.port = port;
+    QByteArray message = client.compactAddress();
+    appendBigEndian<qint64>(message, timeSlot);
+
+    // A keyed MAC, so that IDs of other addresses can't be derived from the ones a client gets
+    const QByteArray mac = QMessageAuthenticationCode::hash(message, m_connectionIdKey, QCryptographicHash::Sha256);
+    return qFromBigEndian<quint64>(reinterpret_cast<const uchar *>(mac.constData()));
+}
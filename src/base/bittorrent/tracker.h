@@ -32,13 +32,18 @@
 
 #include <libtorrent/fwd.hpp>
 
+#include <QElapsedTimer>
 #include <QHash>
 #include <QObject>
 #include <QHostAddress>
+#include <QVector>
 
 #include "base/http/irequesthandler.h"
 #include "base/http/responsebuilder.h"
 
+class QTimer;
+class QUdpSocket;
+
 namespace Http
 {
     class Server;
@@ -54,8 +59,8 @@ namespace BitTorrent
 
         bool operator!=(const Peer &other) const;
         bool operator==(const Peer &other) const;
-        QString uid() const;
-        lt::entry toEntry(bool noPeerId) const;
+        // IP address followed by port, both in network byte order (BEP 23/BEP 7)
+        QByteArray compactAddress() const;
     };
 
     struct TrackerAnnounceRequest
@@ -64,15 +69,34 @@ namespace BitTorrent
         QString event;
         int numwant;
         Peer peer;
+        bool isSeed;
         // Extensions
         bool noPeerId;
+        bool compact;
     };
 
-    typedef QHash<QString, Peer> PeerList;
-    typedef QHash<QByteArray, PeerList> TorrentList;
+    struct TrackedPeer
+    {
+        QByteArray address; // compact form, see Peer::compactAddress()
+        QByteArray peerId;
+        qint64 lastAnnounce;
+        bool isSeed;
+    };
+
+    struct TrackedTorrent
+    {
+        QVector<TrackedPeer> peers;
+        QHash<QByteArray, int> peerIndexes; // address -> position in peers
+        qint64 lastAnnounce = 0;
+        int seeders = 0;
+        int completed = 0;
+    };
+
+    typedef QHash<QByteArray, TrackedTorrent> TorrentList;
 
     /* Basic Bittorrent tracker implementation in Qt */
     /* Following http://wiki.theory.org/BitTorrent_Tracker_Protocol */
+    /* UDP announces and scrapes follow BEP 15 and share the same peer store */
     class Tracker : public QObject, public Http::IRequestHandler, private Http::ResponseBuilder
     {
         Q_OBJECT
@@ -85,14 +109,29 @@ namespace BitTorrent
         bool start();
         Http::Response processRequest(const Http::Request &request, const Http::Environment &env) override;
 
+    private slots:
+        void removeExpiredPeers();
+        void processUdpDatagrams();
+
     private:
         void respondToAnnounceRequest();
+        void respondToScrapeRequest();
         void registerPeer(const TrackerAnnounceRequest &announceReq);
         void unregisterPeer(const TrackerAnnounceRequest &announceReq);
         void replyWithPeerList(const TrackerAnnounceRequest &announceReq);
+        QByteArray processUdpRequest(const QByteArray &request, const QHostAddress &address, quint16 port);
+        QByteArray processUdpAnnounce(const QByteArray &request, quint32 transactionId, const QHostAddress &address);
+        QByteArray processUdpScrape(const QByteArray &request, quint32 transactionId) const;
+        quint64 udpConnectionId(const QHostAddress &address, quint16 port, qint64 timeSlot) const;
+        static void expirePeers(TrackedTorrent &torrent, qint64 now);
+        static void removePeer(TrackedTorrent &torrent, int index);
 
         Http::Server *m_server;
+        QUdpSocket *m_udpSocket;
+        QTimer *m_expiryTimer;
+        QElapsedTimer m_clock;
         TorrentList m_torrents;
+        QByteArray m_connectionIdKey;
 
         Http::Request m_request;
         Http::Environment m_env;
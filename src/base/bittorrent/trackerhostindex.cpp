@@ -0,0 +1,227 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2019  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#include "trackerhostindex.h"
+
+#include <QUrl>
+
+#include "torrenthandle.h"
+#include "trackerentry.h"
+
+using namespace BitTorrent;
+
+TrackerHostIndex::TrackerHostIndex(QObject *parent)
+    : QObject(parent)
+{
+}
+
+// Subdomains are disregarded, i.e. the result is the domain + tld.
+// For IP addresses and invalid domains the full host is returned.
+QString TrackerHostIndex::hostFromUrl(const QString &url)
+{
+    const QUrl trackerUrl(url);
+    const QString longHost = trackerUrl.host();
+    const QString tld = trackerUrl.topLevelDomain();
+    if (tld.isEmpty())
+        return longHost;
+
+    const int index = longHost.lastIndexOf('.', -(tld.size() + 1));
+    if (index == -1)
+        return longHost;
+    return longHost.mid(index + 1);
+}
+
+QStringList TrackerHostIndex::hosts() const
+{
+    QStringList hosts = m_torrentsByHost.keys();
+    hosts.removeOne({});
+    return hosts;
+}
+
+QSet<QString> TrackerHostIndex::torrents(const QString &host) const
+{
+    return m_torrentsByHost.value(host);
+}
+
+int TrackerHostIndex::torrentCount(const QString &host) const
+{
+    return m_torrentsByHost.value(host).size();
+}
+
+QSet<QString> TrackerHostIndex::erroredTorrents() const
+{
+    return m_erroredTrackers.keys().toSet();
+}
+
+int TrackerHostIndex::erroredTorrentCount() const
+{
+    return m_erroredTrackers.size();
+}
+
+QSet<QString> TrackerHostIndex::warnedTorrents() const
+{
+    return m_warnedTrackers.keys().toSet();
+}
+
+int TrackerHostIndex::warnedTorrentCount() const
+{
+    return m_warnedTrackers.size();
+}
+
+// Brings the torrent entries in line with its current trackers,
+// only the hosts that actually gained or lost the torrent are touched.
+void TrackerHostIndex::updateTorrent(const TorrentHandle *torrent)
+{
+    const QString hash = torrent->hash();
+    const QVector<TrackerEntry> trackers = torrent->trackers();
+
+    QHash<QString, QString> newHosts;  // host -> first tracker URL
+    QSet<QString> trackerUrls;
+    for (const TrackerEntry &tracker : trackers) {
+        const QString url = tracker.url();
+        trackerUrls.insert(url);
+        const QString host = hostFromUrl(url);
+        if (!newHosts.contains(host))
+            newHosts.insert(host, url);
+    }
+    if (newHosts.isEmpty())
+        newHosts.insert({}, {});
+
+    const QSet<QString> oldHosts = m_hostsByTorrent.value(hash);
+    for (const QString &host : oldHosts) {
+        if (!newHosts.contains(host))
+            removeFromHost(host, hash);
+    }
+    for (auto it = newHosts.cbegin(); it != newHosts.cend(); ++it) {
+        if (!oldHosts.contains(it.key()))
+            addToHost(it.key(), hash, it.value());
+    }
+    m_hostsByTorrent[hash] = newHosts.keys().toSet();
+
+    // Forget about the status of the removed trackers
+    const auto dropRemovedTrackers = [&hash, &trackerUrls](QHash<QString, QSet<QString>> &trackersByTorrent) -> bool
+    {
+        const auto it = trackersByTorrent.find(hash);
+        if (it == trackersByTorrent.end()) return false;
+
+        it->intersect(trackerUrls);
+        if (!it->isEmpty()) return false;
+
+        trackersByTorrent.erase(it);
+        return true;
+    };
+    if (dropRemovedTrackers(m_erroredTrackers))
+        emit erroredTorrentsChanged();
+    if (dropRemovedTrackers(m_warnedTrackers))
+        emit warnedTorrentsChanged();
+}
+
+void TrackerHostIndex::removeTorrent(const QString &hash)
+{
+    const QSet<QString> hosts = m_hostsByTorrent.take(hash);
+    for (const QString &host : hosts)
+        removeFromHost(host, hash);
+
+    if (m_erroredTrackers.remove(hash) > 0)
+        emit erroredTorrentsChanged();
+    if (m_warnedTrackers.remove(hash) > 0)
+        emit warnedTorrentsChanged();
+}
+
+void TrackerHostIndex::handleTrackerReply(const QString &hash, const QString &trackerUrl)
+{
+    if (removeTracker(m_erroredTrackers, hash, trackerUrl))
+        emit erroredTorrentsChanged();
+    if (removeTracker(m_warnedTrackers, hash, trackerUrl))
+        emit warnedTorrentsChanged();
+}
+
+void TrackerHostIndex::handleTrackerError(const QString &hash, const QString &trackerUrl)
+{
+    if (!m_hostsByTorrent.contains(hash)) return;
+
+    QSet<QString> &trackers = m_erroredTrackers[hash];
+    const bool isNewTorrent = trackers.isEmpty();
+    trackers.insert(trackerUrl);
+    if (isNewTorrent)
+        emit erroredTorrentsChanged();
+}
+
+void TrackerHostIndex::handleTrackerWarning(const QString &hash, const QString &trackerUrl)
+{
+    if (!m_hostsByTorrent.contains(hash)) return;
+
+    QSet<QString> &trackers = m_warnedTrackers[hash];
+    const bool isNewTorrent = trackers.isEmpty();
+    trackers.insert(trackerUrl);
+    if (isNewTorrent)
+        emit warnedTorrentsChanged();
+}
+
+void TrackerHostIndex::addToHost(const QString &host, const QString &hash, const QString &trackerUrl)
+{
+    auto it = m_torrentsByHost.find(host);
+    const bool isNewHost = (it == m_torrentsByHost.end());
+    if (isNewHost)
+        it = m_torrentsByHost.insert(host, {});
+    it->insert(hash);
+
+    if (isNewHost && !host.isEmpty())
+        emit hostAdded(host, trackerUrl);
+    else
+        emit hostTorrentsChanged(host);
+}
+
+void TrackerHostIndex::removeFromHost(const QString &host, const QString &hash)
+{
+    const auto it = m_torrentsByHost.find(host);
+    if (it == m_torrentsByHost.end()) return;
+
+    it->remove(hash);
+    if (it->isEmpty() && !host.isEmpty()) {
+        m_torrentsByHost.erase(it);
+        emit hostRemoved(host);
+    }
+    else {
+        emit hostTorrentsChanged(host);
+    }
+}
+
+// Returns true if the torrent has no trackers left in the set
+bool TrackerHostIndex::removeTracker(QHash<QString, QSet<QString>> &trackersByTorrent, const QString &hash, const QString &trackerUrl)
+{
+    const auto it = trackersByTorrent.find(hash);
+    if ((it == trackersByTorrent.end()) || !it->remove(trackerUrl))
+        return false;
+
+    if (!it->isEmpty())
+        return false;
+
+    trackersByTorrent.erase(it);
+    return true;
+}
@@ -0,0 +1,88 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2019  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#pragma once
+
+#include <QHash>
+#include <QObject>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+
+namespace BitTorrent
+{
+    class TorrentHandle;
+
+    // Groups torrents by the hosts of their trackers and keeps track of the torrents
+    // whose trackers reported errors or warnings. Torrents are identified by their hash.
+    // Trackerless torrents are listed under the empty host.
+    // The index is kept up to date by Session as trackers get added, removed or reply.
+    class TrackerHostIndex : public QObject
+    {
+        Q_OBJECT
+        Q_DISABLE_COPY(TrackerHostIndex)
+
+        friend class Session;
+
+    public:
+        static QString hostFromUrl(const QString &url);
+
+        QStringList hosts() const;
+        QSet<QString> torrents(const QString &host) const;
+        int torrentCount(const QString &host) const;
+        QSet<QString> erroredTorrents() const;
+        int erroredTorrentCount() const;
+        QSet<QString> warnedTorrents() const;
+        int warnedTorrentCount() const;
+
+    signals:
+        void hostAdded(const QString &host, const QString &trackerUrl);
+        void hostRemoved(const QString &host);
+        void hostTorrentsChanged(const QString &host);
+        void erroredTorrentsChanged();
+        void warnedTorrentsChanged();
+
+    private:
+        explicit TrackerHostIndex(QObject *parent = nullptr);
+
+        void updateTorrent(const TorrentHandle *torrent);
+        void removeTorrent(const QString &hash);
+        void handleTrackerReply(const QString &hash, const QString &trackerUrl);
+        void handleTrackerError(const QString &hash, const QString &trackerUrl);
+        void handleTrackerWarning(const QString &hash, const QString &trackerUrl);
+
+        void addToHost(const QString &host, const QString &hash, const QString &trackerUrl);
+        void removeFromHost(const QString &host, const QString &hash);
+        static bool removeTracker(QHash<QString, QSet<QString>> &trackersByTorrent, const QString &hash, const QString &trackerUrl);
+
+        QHash<QString, QSet<QString>> m_torrentsByHost;
+        QHash<QString, QSet<QString>> m_hostsByTorrent;
+        QHash<QString, QSet<QString>> m_erroredTrackers;
+        QHash<QString, QSet<QString>> m_warnedTrackers;
+    };
+}
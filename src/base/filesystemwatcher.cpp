@@ -28,6 +28,11 @@
 
 #include "filesystemwatcher.h"
 
+#include <algorithm>
+
+#include <QFileInfo>
+#include <QMutexLocker>
+#include <QRunnable>
 #include <QtGlobal>
 
 #if defined(Q_OS_MAC) || defined(Q_OS_FREEBSD) || defined(Q_OS_OPENBSD)
@@ -37,7 +42,6 @@
 #endif
 
 #include "base/algorithm.h"
-#include "base/bittorrent/torrentinfo.h"
 #include "base/global.h"
 #include "base/logger.h"
 #include "base/utils/fs.h"
@@ -45,9 +49,30 @@
 namespace
 {
     const int WATCH_INTERVAL = 10000; // 10 sec
+    const int SCAN_DELAY = 2000; // give the files some time to be written
     const int MAX_PARTIAL_RETRIES = 5;
+    const int MAX_BATCH_SIZE = 100;
 }
 
+class FileSystemWatcher::Parser : public QRunnable
+{
+public:
+    Parser(FileSystemWatcher *watcher, const QString &path)
+        : m_watcher(watcher)
+        , m_path(path)
+    {
+    }
+
+    void run() override
+    {
+        m_watcher->handleTorrentParsed(m_path, BitTorrent::TorrentInfo::loadFromFile(m_path));
+    }
+
+private:
+    FileSystemWatcher *m_watcher;
+    const QString m_path;
+};
+
 FileSystemWatcher::FileSystemWatcher(QObject *parent)
     : QFileSystemWatcher(parent)
 {
@@ -57,6 +82,14 @@ FileSystemWatcher::FileSystemWatcher(QObject *parent)
     connect(&m_partialTorrentTimer, &QTimer::timeout, this, &FileSystemWatcher::processPartialTorrents);
 
     connect(&m_watchTimer, &QTimer::timeout, this, &FileSystemWatcher::scanNetworkFolders);
+
+    m_scanTimer.setSingleShot(true);
+    m_scanTimer.setInterval(SCAN_DELAY);
+    connect(&m_scanTimer, &QTimer::timeout, this, &FileSystemWatcher::scanPendingFolders);
+
+    m_batchTimer.setSingleShot(true);
+    m_batchTimer.setInterval(0);
+    connect(&m_batchTimer, &QTimer::timeout, this, &FileSystemWatcher::addReadyTorrents);
 }
 
 QStringList FileSystemWatcher::directories() const
@@ -97,16 +130,73 @@ void FileSystemWatcher::removePath(const QString &path)
     if (m_watchedFolders.removeOne(path)) {
         if (m_watchedFolders.isEmpty())
             m_watchTimer.stop();
-        return;
+    }
+    else {
+        // Normal mode
+        QFileSystemWatcher::removePath(path);
     }
 
-    // Normal mode
-    QFileSystemWatcher::removePath(path);
+    dropFolderTorrents(QDir(path));
+}
+
+// Forgets the files of the folder that is no longer watched,
+// the ones being parsed are dropped once their parsing is done
+void FileSystemWatcher::dropFolderTorrents(const QDir &dir)
+{
+    const auto isInFolder = [&dir](const QString &filePath) -> bool
+    {
+        return (QFileInfo(filePath).dir() == dir);
+    };
+
+    Algorithm::removeIf(m_pendingFolders, [&dir](const QString &folder)
+    {
+        return (QDir(folder) == dir);
+    });
+
+    Algorithm::removeIf(m_partialTorrents, [&isInFolder](const QString &filePath, int &)
+    {
+        return isInFolder(filePath);
+    });
+    if (m_partialTorrents.isEmpty())
+        m_partialTorrentTimer.stop();
+
+    Algorithm::removeIf(m_readyTorrents, [this, &isInFolder](const QString &filePath, const BitTorrent::TorrentInfo &)
+    {
+        if (!isInFolder(filePath))
+            return false;
+
+        m_parsingTorrents.remove(filePath);
+        return true;
+    });
+}
+
+bool FileSystemWatcher::isWatchedFile(const QString &path) const
+{
+    const QDir dir = QFileInfo(path).dir();
+    if (m_watchedFolders.contains(dir))
+        return true;
+
+    const QStringList localFolders = QFileSystemWatcher::directories();
+    return std::any_of(localFolders.cbegin(), localFolders.cend(), [&dir](const QString &folder)
+    {
+        return (QDir(folder) == dir);
+    });
 }
 
 void FileSystemWatcher::scanLocalFolder(const QString &path)
 {
-    QTimer::singleShot(2000, this, [this, path]() { processTorrentsInDir(path); });
+    m_pendingFolders.insert(path);
+    // Don't postpone the scan if the folder keeps changing
+    if (!m_scanTimer.isActive())
+        m_scanTimer.start();
+}
+
+void FileSystemWatcher::scanPendingFolders()
+{
+    const QSet<QString> folders = m_pendingFolders;
+    m_pendingFolders.clear();
+    for (const QString &path : folders)
+        processTorrentsInDir(path);
 }
 
 void FileSystemWatcher::scanNetworkFolders()
@@ -117,25 +207,20 @@ void FileSystemWatcher::scanNetworkFolders()
 
 void FileSystemWatcher::processPartialTorrents()
 {
-    QStringList noLongerPartial;
-
-    // Check which torrents are still partial
-    Algorithm::removeIf(m_partialTorrents, [&noLongerPartial](const QString &torrentPath, int &value)
+    // Check which torrents are still partial, the ones that become
+    // valid are removed from the list once they are parsed
+    Algorithm::removeIf(m_partialTorrents, [this](const QString &torrentPath, int &value)
     {
         if (!QFile::exists(torrentPath))
             return true;
 
-        if (BitTorrent::TorrentInfo::loadFromFile(torrentPath).isValid()) {
-            noLongerPartial << torrentPath;
-            return true;
-        }
-
         if (value >= MAX_PARTIAL_RETRIES) {
             QFile::rename(torrentPath, torrentPath + ".qbt_rejected");
             return true;
         }
 
         ++value;
+        parseTorrentFile(torrentPath);
         return false;
     });
 
@@ -148,29 +233,90 @@ void FileSystemWatcher::processPartialTorrents()
         qDebug("Still %d partial torrents after delayed processing.", m_partialTorrents.count());
         m_partialTorrentTimer.start(WATCH_INTERVAL);
     }
-
-    // Notify of new torrents
-    if (!noLongerPartial.isEmpty())
-        emit torrentsAdded(noLongerPartial);
 }
 
 void FileSystemWatcher::processTorrentsInDir(const QDir &dir)
 {
-    QStringList torrents;
+    QStringList magnetFiles;
     const QStringList files = dir.entryList({"*.torrent", "*.magnet"}, QDir::Files);
     for (const QString &file : files) {
         const QString fileAbsPath = dir.absoluteFilePath(file);
         if (file.endsWith(".magnet"))
-            torrents << fileAbsPath;
-        else if (BitTorrent::TorrentInfo::loadFromFile(fileAbsPath).isValid())
-            torrents << fileAbsPath;
-        else if (!m_partialTorrents.contains(fileAbsPath))
-            m_partialTorrents[fileAbsPath] = 0;
+            magnetFiles << fileAbsPath;
+        else if (!m_partialTorrents.contains(fileAbsPath)) // partial torrents are retried by timer
+            parseTorrentFile(fileAbsPath);
     }
 
-    if (!torrents.empty())
-        emit torrentsAdded(torrents);
+    if (!magnetFiles.empty())
+        emit magnetFilesAdded(magnetFiles);
+}
+
+void FileSystemWatcher::parseTorrentFile(const QString &path)
+{
+    if (m_parsingTorrents.contains(path)) return;
+
+    m_parsingTorrents.insert(path);
+    m_parsers.start(new Parser(this, path));
+}
+
+void FileSystemWatcher::handleTorrentParsed(const QString &path, const BitTorrent::TorrentInfo &torrentInfo)
+{
+    QMutexLocker locker(&m_parsedTorrentsMutex);
+    // Results are collected until the watcher processes them
+    const bool isProcessingScheduled = !m_parsedTorrents.isEmpty();
+    m_parsedTorrents.insert(path, torrentInfo);
+    if (!isProcessingScheduled)
+        QMetaObject::invokeMethod(this, "processParsedTorrents", Qt::QueuedConnection);
+}
+
+void FileSystemWatcher::processParsedTorrents()
+{
+    QHash<QString, BitTorrent::TorrentInfo> parsedTorrents;
+    {
+        QMutexLocker locker(&m_parsedTorrentsMutex);
+        parsedTorrents.swap(m_parsedTorrents);
+    }
+
+    for (auto i = parsedTorrents.cbegin(); i != parsedTorrents.cend(); ++i) {
+        const QString &path = i.key();
+        // its folder could have been removed during the parsing
+        if (!isWatchedFile(path)) {
+            m_parsingTorrents.remove(path);
+            m_partialTorrents.remove(path);
+            continue;
+        }
+
+        if (i.value().isValid()) {
+            m_partialTorrents.remove(path);
+            m_readyTorrents.insert(path, i.value());
+            continue;
+        }
+
+        m_parsingTorrents.remove(path);
+        if (!m_partialTorrents.contains(path) && QFile::exists(path))
+            m_partialTorrents[path] = 0;
+    }
+
+    if (!m_readyTorrents.isEmpty() && !m_batchTimer.isActive())
+        m_batchTimer.start();
 
     if (!m_partialTorrents.empty() && !m_partialTorrentTimer.isActive())
         m_partialTorrentTimer.start(WATCH_INTERVAL);
 }
+
+// Passes the parsed torrents on in batches, letting the event loop run in between
+void FileSystemWatcher::addReadyTorrents()
+{
+    QHash<QString, BitTorrent::TorrentInfo> torrents;
+    for (auto i = m_readyTorrents.begin(); (i != m_readyTorrents.end()) && (torrents.size() < MAX_BATCH_SIZE);) {
+        torrents.insert(i.key(), i.value());
+        m_parsingTorrents.remove(i.key());
+        i = m_readyTorrents.erase(i);
+    }
+
+    if (!m_readyTorrents.isEmpty())
+        m_batchTimer.start();
+
+    if (!torrents.isEmpty())
+        emit torrentsAdded(torrents);
+}
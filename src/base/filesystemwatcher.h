@@ -32,14 +32,22 @@
 #include <QDir>
 #include <QFileSystemWatcher>
 #include <QHash>
+#include <QMutex>
+#include <QSet>
+#include <QThreadPool>
 #include <QTimer>
 #include <QVector>
 
+#include "base/bittorrent/torrentinfo.h"
+
 class QStringList;
 
 /*
  * Subclassing QFileSystemWatcher in order to support Network File
  * System watching (NFS, CIFS) on Linux and Mac OS.
+ *
+ * Torrent files are parsed in a thread pool and passed on already parsed,
+ * in limited batches so that adding lots of them doesn't block the event loop.
  */
 class FileSystemWatcher : public QFileSystemWatcher
 {
@@ -53,15 +61,27 @@ public:
     void removePath(const QString &path);
 
 signals:
-    void torrentsAdded(const QStringList &pathList);
+    // file path -> parsed torrent
+    void torrentsAdded(const QHash<QString, BitTorrent::TorrentInfo> &torrents);
+    void magnetFilesAdded(const QStringList &pathList);
 
 protected slots:
     void scanLocalFolder(const QString &path);
+    void scanPendingFolders();
     void processPartialTorrents();
     void scanNetworkFolders();
+    void processParsedTorrents();
+    void addReadyTorrents();
 
 private:
+    class Parser;
+
     void processTorrentsInDir(const QDir &dir);
+    void dropFolderTorrents(const QDir &dir);
+    bool isWatchedFile(const QString &path) const;
+    void parseTorrentFile(const QString &path);
+    // Called from parser threads
+    void handleTorrentParsed(const QString &path, const BitTorrent::TorrentInfo &torrentInfo);
 
     // Partial torrents
     QHash<QString, int> m_partialTorrents;
@@ -69,6 +89,20 @@ private:
 
     QVector<QDir> m_watchedFolders;
     QTimer m_watchTimer;
+
+    // Changes of local folders come in bursts, each folder is scanned once per burst
+    QSet<QString> m_pendingFolders;
+    QTimer m_scanTimer;
+
+    QSet<QString> m_parsingTorrents; // aren't passed on yet, so they are skipped by scans
+    QHash<QString, BitTorrent::TorrentInfo> m_readyTorrents;
+    QTimer m_batchTimer;
+
+    QMutex m_parsedTorrentsMutex;
+    QHash<QString, BitTorrent::TorrentInfo> m_parsedTorrents;
+
+    // Must be destroyed first to wait for running parsers
+    QThreadPool m_parsers;
 };
 
 #endif // FILESYSTEMWATCHER_H
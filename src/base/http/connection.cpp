@@ -59,6 +59,10 @@ void Connection::read()
     m_idleTimer.restart();
     m_receivedData.append(m_socket->readAll());
 
+    // requests must be answered in order so wait for the deferred one
+    if (m_deferral)
+        return;
+
     while (!m_receivedData.isEmpty()) {
         const RequestParser::ParseResult result = RequestParser::parse(m_receivedData);
 
@@ -94,6 +98,12 @@ void Connection::read()
                 const Environment env {m_socket->localAddress(), m_socket->localPort(), m_socket->peerAddress(), m_socket->peerPort()};
 
                 Response resp = m_requestHandler->processRequest(result.request, env);
+                if (resp.deferral) {
+                    // the request is kept in the buffer and processed again later
+                    m_deferral = resp.deferral;
+                    connect(m_deferral, &QObject::destroyed, this, &Connection::read, Qt::QueuedConnection);
+                    return;
+                }
 
                 if (acceptsGzipEncoding(result.request.headers["accept-encoding"]))
                     resp.headers[HEADER_CONTENT_ENCODING] = "gzip";
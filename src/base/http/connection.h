@@ -33,6 +33,7 @@
 
 #include <QElapsedTimer>
 #include <QObject>
+#include <QPointer>
 
 class QTcpSocket;
 
@@ -64,6 +65,7 @@ namespace Http
         IRequestHandler *m_requestHandler;
         QByteArray m_receivedData;
         QElapsedTimer m_idleTimer;
+        QPointer<QObject> m_deferral;
     };
 }
 
@@ -50,6 +50,11 @@ void ResponseBuilder::print(const QByteArray &data, const QString &type)
     print_impl(data, type);
 }
 
+void ResponseBuilder::defer(QObject *until)
+{
+    m_response.deferral = until;
+}
+
 void ResponseBuilder::clear()
 {
     m_response = Response();
@@ -31,6 +31,7 @@
 #define HTTP_TYPES_H
 
 #include <QHostAddress>
+#include <QPointer>
 #include <QString>
 #include <QVector>
 
@@ -41,6 +42,7 @@ namespace Http
     const char METHOD_GET[] = "GET";
     const char METHOD_POST[] = "POST";
 
+    const char HEADER_AUTHORIZATION[] = "authorization";
     const char HEADER_CACHE_CONTROL[] = "cache-control";
     const char HEADER_CONNECTION[] = "connection";
     const char HEADER_CONTENT_DISPOSITION[] = "content-disposition";
@@ -116,6 +118,9 @@ namespace Http
         ResponseStatus status;
         QStringMap headers;
         QByteArray content;
+        // Set by request handlers which can't respond right away. The connection
+        // submits the request again once this object is destroyed.
+        QPointer<QObject> deferral;
 
         Response(uint code = 200, const QString &text = "OK"): status(code, text) {}
     };
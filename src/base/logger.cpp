@@ -29,19 +29,108 @@
 #include "logger.h"
 
 #include <algorithm>
+#include <vector>
 
 #include <QDateTime>
 
+#include "global.h"
+
 namespace
 {
     template <typename T>
-    QVector<T> loadFromBuffer(const boost::circular_buffer_space_optimized<T> &src, const int offset = 0)
+    QVector<T> loadFromBuffer(const boost::circular_buffer_space_optimized<T> &src, const int first, const int last)
     {
         QVector<T> ret;
-        ret.reserve(src.size() - offset);
-        std::copy((src.begin() + offset), src.end(), std::back_inserter(ret));
+        ret.reserve(last - first);
+        std::copy((src.begin() + first), (src.begin() + last), std::back_inserter(ret));
         return ret;
     }
+
+    template <typename Node>
+    void deleteNodes(Node *node)
+    {
+        while (node) {
+            Node *next = node->next;
+            delete node;
+            node = next;
+        }
+    }
+
+    int typeSlot(const Log::MsgType type)
+    {
+        switch (type) {
+        case Log::INFO:
+            return 1;
+        case Log::WARNING:
+            return 2;
+        case Log::CRITICAL:
+            return 3;
+        default:
+            return 0;
+        }
+    }
+
+    // Detaches pending entries and returns them in the order they were added,
+    // with sequential ids assigned. Timestamps are made non-decreasing
+    // so that the buffers can be searched by time.
+    template <typename T, typename Node>
+    QVector<T> takePending(std::atomic<Node *> &pending, const boost::circular_buffer_space_optimized<T> &buffer, int &counter)
+    {
+        // producers push at the head, so reverse the detached list
+        Node *node = pending.exchange(nullptr);
+        Node *ordered = nullptr;
+        int count = 0;
+        while (node) {
+            Node *next = node->next;
+            node->next = ordered;
+            ordered = node;
+            node = next;
+            ++count;
+        }
+
+        qint64 lastTimestamp = buffer.empty() ? 0 : buffer.back().timestamp;
+        QVector<T> taken;
+        taken.reserve(count);
+        for (Node *item = ordered; item; item = item->next) {
+            item->entry.id = counter++;
+            item->entry.timestamp = std::max(item->entry.timestamp, lastTimestamp);
+            lastTimestamp = item->entry.timestamp;
+            taken.append(item->entry);
+        }
+        deleteNodes(ordered);
+
+        return taken;
+    }
+
+    // Returns the [first, last) range of ids matching the bounds of the query
+    template <typename T>
+    std::pair<int, int> idRange(const boost::circular_buffer_space_optimized<T> &buffer, const int counter, const Log::Query &query)
+    {
+        const int firstId = counter - static_cast<int>(buffer.size());
+
+        // lastKnownId comes from the client, it may be as large as INT_MAX
+        const int firstUnknownId = (query.lastKnownId < counter) ? (query.lastKnownId + 1) : counter;
+        int first = std::max(firstId, firstUnknownId);
+        int last = (query.beforeId >= 0) ? std::min(counter, query.beforeId) : counter;
+
+        if (query.minTimestamp >= 0) {
+            const auto it = std::lower_bound(buffer.begin(), buffer.end(), query.minTimestamp
+                , [](const T &entry, const qint64 timestamp) { return entry.timestamp < timestamp; });
+            first = std::max(first, (firstId + static_cast<int>(it - buffer.begin())));
+        }
+        if (query.maxTimestamp >= 0) {
+            const auto it = std::upper_bound(buffer.begin(), buffer.end(), query.maxTimestamp
+                , [](const qint64 timestamp, const T &entry) { return timestamp < entry.timestamp; });
+            last = std::min(last, (firstId + static_cast<int>(it - buffer.begin())));
+        }
+
+        return {first, last};
+    }
+
+    bool hasReachedLimit(const int count, const Log::Query &query)
+    {
+        return ((query.limit >= 0) && (count >= query.limit));
+    }
 }
 
 Logger *Logger::m_instance = nullptr;
@@ -49,8 +138,15 @@ Logger *Logger::m_instance = nullptr;
 Logger::Logger()
     : m_messages(MAX_LOG_MESSAGES)
     , m_peers(MAX_LOG_MESSAGES)
-    , m_lock(QReadWriteLock::Recursive)
 {
+    for (IdIndex &ids : m_msgIdsByType)
+        ids.set_capacity(MAX_LOG_MESSAGES);
+}
+
+Logger::~Logger()
+{
+    deleteNodes(m_pendingMessages.exchange(nullptr));
+    deleteNodes(m_pendingPeers.exchange(nullptr));
 }
 
 Logger *Logger::instance()
@@ -72,56 +168,154 @@ void Logger::freeInstance()
     }
 }
 
-void Logger::addMessage(const QString &message, const Log::MsgType &type)
+template <typename T>
+void Logger::enqueue(std::atomic<PendingNode<T> *> &pending, const T &entry)
 {
-    QWriteLocker locker(&m_lock);
+    auto *node = new PendingNode<T> {entry, pending.load(std::memory_order_relaxed)};
+    // on failure `node->next` is updated with the current head, so just retry
+    while (!pending.compare_exchange_weak(node->next, node, std::memory_order_release, std::memory_order_relaxed)) {}
 
-    const Log::Msg temp = {m_msgCounter++, QDateTime::currentMSecsSinceEpoch(), type, message.toHtmlEscaped()};
-    m_messages.push_back(temp);
+    scheduleFlush();
+}
 
-    emit newLogMessage(temp);
+void Logger::scheduleFlush()
+{
+    // coalesce all the entries added until the Logger's thread gets to them
+    if (!m_flushScheduled.exchange(true))
+        QMetaObject::invokeMethod(this, "flushPending", Qt::QueuedConnection);
+}
+
+void Logger::addMessage(const QString &message, const Log::MsgType &type)
+{
+    enqueue(m_pendingMessages, Log::Msg {-1, QDateTime::currentMSecsSinceEpoch(), type, message});
 }
 
 void Logger::addPeer(const QString &ip, const bool blocked, const QString &reason)
 {
-    QWriteLocker locker(&m_lock);
+    enqueue(m_pendingPeers, Log::Peer {-1, QDateTime::currentMSecsSinceEpoch(), ip, blocked, reason});
+}
+
+void Logger::flush()
+{
+    flushPending();
+}
 
-    const Log::Peer temp = {m_peerCounter++, QDateTime::currentMSecsSinceEpoch(), ip.toHtmlEscaped(), blocked, reason.toHtmlEscaped()};
-    m_peers.push_back(temp);
+void Logger::flushPending()
+{
+    // reset the flag before detaching the lists so that
+    // entries added from now on will schedule another flush
+    m_flushScheduled = false;
 
-    emit newLogPeer(temp);
+    QVector<Log::Msg> messages;
+    QVector<Log::Peer> peers;
+    {
+        QWriteLocker locker(&m_lock);
+
+        messages = takePending(m_pendingMessages, m_messages, m_msgCounter);
+        for (const Log::Msg &msg : asConst(messages))
+            storeMessage(msg);
+
+        peers = takePending(m_pendingPeers, m_peers, m_peerCounter);
+        for (const Log::Peer &peer : asConst(peers))
+            m_peers.push_back(peer);
+    }
+
+    if (!messages.isEmpty())
+        emit newLogMessages(messages);
+    if (!peers.isEmpty())
+        emit newLogPeers(peers);
 }
 
-QVector<Log::Msg> Logger::getMessages(const int lastKnownId) const
+void Logger::storeMessage(const Log::Msg &msg)
 {
-    QReadLocker locker(&m_lock);
+    // keep the type index in sync with the entries evicted from the buffer
+    if (m_messages.full())
+        m_msgIdsByType[typeSlot(m_messages.front().type)].pop_front();
 
-    const int diff = m_msgCounter - lastKnownId - 1;
-    const int size = m_messages.size();
+    m_messages.push_back(msg);
+    m_msgIdsByType[typeSlot(msg.type)].push_back(msg.id);
+}
 
-    if ((lastKnownId == -1) || (diff >= size))
-        return loadFromBuffer(m_messages);
+QVector<Log::Msg> Logger::getMessages(const Log::Query &query, const Log::MsgTypes &types) const
+{
+    QReadLocker locker(&m_lock);
 
-    if (diff <= 0)
+    const std::pair<int, int> range = idRange(m_messages, m_msgCounter, query);
+    if (range.first >= range.second)
         return {};
 
-    return loadFromBuffer(m_messages, (size - diff));
+    const int firstId = m_msgCounter - static_cast<int>(m_messages.size());
+    const auto isMatching = [&query](const Log::Msg &msg)
+    {
+        return (query.text.isEmpty() || msg.message.contains(query.text, Qt::CaseInsensitive));
+    };
+
+    const bool noFilter = query.text.isEmpty() && (query.limit < 0)
+        && types.testFlag(Log::NORMAL) && types.testFlag(Log::INFO)
+        && types.testFlag(Log::WARNING) && types.testFlag(Log::CRITICAL);
+    if (noFilter)
+        return loadFromBuffer(m_messages, (range.first - firstId), (range.second - firstId));
+
+    // Walk the selected per-type indexes backwards merging them by id,
+    // so that only the entries of the requested types are visited
+    // and the limit can be applied to the newest ones
+    std::vector<std::pair<const IdIndex *, IdIndex::const_iterator>> heads;
+    for (const Log::MsgType type : {Log::NORMAL, Log::INFO, Log::WARNING, Log::CRITICAL}) {
+        if (!types.testFlag(type)) continue;
+
+        const IdIndex &ids = m_msgIdsByType[typeSlot(type)];
+        heads.emplace_back(&ids, std::lower_bound(ids.begin(), ids.end(), range.second));
+    }
+
+    QVector<Log::Msg> ret;
+    while (!hasReachedLimit(ret.size(), query)) {
+        int nextId = -1;
+        IdIndex::const_iterator *nextHead = nullptr;
+        for (auto &head : heads) {
+            if (head.second == head.first->begin()) continue;
+
+            const int id = *(head.second - 1);
+            if ((id >= range.first) && (id > nextId)) {
+                nextId = id;
+                nextHead = &head.second;
+            }
+        }
+        if (!nextHead) break;
+
+        --(*nextHead);
+        const Log::Msg &msg = m_messages[nextId - firstId];
+        if (isMatching(msg))
+            ret.append(msg);
+    }
+
+    std::reverse(ret.begin(), ret.end());
+    return ret;
 }
 
-QVector<Log::Peer> Logger::getPeers(const int lastKnownId) const
+QVector<Log::Peer> Logger::getPeers(const Log::Query &query) const
 {
     QReadLocker locker(&m_lock);
 
-    const int diff = m_peerCounter - lastKnownId - 1;
-    const int size = m_peers.size();
+    const std::pair<int, int> range = idRange(m_peers, m_peerCounter, query);
+    if (range.first >= range.second)
+        return {};
 
-    if ((lastKnownId == -1) || (diff >= size))
-        return loadFromBuffer(m_peers);
+    const int firstId = m_peerCounter - static_cast<int>(m_peers.size());
+    if (query.text.isEmpty() && (query.limit < 0))
+        return loadFromBuffer(m_peers, (range.first - firstId), (range.second - firstId));
 
-    if (diff <= 0)
-        return {};
+    QVector<Log::Peer> ret;
+    for (int id = (range.second - 1); (id >= range.first) && !hasReachedLimit(ret.size(), query); --id) {
+        const Log::Peer &peer = m_peers[id - firstId];
+        if (query.text.isEmpty()
+            || peer.ip.contains(query.text, Qt::CaseInsensitive)
+            || peer.reason.contains(query.text, Qt::CaseInsensitive)) {
+            ret.append(peer);
+        }
+    }
 
-    return loadFromBuffer(m_peers, (size - diff));
+    std::reverse(ret.begin(), ret.end());
+    return ret;
 }
 
 void LogMsg(const QString &message, const Log::MsgType &type)
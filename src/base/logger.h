@@ -29,6 +29,9 @@
 #ifndef LOGGER_H
 #define LOGGER_H
 
+#include <array>
+#include <atomic>
+
 #include <boost/circular_buffer.hpp>
 
 #include <QObject>
@@ -66,6 +69,18 @@ namespace Log
         bool blocked;
         QString reason;
     };
+
+    // Selects a subset of the buffered entries.
+    // Entries are returned in ascending id (and timestamp) order.
+    struct Query
+    {
+        int lastKnownId = -1; // exclude entries with id <= lastKnownId
+        int beforeId = -1; // exclude entries with id >= beforeId, unless negative
+        qint64 minTimestamp = -1; // exclude older entries, unless negative
+        qint64 maxTimestamp = -1; // exclude newer entries, unless negative
+        QString text; // case insensitive substring to look for
+        int limit = -1; // keep only the newest `limit` matching entries, unless negative
+    };
 }
 
 Q_DECLARE_OPERATORS_FOR_FLAGS(Log::MsgTypes)
@@ -80,22 +95,52 @@ public:
     static void freeInstance();
     static Logger *instance();
 
+    // Thread-safe and lock-free. Entries are queued and published in batches
+    // from the Logger's thread. They are stored unescaped, so consumers
+    // displaying them as rich text must escape them themselves.
     void addMessage(const QString &message, const Log::MsgType &type = Log::NORMAL);
     void addPeer(const QString &ip, bool blocked, const QString &reason = {});
-    QVector<Log::Msg> getMessages(int lastKnownId = -1) const;
-    QVector<Log::Peer> getPeers(int lastKnownId = -1) const;
+    QVector<Log::Msg> getMessages(const Log::Query &query = {}, const Log::MsgTypes &types = Log::ALL) const;
+    QVector<Log::Peer> getPeers(const Log::Query &query = {}) const;
+
+    // Publishes pending entries immediately. Must be called from the Logger's thread.
+    void flush();
 
 signals:
-    void newLogMessage(const Log::Msg &message);
-    void newLogPeer(const Log::Peer &peer);
+    void newLogMessages(const QVector<Log::Msg> &messages);
+    void newLogPeers(const QVector<Log::Peer> &peers);
+
+private slots:
+    void flushPending();
 
 private:
+    template <typename T>
+    struct PendingNode
+    {
+        T entry;
+        PendingNode *next;
+    };
+
     Logger();
-    ~Logger() = default;
+    ~Logger();
+
+    using IdIndex = boost::circular_buffer_space_optimized<int>;
+
+    template <typename T>
+    void enqueue(std::atomic<PendingNode<T> *> &pending, const T &entry);
+    void scheduleFlush();
+    void storeMessage(const Log::Msg &msg);
 
     static Logger *m_instance;
+    // Entries added but not published yet, most recent first
+    std::atomic<PendingNode<Log::Msg> *> m_pendingMessages {nullptr};
+    std::atomic<PendingNode<Log::Peer> *> m_pendingPeers {nullptr};
+    std::atomic_bool m_flushScheduled {false};
+
     boost::circular_buffer_space_optimized<Log::Msg> m_messages;
     boost::circular_buffer_space_optimized<Log::Peer> m_peers;
+    // ids of the buffered messages, per message type
+    std::array<IdIndex, 4> m_msgIdsByType;
     mutable QReadWriteLock m_lock;
     int m_msgCounter = 0;
     int m_peerCounter = 0;
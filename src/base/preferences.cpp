@@ -62,7 +62,14 @@
 
 Preferences *Preferences::m_instance = nullptr;
 
-Preferences::Preferences() = default;
+Preferences::Preferences()
+    : m_hideZeroValues("Preferences/General/HideZeroValues", false)
+    , m_hideZeroComboValues("Preferences/General/HideZeroComboValues", 0)
+    , m_recheckTorrentsOnCompletion("Preferences/Advanced/RecheckOnCompletion", false)
+    , m_resolvePeerCountries("Preferences/Connection/ResolvePeerCountries", true)
+    , m_resolvePeerHostNames("Preferences/Connection/ResolvePeerHostNames", false)
+{
+}
 
 Preferences *Preferences::instance()
 {
@@ -168,22 +175,22 @@ void Preferences::setAlternatingRowColors(const bool b)
 
 bool Preferences::getHideZeroValues() const
 {
-    return value("Preferences/General/HideZeroValues", false).toBool();
+    return m_hideZeroValues;
 }
 
 void Preferences::setHideZeroValues(const bool b)
 {
-    setValue("Preferences/General/HideZeroValues", b);
+    m_hideZeroValues = b;
 }
 
 int Preferences::getHideZeroComboValues() const
 {
-    return value("Preferences/General/HideZeroComboValues", 0).toInt();
+    return m_hideZeroComboValues;
 }
 
 void Preferences::setHideZeroComboValues(const int n)
 {
-    setValue("Preferences/General/HideZeroComboValues", n);
+    m_hideZeroComboValues = n;
 }
 
 // In Mac OS X the dock is sufficient for our needs so we disable the sys tray functionality.
@@ -633,6 +640,26 @@ void Preferences::setWebUISessionTimeout(const int timeout)
     setValue("Preferences/WebUI/SessionTimeout", timeout);
 }
 
+QVariantMap Preferences::getWebUIAPITokens() const
+{
+    return value("Preferences/WebUI/APITokens").toMap();
+}
+
+void Preferences::setWebUIAPITokens(const QVariantMap &tokens)
+{
+    setValue("Preferences/WebUI/APITokens", tokens);
+}
+
+QByteArray Preferences::getWebUIAPITokenKey() const
+{
+    return value("Preferences/WebUI/APITokenKey").toByteArray();
+}
+
+void Preferences::setWebUIAPITokenKey(const QByteArray &key)
+{
+    setValue("Preferences/WebUI/APITokenKey", key);
+}
+
 bool Preferences::isWebUiClickjackingProtectionEnabled() const
 {
     return value("Preferences/WebUI/ClickjackingProtection", true).toBool();
@@ -856,32 +883,32 @@ void Preferences::setDontConfirmAutoExit(const bool dontConfirmAutoExit)
 
 bool Preferences::recheckTorrentsOnCompletion() const
 {
-    return value("Preferences/Advanced/RecheckOnCompletion", false).toBool();
+    return m_recheckTorrentsOnCompletion;
 }
 
 void Preferences::recheckTorrentsOnCompletion(const bool recheck)
 {
-    setValue("Preferences/Advanced/RecheckOnCompletion", recheck);
+    m_recheckTorrentsOnCompletion = recheck;
 }
 
 bool Preferences::resolvePeerCountries() const
 {
-    return value("Preferences/Connection/ResolvePeerCountries", true).toBool();
+    return m_resolvePeerCountries;
 }
 
 void Preferences::resolvePeerCountries(const bool resolve)
 {
-    setValue("Preferences/Connection/ResolvePeerCountries", resolve);
+    m_resolvePeerCountries = resolve;
 }
 
 bool Preferences::resolvePeerHostNames() const
 {
-    return value("Preferences/Connection/ResolvePeerHostNames", false).toBool();
+    return m_resolvePeerHostNames;
 }
 
 void Preferences::resolvePeerHostNames(const bool resolve)
 {
-    setValue("Preferences/Connection/ResolvePeerHostNames", resolve);
+    m_resolvePeerHostNames = resolve;
 }
 
 #if (defined(Q_OS_UNIX) && !defined(Q_OS_MAC))
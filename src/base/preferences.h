@@ -32,6 +32,7 @@
 
 #include <QList>
 
+#include "base/settingvalue.h"
 #include "base/utils/net.h"
 
 class QDateTime;
@@ -196,6 +197,10 @@ public:
     void setWebUIPassword(const QByteArray &password);
     int getWebUISessionTimeout() const;
     void setWebUISessionTimeout(int timeout);
+    QVariantMap getWebUIAPITokens() const;
+    void setWebUIAPITokens(const QVariantMap &tokens);
+    QByteArray getWebUIAPITokenKey() const;
+    void setWebUIAPITokenKey(const QByteArray &key);
 
     // WebUI security
     bool isWebUiClickjackingProtectionEnabled() const;
@@ -387,6 +392,14 @@ public slots:
     void setTrackerFilterState(bool checked);
 
     void apply();
+
+private:
+    // Settings read on hot paths (e.g. when painting every cell of a view)
+    LiveSettingValue<bool> m_hideZeroValues;
+    LiveSettingValue<int> m_hideZeroComboValues;
+    LiveSettingValue<bool> m_recheckTorrentsOnCompletion;
+    LiveSettingValue<bool> m_resolvePeerCountries;
+    LiveSettingValue<bool> m_resolvePeerHostNames;
 };
 
 #endif // PREFERENCES_H
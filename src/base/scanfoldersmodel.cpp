@@ -222,6 +222,7 @@ ScanFoldersModel::PathStatus ScanFoldersModel::addPath(const QString &watchPath,
     if (!m_fsWatcher) {
         m_fsWatcher = new FileSystemWatcher(this);
         connect(m_fsWatcher, &FileSystemWatcher::torrentsAdded, this, &ScanFoldersModel::addTorrentsToSession);
+        connect(m_fsWatcher, &FileSystemWatcher::magnetFilesAdded, this, &ScanFoldersModel::addMagnetsToSession);
     }
 
     beginInsertRows(QModelIndex(), rowCount(), rowCount());
@@ -349,40 +350,50 @@ void ScanFoldersModel::configure()
     }
 }
 
-void ScanFoldersModel::addTorrentsToSession(const QStringList &pathList)
+BitTorrent::AddTorrentParams ScanFoldersModel::addTorrentParams(const QString &filePath) const
+{
+    BitTorrent::AddTorrentParams params;
+    if (downloadInWatchFolder(filePath))
+        params.savePath = QFileInfo(filePath).dir().path();
+    else if (!downloadInDefaultFolder(filePath))
+        params.savePath = downloadPathTorrentFolder(filePath);
+    return params;
+}
+
+// Torrents come already parsed by the watcher
+void ScanFoldersModel::addTorrentsToSession(const QHash<QString, BitTorrent::TorrentInfo> &torrents)
+{
+    for (auto i = torrents.cbegin(); i != torrents.cend(); ++i) {
+        const QString &file = i.key();
+        // the folder could have been removed while the file was being parsed
+        if (findPathData(QFileInfo(file).dir().path()) == -1) continue;
+
+        qDebug("File %s added", qUtf8Printable(file));
+
+        BitTorrent::Session::instance()->addTorrent(i.value(), addTorrentParams(file));
+        Utils::Fs::forceRemove(file);
+    }
+}
+
+void ScanFoldersModel::addMagnetsToSession(const QStringList &pathList)
 {
     for (const QString &file : pathList) {
+        if (findPathData(QFileInfo(file).dir().path()) == -1) continue;
+
         qDebug("File %s added", qUtf8Printable(file));
 
-        BitTorrent::AddTorrentParams params;
-        if (downloadInWatchFolder(file))
-            params.savePath = QFileInfo(file).dir().path();
-        else if (!downloadInDefaultFolder(file))
-            params.savePath = downloadPathTorrentFolder(file);
-
-        if (file.endsWith(".magnet")) {
-            QFile f(file);
-            if (f.open(QIODevice::ReadOnly | QIODevice::Text)) {
-                QTextStream str(&f);
-                while (!str.atEnd())
-                    BitTorrent::Session::instance()->addTorrent(str.readLine(), params);
-
-                f.close();
-                Utils::Fs::forceRemove(file);
-            }
-            else {
-                qDebug("Failed to open magnet file: %s", qUtf8Printable(f.errorString()));
-            }
+        const BitTorrent::AddTorrentParams params = addTorrentParams(file);
+        QFile f(file);
+        if (f.open(QIODevice::ReadOnly | QIODevice::Text)) {
+            QTextStream str(&f);
+            while (!str.atEnd())
+                BitTorrent::Session::instance()->addTorrent(str.readLine(), params);
+
+            f.close();
+            Utils::Fs::forceRemove(file);
         }
         else {
-            const BitTorrent::TorrentInfo torrentInfo = BitTorrent::TorrentInfo::loadFromFile(file);
-            if (torrentInfo.isValid()) {
-                BitTorrent::Session::instance()->addTorrent(torrentInfo, params);
-                Utils::Fs::forceRemove(file);
-            }
-            else {
-                qDebug("Ignoring incomplete torrent file: %s", qUtf8Printable(file));
-            }
+            qDebug("Failed to open magnet file: %s", qUtf8Printable(f.errorString()));
         }
     }
 }
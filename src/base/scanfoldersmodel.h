@@ -30,12 +30,19 @@
 #define SCANFOLDERSMODEL_H
 
 #include <QAbstractListModel>
+#include <QHash>
 #include <QList>
 
 class QStringList;
 
 class FileSystemWatcher;
 
+namespace BitTorrent
+{
+    struct AddTorrentParams;
+    class TorrentInfo;
+}
+
 class ScanFoldersModel : public QAbstractListModel
 {
     Q_OBJECT
@@ -93,7 +100,8 @@ public slots:
     void configure();
 
 private slots:
-    void addTorrentsToSession(const QStringList &pathList);
+    void addTorrentsToSession(const QHash<QString, BitTorrent::TorrentInfo> &torrents);
+    void addMagnetsToSession(const QStringList &pathList);
 
 private:
     explicit ScanFoldersModel(QObject *parent = nullptr);
@@ -103,6 +111,7 @@ private:
     bool downloadInWatchFolder(const QString &filePath) const;
     bool downloadInDefaultFolder(const QString &filePath) const;
     QString downloadPathTorrentFolder(const QString &filePath) const;
+    BitTorrent::AddTorrentParams addTorrentParams(const QString &filePath) const;
     int findPathData(const QString &path) const;
 
     static ScanFoldersModel *m_instance;
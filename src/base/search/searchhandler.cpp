@@ -33,12 +33,15 @@
 #include <QTimer>
 
 #include "../global.h"
+#include "../logger.h"
 #include "../utils/foreignapps.h"
 #include "../utils/fs.h"
 #include "searchpluginmanager.h"
 
 namespace
 {
+    const int PLUGIN_SEARCH_TIMEOUT = 60000; // 1 min
+
     enum SearchResultColumn
     {
         PL_DL_LINK,
@@ -50,6 +53,15 @@ namespace
         PL_DESC_LINK,
         NB_PLUGIN_COLUMNS
     };
+
+    void stopProcess(QProcess *process)
+    {
+#ifdef Q_OS_WIN
+        process->kill();
+#else
+        process->terminate();
+#endif
+    }
 }
 
 SearchHandler::SearchHandler(const QString &pattern, const QString &category, const QStringList &usedPlugins, SearchPluginManager *manager)
@@ -58,116 +70,188 @@ SearchHandler::SearchHandler(const QString &pattern, const QString &category, co
     , m_category {category}
     , m_usedPlugins {usedPlugins}
     , m_manager {manager}
-    , m_searchProcess {new QProcess {this}}
-    , m_searchTimeout {new QTimer {this}}
 {
+    // deferred start allows clients to handle starting-related signals
+    QTimer::singleShot(0, this, [this]() { start(); });
+}
+
+bool SearchHandler::isActive() const
+{
+    return m_active;
+}
+
+void SearchHandler::cancelSearch()
+{
+    if (!m_active || m_searchCancelled)
+        return;
+
+    m_searchCancelled = true;
+    m_pendingPlugins.clear();
+    m_manager->cancelSearchJobs(this);
+    for (QProcess *process : asConst(m_runningJobs.keys()))
+        stopProcess(process);
+
+    checkFinished();
+}
+
+void SearchHandler::start()
+{
+    if (!m_active) return;
+
+    for (const QString &plugin : m_usedPlugins) {
+        QVector<SearchResult> cachedResults;
+        if (m_manager->cachedSearchResults(plugin, m_pattern, m_category, cachedResults))
+            addResults(cachedResults);
+        else
+            m_pendingPlugins.append(plugin);
+    }
+
+    for (int i = 0; i < m_pendingPlugins.size(); ++i)
+        m_manager->scheduleSearchJob(this);
+
+    checkFinished();
+}
+
+// Called by SearchPluginManager when there is room for one more job
+QProcess *SearchHandler::startNextJob()
+{
+    if (m_pendingPlugins.isEmpty())
+        return nullptr;
+
+    const QString plugin = m_pendingPlugins.takeFirst();
+
+    auto *process = new QProcess {this};
     // Load environment variables (proxy)
-    m_searchProcess->setEnvironment(QProcess::systemEnvironment());
+    process->setEnvironment(QProcess::systemEnvironment());
 
     const QStringList params {
         Utils::Fs::toNativePath(m_manager->engineLocation() + "/nova2.py"),
-        m_usedPlugins.join(','),
+        plugin,
         m_category
     };
+    process->setProgram(Utils::ForeignApps::pythonInfo().executableName);
+    process->setArguments(params + m_pattern.split(' '));
 
-    // Launch search
-    m_searchProcess->setProgram(Utils::ForeignApps::pythonInfo().executableName);
-    m_searchProcess->setArguments(params + m_pattern.split(' '));
+    auto *timeout = new QTimer {process};
+    timeout->setSingleShot(true);
+    connect(timeout, &QTimer::timeout, process, [process, plugin]()
+    {
+        LogMsg(tr("Search plugin '%1' did not respond in time, its results will be incomplete.").arg(plugin), Log::WARNING);
+        stopProcess(process);
+    });
 
-    connect(m_searchProcess, &QProcess::errorOccurred, this, &SearchHandler::processFailed);
-    connect(m_searchProcess, &QProcess::readyReadStandardOutput, this, &SearchHandler::readSearchOutput);
-    connect(m_searchProcess, qOverload<int, QProcess::ExitStatus>(&QProcess::finished)
-            , this, &SearchHandler::processFinished);
+    m_runningJobs.insert(process, {plugin, timeout, {}, {}});
 
-    m_searchTimeout->setSingleShot(true);
-    connect(m_searchTimeout, &QTimer::timeout, this, &SearchHandler::cancelSearch);
-    m_searchTimeout->start(180000); // 3 min
+    connect(process, &QProcess::readyReadStandardOutput, this, [this, process]() { readSearchOutput(process); });
+    connect(process, &QProcess::errorOccurred, this, [this, process](const QProcess::ProcessError error)
+    {
+        // finished() isn't emitted in this case
+        if (error == QProcess::FailedToStart)
+            jobFinished(process, false);
+    });
+    connect(process, qOverload<int, QProcess::ExitStatus>(&QProcess::finished), this
+            , [this, process](const int exitCode, const QProcess::ExitStatus exitStatus)
+    {
+        jobFinished(process, ((exitStatus == QProcess::NormalExit) && (exitCode == 0)));
+    });
 
-    // deferred start allows clients to handle starting-related signals
-    QTimer::singleShot(0, this, [this]() { m_searchProcess->start(QIODevice::ReadOnly); });
-}
+    timeout->start(PLUGIN_SEARCH_TIMEOUT);
+    process->start(QIODevice::ReadOnly);
 
-bool SearchHandler::isActive() const
-{
-    return (m_searchProcess->state() != QProcess::NotRunning);
+    return process;
 }
 
-void SearchHandler::cancelSearch()
+void SearchHandler::jobFinished(QProcess *process, const bool success)
 {
-    if ((m_searchProcess->state() == QProcess::NotRunning) || m_searchCancelled)
+    if (!m_runningJobs.contains(process))
         return;
 
-#ifdef Q_OS_WIN
-    m_searchProcess->kill();
-#else
-    m_searchProcess->terminate();
-#endif
-    m_searchCancelled = true;
-    m_searchTimeout->stop();
+    readSearchOutput(process);
+    const PluginJob job = m_runningJobs.take(process);
+    job.timeout->stop();
+    // SearchPluginManager starts the next job once the process is destroyed
+    process->deleteLater();
+
+    if (!m_searchCancelled) {
+        if (success)
+            m_manager->cacheSearchResults(job.plugin, m_pattern, m_category, job.results);
+        else
+            ++m_failedJobCount;
+    }
+
+    checkFinished();
 }
 
-// Slot called when QProcess is Finished
-// QProcess can be finished for 3 reasons:
-// Error | Stopped by user | Finished normally
-void SearchHandler::processFinished(const int exitcode)
+void SearchHandler::checkFinished()
 {
-    m_searchTimeout->stop();
+    if (!m_active || !m_pendingPlugins.isEmpty() || !m_runningJobs.isEmpty())
+        return;
 
+    m_active = false;
     if (m_searchCancelled)
         emit searchFinished(true);
-    else if ((m_searchProcess->exitStatus() == QProcess::NormalExit) && (exitcode == 0))
-        emit searchFinished(false);
-    else
+    else if ((m_failedJobCount > 0) && (m_failedJobCount == m_usedPlugins.size()))
         emit searchFailed();
+    else
+        emit searchFinished(false);
 }
 
 // search QProcess return output as soon as it gets new
 // stuff to read. We split it into lines and parse each
 // line to SearchResult calling parseSearchResult().
-void SearchHandler::readSearchOutput()
+void SearchHandler::readSearchOutput(QProcess *process)
 {
-    QByteArray output = m_searchProcess->readAllStandardOutput();
+    const auto jobIter = m_runningJobs.find(process);
+    if (jobIter == m_runningJobs.end())
+        return;
+
+    PluginJob &job = jobIter.value();
+
+    QByteArray output = process->readAllStandardOutput();
+    if (output.isEmpty())
+        return;
     output.replace('\r', "");
 
     QList<QByteArray> lines = output.split('\n');
-    if (!m_searchResultLineTruncated.isEmpty())
-        lines.prepend(m_searchResultLineTruncated + lines.takeFirst());
-    m_searchResultLineTruncated = lines.takeLast().trimmed();
+    if (!job.truncatedLine.isEmpty())
+        lines.prepend(job.truncatedLine + lines.takeFirst());
+    job.truncatedLine = lines.takeLast().trimmed();
 
     QVector<SearchResult> searchResultList;
     searchResultList.reserve(lines.size());
 
     for (const QByteArray &line : asConst(lines)) {
+        const QString lineStr = QString::fromUtf8(line);
         SearchResult searchResult;
-        if (parseSearchResult(QString::fromUtf8(line), searchResult))
+        if (parseSearchResult(QStringRef(&lineStr), searchResult))
             searchResultList << searchResult;
     }
 
-    if (!searchResultList.isEmpty()) {
-        for (const SearchResult &result : searchResultList)
-            m_results.append(result);
-        emit newSearchResults(searchResultList);
-    }
+    if (searchResultList.isEmpty()) return;
+
+    job.results += searchResultList;
+    addResults(searchResultList);
 }
 
-void SearchHandler::processFailed()
+void SearchHandler::addResults(const QVector<SearchResult> &results)
 {
-    if (!m_searchCancelled)
-        emit searchFailed();
+    const QVector<SearchResult> newResults = m_results.append(results);
+    if (!newResults.isEmpty())
+        emit newSearchResults(newResults);
 }
 
 // Parse one line of search results list
 // Line is in the following form:
 // file url | file name | file size | nb seeds | nb leechers | Search engine url
-bool SearchHandler::parseSearchResult(const QString &line, SearchResult &searchResult)
+bool SearchHandler::parseSearchResult(const QStringRef &line, SearchResult &searchResult)
 {
-    const QStringList parts = line.split('|');
+    const QVector<QStringRef> parts = line.split('|');
     const int nbFields = parts.size();
     if (nbFields < (NB_PLUGIN_COLUMNS - 1)) return false; // -1 because desc_link is optional
 
     searchResult = SearchResult();
-    searchResult.fileUrl = parts.at(PL_DL_LINK).trimmed(); // download URL
-    searchResult.fileName = parts.at(PL_NAME).trimmed(); // Name
+    searchResult.fileUrl = parts.at(PL_DL_LINK).trimmed().toString(); // download URL
+    searchResult.fileName = parts.at(PL_NAME).trimmed().toString(); // Name
     searchResult.fileSize = parts.at(PL_SIZE).trimmed().toLongLong(); // Size
     bool ok = false;
     searchResult.nbSeeders = parts.at(PL_SEEDS).trimmed().toLongLong(&ok); // Seeders
@@ -176,9 +260,9 @@ bool SearchHandler::parseSearchResult(const QString &line, SearchResult &searchR
     searchResult.nbLeechers = parts.at(PL_LEECHS).trimmed().toLongLong(&ok); // Leechers
     if (!ok || (searchResult.nbLeechers < 0))
         searchResult.nbLeechers = -1;
-    searchResult.siteUrl = parts.at(PL_ENGINE_URL).trimmed(); // Search site URL
+    searchResult.siteUrl = parts.at(PL_ENGINE_URL).trimmed().toString(); // Search site URL
     if (nbFields == NB_PLUGIN_COLUMNS)
-        searchResult.descrLink = parts.at(PL_DESC_LINK).trimmed(); // Description Link
+        searchResult.descrLink = parts.at(PL_DESC_LINK).trimmed().toString(); // Description Link
 
     return true;
 }
@@ -188,7 +272,7 @@ SearchPluginManager *SearchHandler::manager() const
     return m_manager;
 }
 
-QList<SearchResult> SearchHandler::results() const
+const SearchResultStore &SearchHandler::results() const
 {
     return m_results;
 }
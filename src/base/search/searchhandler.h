@@ -30,27 +30,23 @@
 #pragma once
 
 #include <QByteArray>
-#include <QList>
+#include <QHash>
 #include <QObject>
 #include <QString>
+#include <QStringList>
 #include <QVector>
 
+#include "searchresultstore.h"
+
 class QProcess;
 class QTimer;
 
-struct SearchResult
-{
-    QString fileName;
-    QString fileUrl;
-    qlonglong fileSize;
-    qlonglong nbSeeders;
-    qlonglong nbLeechers;
-    QString siteUrl;
-    QString descrLink;
-};
-
 class SearchPluginManager;
 
+// Runs a search using each of the selected plugins as a separate job.
+// Jobs are started by SearchPluginManager as soon as it has room for them,
+// and each of them is given its own timeout. Results of plugins that were
+// recently run with the same pattern and category are taken from the cache.
 class SearchHandler : public QObject
 {
     Q_OBJECT
@@ -65,28 +61,41 @@ public:
     bool isActive() const;
     QString pattern() const;
     SearchPluginManager *manager() const;
-    QList<SearchResult> results() const;
+    const SearchResultStore &results() const;
 
     void cancelSearch();
 
 signals:
     void searchFinished(bool cancelled = false);
     void searchFailed();
+    // only the results that weren't reported before
     void newSearchResults(const QVector<SearchResult> &results);
 
 private:
-    void readSearchOutput();
-    void processFailed();
-    void processFinished(int exitcode);
-    bool parseSearchResult(const QString &line, SearchResult &searchResult);
+    struct PluginJob
+    {
+        QString plugin;
+        QTimer *timeout;
+        QByteArray truncatedLine;
+        QVector<SearchResult> results;
+    };
+
+    void start();
+    QProcess *startNextJob();
+    void readSearchOutput(QProcess *process);
+    void jobFinished(QProcess *process, bool success);
+    void addResults(const QVector<SearchResult> &results);
+    void checkFinished();
+    bool parseSearchResult(const QStringRef &line, SearchResult &searchResult);
 
     const QString m_pattern;
     const QString m_category;
     const QStringList m_usedPlugins;
     SearchPluginManager *m_manager;
-    QProcess *m_searchProcess;
-    QTimer *m_searchTimeout;
-    QByteArray m_searchResultLineTruncated;
+    QStringList m_pendingPlugins;
+    QHash<QProcess *, PluginJob> m_runningJobs;
+    int m_failedJobCount = 0;
+    bool m_active = true;
     bool m_searchCancelled = false;
-    QList<SearchResult> m_results;
+    SearchResultStore m_results;
 };
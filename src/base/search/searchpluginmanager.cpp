@@ -29,8 +29,10 @@
 
 #include "searchpluginmanager.h"
 
+#include <algorithm>
 #include <memory>
 
+#include <QDateTime>
 #include <QDir>
 #include <QDirIterator>
 #include <QDomDocument>
@@ -52,6 +54,15 @@
 
 namespace
 {
+    const int MAX_CONCURRENT_SEARCH_JOBS = 8;
+    const qint64 SEARCH_RESULTS_CACHE_TTL = 5 * 60 * 1000; // 5 min
+    const int SEARCH_RESULTS_CACHE_SIZE = 100;
+
+    QString searchCacheKey(const QString &plugin, const QString &pattern, const QString &category)
+    {
+        return (plugin + '|' + category + '|' + pattern);
+    }
+
     void clearPythonCache(const QString &path)
     {
         // remove python cache artifacts in `path` and subdirs
@@ -316,6 +327,66 @@ SearchHandler *SearchPluginManager::startSearch(const QString &pattern, const QS
     return new SearchHandler {pattern, category, usedPlugins, this};
 }
 
+void SearchPluginManager::scheduleSearchJob(SearchHandler *handler)
+{
+    m_searchJobQueue.append(handler);
+    startSearchJobs();
+}
+
+void SearchPluginManager::cancelSearchJobs(SearchHandler *handler)
+{
+    m_searchJobQueue.removeAll(handler);
+}
+
+void SearchPluginManager::startSearchJobs()
+{
+    m_runningSearchJobs.erase(std::remove_if(m_runningSearchJobs.begin(), m_runningSearchJobs.end()
+        , [](const QPointer<QProcess> &process) { return process.isNull(); }), m_runningSearchJobs.end());
+
+    while ((m_runningSearchJobs.size() < MAX_CONCURRENT_SEARCH_JOBS) && !m_searchJobQueue.isEmpty()) {
+        const QPointer<SearchHandler> handler = m_searchJobQueue.takeFirst();
+        if (!handler) continue;
+
+        QProcess *process = handler->startNextJob();
+        if (!process) continue;
+
+        m_runningSearchJobs.append(process);
+        // the slot gets free once the job process is gone
+        connect(process, &QObject::destroyed, this, &SearchPluginManager::startSearchJobs, Qt::QueuedConnection);
+    }
+}
+
+bool SearchPluginManager::cachedSearchResults(const QString &plugin, const QString &pattern, const QString &category
+                                              , QVector<SearchResult> &results) const
+{
+    const auto it = m_searchResultsCache.constFind(searchCacheKey(plugin, pattern, category));
+    if ((it == m_searchResultsCache.cend()) || (it->expirationTime <= QDateTime::currentMSecsSinceEpoch()))
+        return false;
+
+    results = it->results;
+    return true;
+}
+
+void SearchPluginManager::cacheSearchResults(const QString &plugin, const QString &pattern, const QString &category
+                                             , const QVector<SearchResult> &results)
+{
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    for (auto it = m_searchResultsCache.begin(); it != m_searchResultsCache.end();) {
+        if (it->expirationTime <= now)
+            it = m_searchResultsCache.erase(it);
+        else
+            ++it;
+    }
+
+    if (m_searchResultsCache.size() >= SEARCH_RESULTS_CACHE_SIZE) {
+        const auto oldest = std::min_element(m_searchResultsCache.begin(), m_searchResultsCache.end()
+            , [](const CachedSearchResults &left, const CachedSearchResults &right) { return left.expirationTime < right.expirationTime; });
+        m_searchResultsCache.erase(oldest);
+    }
+
+    m_searchResultsCache.insert(searchCacheKey(plugin, pattern, category), {results, (now + SEARCH_RESULTS_CACHE_TTL)});
+}
+
 QString SearchPluginManager::categoryFullName(const QString &categoryName)
 {
     static const QHash<QString, QString> categoryTable {
@@ -30,10 +30,14 @@
 #pragma once
 
 #include <QHash>
+#include <QList>
 #include <QMetaType>
 #include <QObject>
+#include <QPointer>
+#include <QVector>
 
 #include "base/utils/version.h"
+#include "searchresultstore.h"
 
 using PluginVersion = Utils::Version<unsigned short, 2>;
 Q_DECLARE_METATYPE(PluginVersion)
@@ -54,6 +58,8 @@ struct PluginInfo
     bool enabled;
 };
 
+class QProcess;
+
 class SearchDownloadHandler;
 class SearchHandler;
 
@@ -62,6 +68,8 @@ class SearchPluginManager : public QObject
     Q_OBJECT
     Q_DISABLE_COPY(SearchPluginManager)
 
+    friend class SearchHandler;
+
 public:
     SearchPluginManager();
     ~SearchPluginManager() override;
@@ -103,6 +111,21 @@ signals:
     void checkForUpdatesFailed(const QString &reason);
 
 private:
+    struct CachedSearchResults
+    {
+        QVector<SearchResult> results;
+        qint64 expirationTime;
+    };
+
+    // Search jobs (one plugin run each) are shared between all running searches
+    void scheduleSearchJob(SearchHandler *handler);
+    void cancelSearchJobs(SearchHandler *handler);
+    void startSearchJobs();
+    bool cachedSearchResults(const QString &plugin, const QString &pattern, const QString &category
+                             , QVector<SearchResult> &results) const;
+    void cacheSearchResults(const QString &plugin, const QString &pattern, const QString &category
+                            , const QVector<SearchResult> &results);
+
     void update();
     void updateNova();
     void parseVersionInfo(const QByteArray &info);
@@ -119,4 +142,8 @@ private:
     const QString m_updateUrl;
 
     QHash<QString, PluginInfo*> m_plugins;
+
+    QList<QPointer<SearchHandler>> m_searchJobQueue;
+    QList<QPointer<QProcess>> m_runningSearchJobs;
+    QHash<QString, CachedSearchResults> m_searchResultsCache;
 };
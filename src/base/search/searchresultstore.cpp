@@ -0,0 +1,173 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2019  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#include "searchresultstore.h"
+
+#include <algorithm>
+#include <numeric>
+
+namespace
+{
+    QString resultKey(const SearchResult &result)
+    {
+        const QString &url = result.fileUrl;
+        if (url.startsWith(QLatin1String("magnet:"), Qt::CaseInsensitive)) {
+            const QLatin1String btihTag {"xt=urn:btih:"};
+            const int pos = url.indexOf(btihTag, 0, Qt::CaseInsensitive);
+            if (pos >= 0) {
+                const int start = pos + btihTag.size();
+                const int end = url.indexOf('&', start);
+                return url.mid(start, ((end < 0) ? -1 : (end - start))).toLower();
+            }
+        }
+
+        return url;
+    }
+}
+
+QVector<SearchResult> SearchResultStore::append(const QVector<SearchResult> &results)
+{
+    QVector<SearchResult> added;
+    added.reserve(results.size());
+
+    const int oldSize = m_results.size();
+    for (const SearchResult &result : results) {
+        const QString key = resultKey(result);
+        if (m_keys.contains(key)) {
+            ++m_duplicateCount;
+            continue;
+        }
+
+        m_keys.insert(key);
+        m_results.append(result);
+        added.append(result);
+    }
+
+    if (added.isEmpty() || m_sortIndexes.isEmpty())
+        return added;
+
+    // merge the new results into the existing sorted views
+    for (auto it = m_sortIndexes.begin(); it != m_sortIndexes.end(); ++it) {
+        const auto key = static_cast<SortKey>(it.key());
+        const auto compare = [this, key](const int left, const int right) { return lessThan(key, left, right); };
+
+        QVector<int> &index = it.value();
+        const int mergeStart = index.size();
+        for (int i = oldSize; i < m_results.size(); ++i)
+            index.append(i);
+        std::sort((index.begin() + mergeStart), index.end(), compare);
+        std::inplace_merge(index.begin(), (index.begin() + mergeStart), index.end(), compare);
+    }
+
+    return added;
+}
+
+int SearchResultStore::size() const
+{
+    return m_results.size();
+}
+
+int SearchResultStore::duplicateCount() const
+{
+    return m_duplicateCount;
+}
+
+const SearchResult &SearchResultStore::at(const int index) const
+{
+    return m_results.at(index);
+}
+
+// Keys are built on first use, for all the results at once
+const Utils::String::NaturalSortKey &SearchResultStore::nameSortKey(const int index) const
+{
+    if (index >= m_nameSortKeys.size()) {
+        m_nameSortKeys.reserve(m_results.size());
+        for (int i = m_nameSortKeys.size(); i < m_results.size(); ++i)
+            m_nameSortKeys.append({m_results[i].fileName, Qt::CaseInsensitive});
+    }
+
+    return m_nameSortKeys[index];
+}
+
+QVector<SearchResult> SearchResultStore::slice(const int offset, const int limit) const
+{
+    return m_results.mid(offset, limit);
+}
+
+QVector<SearchResult> SearchResultStore::sortedSlice(const SortKey key, const bool descending, const int offset, const int limit) const
+{
+    const QVector<int> &index = sortIndex(key);
+    const int size = index.size();
+    if ((offset < 0) || (offset >= size))
+        return {};
+
+    const int count = (limit < 0) ? (size - offset) : std::min(limit, (size - offset));
+    QVector<SearchResult> ret;
+    ret.reserve(count);
+    for (int i = offset; i < (offset + count); ++i)
+        ret.append(m_results[index[descending ? (size - i - 1) : i]]);
+
+    return ret;
+}
+
+const QVector<int> &SearchResultStore::sortIndex(const SortKey key) const
+{
+    auto it = m_sortIndexes.find(key);
+    if (it == m_sortIndexes.end()) {
+        QVector<int> index(m_results.size());
+        std::iota(index.begin(), index.end(), 0);
+        std::sort(index.begin(), index.end()
+            , [this, key](const int left, const int right) { return lessThan(key, left, right); });
+        it = m_sortIndexes.insert(key, index);
+    }
+
+    return it.value();
+}
+
+bool SearchResultStore::lessThan(const SortKey key, const int left, const int right) const
+{
+    const SearchResult &resultL = m_results[left];
+    const SearchResult &resultR = m_results[right];
+
+    switch (key) {
+    case SortByName: {
+            const int result = nameSortKey(left).compare(nameSortKey(right));
+            return (result != 0) ? (result < 0) : (left < right);
+        }
+    case SortBySize:
+        return (resultL.fileSize != resultR.fileSize) ? (resultL.fileSize < resultR.fileSize) : (left < right);
+    case SortBySeeders:
+        return (resultL.nbSeeders != resultR.nbSeeders) ? (resultL.nbSeeders < resultR.nbSeeders) : (left < right);
+    case SortByLeechers:
+        return (resultL.nbLeechers != resultR.nbLeechers) ? (resultL.nbLeechers < resultR.nbLeechers) : (left < right);
+    default: {
+            const int result = resultL.siteUrl.compare(resultR.siteUrl, Qt::CaseInsensitive);
+            return (result != 0) ? (result < 0) : (left < right);
+        }
+    }
+}
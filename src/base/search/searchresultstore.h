@@ -0,0 +1,86 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2019  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#pragma once
+
+#include <QHash>
+#include <QSet>
+#include <QString>
+#include <QVector>
+
+#include "base/utils/string.h"
+
+struct SearchResult
+{
+    QString fileName;
+    QString fileUrl;
+    qlonglong fileSize;
+    qlonglong nbSeeders;
+    qlonglong nbLeechers;
+    QString siteUrl;
+    QString descrLink;
+};
+
+// Append-only storage of the results of a search.
+// Results are deduplicated (by info hash for magnet links, by URL otherwise),
+// so the position of a result never changes and can be used as a cursor.
+// Sorted views are built on demand and then kept up to date incrementally.
+class SearchResultStore
+{
+public:
+    enum SortKey
+    {
+        SortByName,
+        SortBySize,
+        SortBySeeders,
+        SortByLeechers,
+        SortBySiteUrl
+    };
+
+    // Stores the results that aren't known yet and returns them
+    QVector<SearchResult> append(const QVector<SearchResult> &results);
+
+    int size() const;
+    int duplicateCount() const;
+    const SearchResult &at(int index) const;
+    const Utils::String::NaturalSortKey &nameSortKey(int index) const;
+
+    // Negative limit means "up to the end"
+    QVector<SearchResult> slice(int offset, int limit = -1) const;
+    QVector<SearchResult> sortedSlice(SortKey key, bool descending, int offset, int limit = -1) const;
+
+private:
+    const QVector<int> &sortIndex(SortKey key) const;
+    bool lessThan(SortKey key, int left, int right) const;
+
+    QVector<SearchResult> m_results;
+    QSet<QString> m_keys;
+    int m_duplicateCount = 0;
+    mutable QHash<int, QVector<int>> m_sortIndexes;
+    mutable QVector<Utils::String::NaturalSortKey> m_nameSortKeys;
+};
@@ -29,9 +29,13 @@
 
 #include "settingsstorage.h"
 
+#include <algorithm>
 #include <memory>
+
+#include <QCoreApplication>
 #include <QFile>
 #include <QHash>
+#include <QRunnable>
 
 #include "global.h"
 #include "logger.h"
@@ -148,23 +152,93 @@ namespace
 
         return keyMapping.value(key, key);
     }
+
+    const QString MAIN_STORE {QStringLiteral("qBittorrent")};
+
+    // Large values are kept in their own stores so that they aren't
+    // rewritten each time some other setting changes
+    const struct
+    {
+        const char *key;
+        const char *store;
+    } SEPARATE_STORES[] = {
+        {"Network/Cookies", "qBittorrent-cookies"},
+        {"Preferences/IPFilter/BannedIPs", "qBittorrent-bans"}
+    };
+
+    QString storeName(const QString &realKey)
+    {
+        for (const auto &separateStore : SEPARATE_STORES) {
+            if (realKey == QLatin1String(separateStore.key))
+                return QLatin1String(separateStore.store);
+        }
+        return MAIN_STORE;
+    }
+
+    // Writes the snapshots of settings stores in a worker thread
+    class SettingsWriter : public QRunnable
+    {
+    public:
+        SettingsWriter(SettingsStorage *storage, const QHash<QString, QVariantHash> &stores)
+            : m_storage(storage)
+            , m_stores(stores)
+        {
+        }
+
+        void run() override
+        {
+            QStringList failedStores;
+            for (auto i = m_stores.cbegin(); i != m_stores.cend(); ++i) {
+                if (!TransactionalSettings(i.key()).write(i.value()))
+                    failedStores << i.key();
+            }
+
+            QMetaObject::invokeMethod(m_storage, "handleWriteFinished", Qt::QueuedConnection
+                                      , Q_ARG(QStringList, failedStores));
+        }
+
+    private:
+        SettingsStorage *m_storage;
+        const QHash<QString, QVariantHash> m_stores;
+    };
 }
 
 SettingsStorage *SettingsStorage::m_instance = nullptr;
 
 SettingsStorage::SettingsStorage()
-    : m_data{TransactionalSettings(QLatin1String("qBittorrent")).read()}
-    , m_dirty(false)
+    : m_data{TransactionalSettings(MAIN_STORE).read()}
     , m_lock(QReadWriteLock::Recursive)
 {
+    for (const auto &separateStore : SEPARATE_STORES) {
+        const QString store = QLatin1String(separateStore.store);
+        // move the value stored by previous versions
+        if (m_data.contains(QLatin1String(separateStore.key)))
+            m_dirtyStores << MAIN_STORE << store;
+
+        const QVariantHash data = TransactionalSettings(store).read();
+        for (auto i = data.cbegin(); i != data.cend(); ++i)
+            m_data.insert(i.key(), i.value());
+    }
+
+    // writes must not overtake each other
+    m_writer.setMaxThreadCount(1);
+
     m_timer.setSingleShot(true);
     m_timer.setInterval(5 * 1000);
     connect(&m_timer, &QTimer::timeout, this, &SettingsStorage::save);
+    if (!m_dirtyStores.isEmpty())
+        m_timer.start();
 }
 
 SettingsStorage::~SettingsStorage()
 {
-    save();
+    m_writer.waitForDone();
+    // collect the results of background writes
+    QCoreApplication::sendPostedEvents(this, QEvent::MetaCall);
+
+    const QHash<QString, QVariantHash> stores = takeDirtyStores();
+    for (auto i = stores.cbegin(); i != stores.cend(); ++i)
+        TransactionalSettings(i.key()).write(i.value());
 }
 
 void SettingsStorage::initInstance()
@@ -186,18 +260,43 @@ SettingsStorage *SettingsStorage::instance()
 
 bool SettingsStorage::save()
 {
-    if (!m_dirty) return false; // Obtaining the lock is expensive, let's check early
+    if (m_dirtyStores.isEmpty()) return false; // Obtaining the lock is expensive, let's check early
+
+    QHash<QString, QVariantHash> stores = takeDirtyStores();
+    if (stores.isEmpty()) return false; // something might have changed while we were getting the lock
+
+    // Values are implicitly shared so the snapshot is cheap
+    // and serialization doesn't block the main thread
+    m_writer.start(new SettingsWriter(this, stores));
+    return true;
+}
+
+void SettingsStorage::handleWriteFinished(const QStringList &failedStores)
+{
+    if (failedStores.isEmpty())
+        return;
+
+    QWriteLocker locker(&m_lock);
+    for (const QString &store : failedStores)
+        m_dirtyStores.insert(store);
+    m_timer.start();
+}
+
+QHash<QString, QVariantHash> SettingsStorage::takeDirtyStores()
+{
     QWriteLocker locker(&m_lock);
-    if (!m_dirty) return false; // something might have changed while we were getting the lock
 
-    TransactionalSettings settings(QLatin1String("qBittorrent"));
-    if (settings.write(m_data)) {
-        m_dirty = false;
-        return true;
+    QHash<QString, QVariantHash> stores;
+    for (const QString &store : asConst(m_dirtyStores))
+        stores[store] = {};
+    for (auto i = m_data.cbegin(); i != m_data.cend(); ++i) {
+        const auto storeIter = stores.find(storeName(i.key()));
+        if (storeIter != stores.end())
+            storeIter.value().insert(i.key(), i.value());
     }
 
-    m_timer.start();
-    return false;
+    m_dirtyStores.clear();
+    return stores;
 }
 
 QVariant SettingsStorage::loadValue(const QString &key, const QVariant &defaultValue) const
@@ -209,23 +308,60 @@ QVariant SettingsStorage::loadValue(const QString &key, const QVariant &defaultV
 void SettingsStorage::storeValue(const QString &key, const QVariant &value)
 {
     const QString realKey = mapKey(key);
-    QWriteLocker locker(&m_lock);
-    if (m_data.value(realKey) != value) {
-        m_dirty = true;
+    {
+        QWriteLocker locker(&m_lock);
+        if (m_data.value(realKey) == value)
+            return;
+
+        m_dirtyStores.insert(storeName(realKey));
         m_data.insert(realKey, value);
         m_timer.start();
     }
+
+    notifyChanged(realKey);
 }
 
 void SettingsStorage::removeValue(const QString &key)
 {
     const QString realKey = mapKey(key);
-    QWriteLocker locker(&m_lock);
-    if (m_data.contains(realKey)) {
-        m_dirty = true;
+    {
+        QWriteLocker locker(&m_lock);
+        if (!m_data.contains(realKey))
+            return;
+
+        m_dirtyStores.insert(storeName(realKey));
         m_data.remove(realKey);
         m_timer.start();
     }
+
+    notifyChanged(realKey);
+}
+
+void SettingsStorage::addChangeHandler(const QString &key, const void *owner, const ChangeHandler &handler)
+{
+    m_changeHandlers[mapKey(key)].append({owner, handler});
+}
+
+void SettingsStorage::removeChangeHandler(const QString &key, const void *owner)
+{
+    const auto iter = m_changeHandlers.find(mapKey(key));
+    if (iter == m_changeHandlers.end())
+        return;
+
+    QVector<ChangeHandlerEntry> &handlers = iter.value();
+    handlers.erase(std::remove_if(handlers.begin(), handlers.end()
+        , [owner](const ChangeHandlerEntry &entry) { return (entry.owner == owner); })
+        , handlers.end());
+    if (handlers.isEmpty())
+        m_changeHandlers.erase(iter);
+}
+
+void SettingsStorage::notifyChanged(const QString &realKey) const
+{
+    // handlers may add or remove other handlers so iterate over a copy
+    const QVector<ChangeHandlerEntry> handlers = m_changeHandlers.value(realKey);
+    for (const ChangeHandlerEntry &entry : handlers)
+        entry.handler();
 }
 
 QVariantHash TransactionalSettings::read()
@@ -258,6 +394,12 @@ QVariantHash TransactionalSettings::read()
 
 bool TransactionalSettings::write(const QVariantHash &data)
 {
+    if (data.isEmpty()) {
+        // there would be no file to rename
+        const QString path = Profile::instance().applicationSettings(m_name)->fileName();
+        return (!QFile::exists(path) || Utils::Fs::forceRemove(path));
+    }
+
     // QSettings deletes the file before writing it out. This can result in problems
     // if the disk is full or a power outage occurs. Those events might occur
     // between deleting the file and recreating it. This is a safety measure.
@@ -30,9 +30,15 @@
 #ifndef SETTINGSSTORAGE_H
 #define SETTINGSSTORAGE_H
 
+#include <functional>
+
+#include <QHash>
 #include <QObject>
 #include <QReadWriteLock>
+#include <QSet>
+#include <QThreadPool>
 #include <QTimer>
+#include <QVector>
 #include <QVariantHash>
 
 class SettingsStorage : public QObject
@@ -50,16 +56,39 @@ public:
     void storeValue(const QString &key, const QVariant &value);
     void removeValue(const QString &key);
 
+    // Handlers are called each time the value of the key changes.
+    // They must be registered and values must be changed in the main thread.
+    using ChangeHandler = std::function<void ()>;
+    void addChangeHandler(const QString &key, const void *owner, const ChangeHandler &handler);
+    void removeChangeHandler(const QString &key, const void *owner);
+
 public slots:
+    // Starts writing the changed settings in background,
+    // returns false if there is nothing to write
     bool save();
 
+private slots:
+    void handleWriteFinished(const QStringList &failedStores);
+
 private:
+    void notifyChanged(const QString &realKey) const;
+    QHash<QString, QVariantHash> takeDirtyStores();
+
     static SettingsStorage *m_instance;
 
     QVariantHash m_data;
-    bool m_dirty;
+    // Settings are split between several files (stores), only the changed ones are written
+    QSet<QString> m_dirtyStores;
     QTimer m_timer;
+    QThreadPool m_writer;
     mutable QReadWriteLock m_lock;
+
+    struct ChangeHandlerEntry
+    {
+        const void *owner;
+        ChangeHandler handler;
+    };
+    QHash<QString, QVector<ChangeHandlerEntry>> m_changeHandlers;
 };
 
 #endif // SETTINGSSTORAGE_H
@@ -73,7 +73,7 @@ public:
         return *this;
     }
 
-private:
+protected:
     // regular load/save pair
     template <typename U, typename std::enable_if<!std::is_enum<U>::value, int>::type = 0>
     U loadValue(const U &defaultValue)
@@ -112,4 +112,41 @@ private:
     T m_value;
 };
 
+// Setting value which is kept up to date with SettingsStorage: it is reloaded
+// whenever its key gets a new value, no matter who stores it.
+// Reading it is a plain field access, so it suits settings read on hot paths.
+// Like SettingsStorage change notifications it is only meant for the main thread.
+template <typename T>
+class LiveSettingValue : public CachedSettingValue<T>
+{
+public:
+    explicit LiveSettingValue(const char *keyName, const T &defaultValue = T())
+        : CachedSettingValue<T>(keyName, defaultValue)
+        , m_defaultValue(defaultValue)
+    {
+        SettingsStorage::instance()->addChangeHandler(this->m_keyName, this, [this]()
+        {
+            this->m_value = this->loadValue(m_defaultValue);
+        });
+    }
+
+    ~LiveSettingValue()
+    {
+        if (SettingsStorage *storage = SettingsStorage::instance())
+            storage->removeChangeHandler(this->m_keyName, this);
+    }
+
+    LiveSettingValue(const LiveSettingValue &) = delete;
+    LiveSettingValue &operator=(const LiveSettingValue &) = delete;
+
+    LiveSettingValue<T> &operator=(const T &newValue)
+    {
+        CachedSettingValue<T>::operator=(newValue);
+        return *this;
+    }
+
+private:
+    const T m_defaultValue;
+};
+
 #endif // SETTINGVALUE_H
@@ -0,0 +1,107 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2019  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#include "bitarray.h"
+
+#include <cstring>
+
+#include <QBitArray>
+#include <QByteArray>
+#include <QtAlgorithms>
+
+namespace
+{
+    uchar reverseBits(uchar byte)
+    {
+        byte = ((byte & 0xF0) >> 4) | ((byte & 0x0F) << 4);
+        byte = ((byte & 0xCC) >> 2) | ((byte & 0x33) << 2);
+        byte = ((byte & 0xAA) >> 1) | ((byte & 0x55) << 1);
+        return byte;
+    }
+}
+
+QBitArray Utils::BitArray::fromMsbFirst(const char *data, const int size)
+{
+    if (size <= 0) return {};
+
+#if (QT_VERSION >= QT_VERSION_CHECK(5, 11, 0))
+    // QBitArray stores the first bit in the least significant bit of each byte
+    const int byteCount = (size + 7) / 8;
+    QByteArray lsbFirst(byteCount, Qt::Uninitialized);
+    for (int i = 0; i < byteCount; ++i)
+        lsbFirst[i] = static_cast<char>(reverseBits(static_cast<uchar>(data[i])));
+    if ((size % 8) != 0)
+        lsbFirst[byteCount - 1] = static_cast<char>(static_cast<uchar>(lsbFirst[byteCount - 1]) & ((1 << (size % 8)) - 1));
+
+    return QBitArray::fromBits(lsbFirst.constData(), size);
+#else
+    QBitArray result(size);
+    for (int i = 0; i < size; ++i) {
+        if (static_cast<uchar>(data[i / 8]) & (0x80 >> (i % 8)))
+            result.setBit(i);
+    }
+    return result;
+#endif
+}
+
+int Utils::BitArray::count(const QBitArray &bits, int from, const int to)
+{
+    Q_ASSERT((from >= 0) && (from <= to) && (to <= bits.size()));
+
+    int result = 0;
+
+#if (QT_VERSION >= QT_VERSION_CHECK(5, 11, 0))
+    const auto *data = reinterpret_cast<const uchar *>(bits.bits());
+
+    // leading bits up to the first byte boundary
+    for (; (from < to) && ((from % 8) != 0); ++from)
+        result += (data[from / 8] >> (from % 8)) & 1;
+
+    // whole bytes, a machine word at a time
+    int byte = from / 8;
+    const int endByte = to / 8;
+    for (; (byte + 8) <= endByte; byte += 8) {
+        quint64 word;
+        std::memcpy(&word, (data + byte), sizeof(word));
+        result += qPopulationCount(word);
+    }
+    for (; byte < endByte; ++byte)
+        result += qPopulationCount(static_cast<quint8>(data[byte]));
+
+    // trailing bits after the last byte boundary
+    for (int i = qMax((endByte * 8), from); i < to; ++i)
+        result += (data[i / 8] >> (i % 8)) & 1;
+#else
+    for (int i = from; i < to; ++i) {
+        if (bits.testBit(i))
+            ++result;
+    }
+#endif
+
+    return result;
+}
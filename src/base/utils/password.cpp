@@ -31,6 +31,7 @@
 #include <array>
 
 #include <openssl/evp.h>
+#include <openssl/hmac.h>
 
 #include <QByteArray>
 #include <QString>
@@ -64,6 +65,19 @@ bool Utils::Password::slowEquals(const QByteArray &a, const QByteArray &b)
     return (diff == 0);
 }
 
+QByteArray Utils::Password::hmacSha256(const QByteArray &key, const QByteArray &message)
+{
+    std::array<unsigned char, EVP_MAX_MD_SIZE> outBuf {};
+    unsigned int outSize = 0;
+    const unsigned char *result = HMAC(EVP_sha256(), key.constData(), key.size()
+        , reinterpret_cast<const unsigned char *>(message.constData()), static_cast<size_t>(message.size())
+        , outBuf.data(), &outSize);
+    if (!result)
+        return {};
+
+    return QByteArray(reinterpret_cast<const char *>(outBuf.data()), static_cast<int>(outSize));
+}
+
 QByteArray Utils::Password::PBKDF2::generate(const QString &password)
 {
     return generate(password.toUtf8());
@@ -39,6 +39,10 @@ namespace Utils
         // Taken from https://crackstation.net/hashing-security.htm
         bool slowEquals(const QByteArray &a, const QByteArray &b);
 
+        // Fast keyed hash, only suitable for high entropy secrets (e.g. random tokens)
+        // that don't need key stretching
+        QByteArray hmacSha256(const QByteArray &key, const QByteArray &message);
+
         namespace PBKDF2
         {
             QByteArray generate(const QString &password);
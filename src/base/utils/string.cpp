@@ -29,20 +29,31 @@
 
 #include "string.h"
 
+#include <algorithm>
 #include <cmath>
+#include <cstring>
+#include <utility>
 
 #include <QCollator>
 #include <QLocale>
 #include <QRegExp>
+#include <QStringList>
 #include <QtGlobal>
 #ifdef Q_OS_MAC
 #include <QThreadStorage>
 #endif
 
+#include "../global.h"
 #include "../tristatebool.h"
 
 namespace
 {
+    // Only ASCII digits form numbers, other scripts' digits are compared like any other character
+    bool isNumberDigit(const QChar c)
+    {
+        return ((c >= QLatin1Char('0')) && (c <= QLatin1Char('9')));
+    }
+
     class NaturalCompare
     {
     public:
@@ -71,6 +82,52 @@ namespace
 #endif
         }
 
+#ifdef Q_OS_WIN
+        // Encodes the string so that comparing the keys bytewise gives the same result as `compare()`.
+        // Every character is stored as big endian UTF-16 code unit, an ASCII digit sequence is stored as
+        // '0' followed by the sequence length and the digits themselves, so that it sorts against
+        // other characters like a digit does while longer numbers sort after shorter ones.
+        QByteArray sortKey(const QString &str) const
+        {
+            QByteArray key;
+            key.reserve(str.size() * 2);
+
+            const auto appendChar = [&key](const QChar c)
+            {
+                key.append(static_cast<char>(c.row()));
+                key.append(static_cast<char>(c.cell()));
+            };
+
+            int pos = 0;
+            while (pos < str.size()) {
+                const QChar c = str[pos];
+                if (!isNumberDigit(c)) {
+                    appendChar((m_caseSensitivity == Qt::CaseSensitive) ? c : c.toLower());
+                    ++pos;
+                    continue;
+                }
+
+                int end = pos;
+                while ((end < str.size()) && isNumberDigit(str[end]))
+                    ++end;
+
+                const quint32 length = end - pos;
+                appendChar(QLatin1Char('0'));
+                for (int shift = 24; shift >= 0; shift -= 8)
+                    key.append(static_cast<char>((length >> shift) & 0xFF));
+                for (; pos < end; ++pos)
+                    appendChar(str[pos]);
+            }
+
+            return key;
+        }
+#else
+        QCollatorSortKey sortKey(const QString &str) const
+        {
+            return m_collator.sortKey(str);
+        }
+#endif
+
     private:
         int compare(const QString &left, const QString &right) const
         {
@@ -89,18 +146,18 @@ namespace
                 // Compare only non-digits.
                 // Numbers should be compared as a whole
                 // otherwise the string->int conversion can yield a wrong value
-                if ((leftChar == rightChar) && !leftChar.isDigit()) {
+                if ((leftChar == rightChar) && !isNumberDigit(leftChar)) {
                     // compare next character
                     ++posL;
                     ++posR;
                 }
-                else if (leftChar.isDigit() && rightChar.isDigit()) {
+                else if (isNumberDigit(leftChar) && isNumberDigit(rightChar)) {
                     // Both are digits, compare the numbers
 
                     const auto numberView = [](const QString &str, int &pos) -> QStringRef
                     {
                         const int start = pos;
-                        while ((pos < str.size()) && str[pos].isDigit())
+                        while ((pos < str.size()) && isNumberDigit(str[pos]))
                             ++pos;
                         return str.midRef(start, (pos - start));
                     };
@@ -134,33 +191,77 @@ namespace
     };
 }
 
-int Utils::String::naturalCompare(const QString &left, const QString &right, const Qt::CaseSensitivity caseSensitivity)
+namespace
 {
     // provide a single `NaturalCompare` instance for easy use
     // https://doc.qt.io/qt-5/threads-reentrancy.html
-    if (caseSensitivity == Qt::CaseSensitive) {
+    const NaturalCompare &naturalComparator(const Qt::CaseSensitivity caseSensitivity)
+    {
+        if (caseSensitivity == Qt::CaseSensitive) {
 #ifdef Q_OS_MAC  // workaround for Apple xcode: https://stackoverflow.com/a/29929949
+            static QThreadStorage<NaturalCompare> nCmp;
+            if (!nCmp.hasLocalData())
+                nCmp.setLocalData(NaturalCompare(Qt::CaseSensitive));
+            return nCmp.localData();
+#else
+            thread_local NaturalCompare nCmp(Qt::CaseSensitive);
+            return nCmp;
+#endif
+        }
+
+#ifdef Q_OS_MAC
         static QThreadStorage<NaturalCompare> nCmp;
         if (!nCmp.hasLocalData())
-            nCmp.setLocalData(NaturalCompare(Qt::CaseSensitive));
-        return (nCmp.localData())(left, right);
+            nCmp.setLocalData(NaturalCompare(Qt::CaseInsensitive));
+        return nCmp.localData();
 #else
-        thread_local NaturalCompare nCmp(Qt::CaseSensitive);
-        return nCmp(left, right);
+        thread_local NaturalCompare nCmp(Qt::CaseInsensitive);
+        return nCmp;
 #endif
     }
+}
 
-#ifdef Q_OS_MAC
-    static QThreadStorage<NaturalCompare> nCmp;
-    if (!nCmp.hasLocalData())
-        nCmp.setLocalData(NaturalCompare(Qt::CaseInsensitive));
-    return (nCmp.localData())(left, right);
+int Utils::String::naturalCompare(const QString &left, const QString &right, const Qt::CaseSensitivity caseSensitivity)
+{
+    return naturalComparator(caseSensitivity)(left, right);
+}
+
+Utils::String::NaturalSortKey::NaturalSortKey(const QString &str, const Qt::CaseSensitivity caseSensitivity)
+    : m_key(naturalComparator(caseSensitivity).sortKey(str))
+{
+}
+
+int Utils::String::NaturalSortKey::compare(const NaturalSortKey &other) const
+{
+#ifdef Q_OS_WIN
+    // the keys contain zero bytes so they can't be compared as C strings
+    const int result = std::memcmp(m_key.constData(), other.m_key.constData(), std::min(m_key.size(), other.m_key.size()));
+    return (result != 0) ? result : (m_key.size() - other.m_key.size());
 #else
-    thread_local NaturalCompare nCmp(Qt::CaseInsensitive);
-    return nCmp(left, right);
+    // a default constructed key sorts before any other key
+    if (!m_key || !other.m_key)
+        return (m_key ? 1 : 0) - (other.m_key ? 1 : 0);
+    return m_key->compare(*other.m_key);
 #endif
 }
 
+void Utils::String::naturalSort(QStringList &strings, const Qt::CaseSensitivity caseSensitivity)
+{
+    QVector<std::pair<NaturalSortKey, QString>> keyed;
+    keyed.reserve(strings.size());
+    for (const QString &str : asConst(strings))
+        keyed.append({NaturalSortKey(str, caseSensitivity), str});
+
+    std::sort(keyed.begin(), keyed.end()
+        , [](const std::pair<NaturalSortKey, QString> &left, const std::pair<NaturalSortKey, QString> &right)
+    {
+        return (left.first < right.first);
+    });
+
+    for (int i = 0; i < keyed.size(); ++i)
+        strings[i] = keyed[i].second;
+}
+
 // to send numbers instead of strings with suffixes
 QString Utils::String::fromDouble(const double n, const int precision)
 {
@@ -30,10 +30,18 @@
 #ifndef UTILS_STRING_H
 #define UTILS_STRING_H
 
+#include <QtGlobal>
+#ifdef Q_OS_WIN
+#include <QByteArray>
+#else
+#include <boost/optional.hpp>
+#include <QCollatorSortKey>
+#endif
 #include <QLatin1String>
 #include <QVector>
 
 class QString;
+class QStringList;
 class QStringRef;
 
 class TriStateBool;
@@ -51,6 +59,34 @@ namespace Utils
             return (naturalCompare(left, right, caseSensitivity) < 0);
         }
 
+        // Precomputed form of a string for naturalCompare().
+        // Comparing two keys yields the same result as comparing the strings
+        // they were built from, but it is much cheaper, so it pays off to keep
+        // the keys of the strings that get compared repeatedly (e.g. sorted).
+        class NaturalSortKey
+        {
+        public:
+            NaturalSortKey() = default;
+            NaturalSortKey(const QString &str, Qt::CaseSensitivity caseSensitivity);
+
+            int compare(const NaturalSortKey &other) const;
+
+        private:
+#ifdef Q_OS_WIN
+            QByteArray m_key;
+#else
+            boost::optional<QCollatorSortKey> m_key;
+#endif
+        };
+
+        inline bool operator<(const NaturalSortKey &left, const NaturalSortKey &right)
+        {
+            return (left.compare(right) < 0);
+        }
+
+        // Same as sorting with naturalLessThan() but builds the sort key of each string only once
+        void naturalSort(QStringList &strings, Qt::CaseSensitivity caseSensitivity);
+
         QString wildcardToRegex(const QString &pattern);
 
         template <typename T>
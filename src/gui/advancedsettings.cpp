@@ -70,6 +70,7 @@ enum AdvSettingsRows
     SAVE_RESUME_DATA_INTERVAL,
     CONFIRM_RECHECK_TORRENT,
     RECHECK_COMPLETED,
+    STRUCTURED_LOG,
 #if defined(Q_OS_WIN) || defined(Q_OS_MAC)
     UPDATE_CHECK,
 #endif
@@ -107,6 +108,8 @@ enum AdvSettingsRows
     OUTGOING_PORT_MAX,
     UTP_MIX_MODE,
     MULTI_CONNECTIONS_PER_IP,
+    PEER_AUTO_BAN,
+    PEER_AUTO_BAN_THRESHOLD,
     // embedded tracker
     TRACKER_STATUS,
     TRACKER_PORT,
@@ -184,8 +187,13 @@ void AdvancedSettings::saveAdvancedSettings()
     session->setUtpMixedMode(static_cast<BitTorrent::MixedModeAlgorithm>(m_comboBoxUtpMixedMode.currentIndex()));
     // multiple connections per IP
     session->setMultiConnectionsPerIpEnabled(m_checkBoxMultiConnectionsPerIp.isChecked());
+    // Automatic peer banning
+    session->setPeerAutoBanEnabled(m_checkBoxPeerAutoBan.isChecked());
+    session->setPeerAutoBanThreshold(m_spinBoxPeerAutoBanThreshold.value());
     // Recheck torrents on completion
     pref->recheckTorrentsOnCompletion(m_checkBoxRecheckCompleted.isChecked());
+    // Structured log
+    static_cast<Application *>(QCoreApplication::instance())->setFileLoggerJsonEnabled(m_checkBoxStructuredLog.isChecked());
     // Transfer list refresh interval
     session->setRefreshInterval(m_spinBoxListRefresh.value());
     // Peer resolution
@@ -437,9 +445,19 @@ void AdvancedSettings::loadAdvancedSettings()
     // multiple connections per IP
     m_checkBoxMultiConnectionsPerIp.setChecked(session->multiConnectionsPerIpEnabled());
     addRow(MULTI_CONNECTIONS_PER_IP, tr("Allow multiple connections from the same IP address"), &m_checkBoxMultiConnectionsPerIp);
+    // Automatic peer banning
+    m_checkBoxPeerAutoBan.setChecked(session->isPeerAutoBanEnabled());
+    addRow(PEER_AUTO_BAN, tr("Permanently ban peers that repeatedly send corrupt data"), &m_checkBoxPeerAutoBan);
+    m_spinBoxPeerAutoBanThreshold.setMinimum(1);
+    m_spinBoxPeerAutoBanThreshold.setMaximum(100);
+    m_spinBoxPeerAutoBanThreshold.setValue(session->peerAutoBanThreshold());
+    addRow(PEER_AUTO_BAN_THRESHOLD, tr("Corrupt data bans before permanent ban"), &m_spinBoxPeerAutoBanThreshold);
     // Recheck completed torrents
     m_checkBoxRecheckCompleted.setChecked(pref->recheckTorrentsOnCompletion());
     addRow(RECHECK_COMPLETED, tr("Recheck torrents on completion"), &m_checkBoxRecheckCompleted);
+    // Structured log
+    m_checkBoxStructuredLog.setChecked(static_cast<Application *>(QCoreApplication::instance())->isFileLoggerJsonEnabled());
+    addRow(STRUCTURED_LOG, tr("Also write log file in JSON lines format"), &m_checkBoxStructuredLog);
     // Transfer list refresh interval
     m_spinBoxListRefresh.setMinimum(30);
     m_spinBoxListRefresh.setMaximum(99999);
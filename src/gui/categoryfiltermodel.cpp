@@ -391,39 +391,33 @@ void CategoryFilterModel::populate()
     const QString UID_ALL;
     const QString UID_UNCATEGORIZED(QChar(1));
 
+    // Count torrents in a single pass, parent categories
+    // sum up the counts of their subcategories themselves
+    QHash<QString, int> categoryCounts;
+    for (const BitTorrent::TorrentHandle *torrent : torrents)
+        ++categoryCounts[torrent->category()];
+
     // All torrents
     m_rootItem->addChild(UID_ALL, new CategoryModelItem(nullptr, tr("All"), torrents.count()));
 
     // Uncategorized torrents
-    using Torrent = BitTorrent::TorrentHandle;
     m_rootItem->addChild(
                 UID_UNCATEGORIZED
-                , new CategoryModelItem(
-                    nullptr, tr("Uncategorized")
-                    , std::count_if(torrents.begin(), torrents.end()
-                                    , [](Torrent *torrent) { return torrent->category().isEmpty(); })));
+                , new CategoryModelItem(nullptr, tr("Uncategorized"), categoryCounts.value(QString())));
 
-    using Torrent = BitTorrent::TorrentHandle;
     for (auto i = session->categories().cbegin(); i != session->categories().cend(); ++i) {
         const QString &category = i.key();
         if (m_isSubcategoriesEnabled) {
             CategoryModelItem *parent = m_rootItem;
             for (const QString &subcat : asConst(session->expandCategory(category))) {
                 const QString subcatName = shortName(subcat);
-                if (!parent->hasChild(subcatName)) {
-                    new CategoryModelItem(
-                                parent, subcatName
-                                , std::count_if(torrents.cbegin(), torrents.cend()
-                                                , [subcat](Torrent *torrent) { return torrent->category() == subcat; }));
-                }
+                if (!parent->hasChild(subcatName))
+                    new CategoryModelItem(parent, subcatName, categoryCounts.value(subcat));
                 parent = parent->child(subcatName);
             }
         }
         else {
-            new CategoryModelItem(
-                        m_rootItem, category
-                        , std::count_if(torrents.begin(), torrents.end()
-                                        , [category](Torrent *torrent) { return torrent->belongsToCategory(category); }));
+            new CategoryModelItem(m_rootItem, category, categoryCounts.value(category));
         }
     }
 }
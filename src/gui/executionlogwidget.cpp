@@ -31,7 +31,6 @@
 #include <QDateTime>
 #include <QPalette>
 
-#include "base/global.h"
 #include "loglistwidget.h"
 #include "ui_executionlogwidget.h"
 #include "uithememanager.h"
@@ -52,12 +51,10 @@ ExecutionLogWidget::ExecutionLogWidget(QWidget *parent, const Log::MsgTypes &typ
     m_ui->tabBan->layout()->addWidget(m_peerList);
 
     const Logger *const logger = Logger::instance();
-    for (const Log::Msg &msg : asConst(logger->getMessages()))
-        addLogMessage(msg);
-    for (const Log::Peer &peer : asConst(logger->getPeers()))
-        addPeerMessage(peer);
-    connect(logger, &Logger::newLogMessage, this, &ExecutionLogWidget::addLogMessage);
-    connect(logger, &Logger::newLogPeer, this, &ExecutionLogWidget::addPeerMessage);
+    addLogMessages(logger->getMessages());
+    addPeerMessages(logger->getPeers());
+    connect(logger, &Logger::newLogMessages, this, &ExecutionLogWidget::addLogMessages);
+    connect(logger, &Logger::newLogPeers, this, &ExecutionLogWidget::addPeerMessages);
 }
 
 ExecutionLogWidget::~ExecutionLogWidget()
@@ -70,6 +67,22 @@ void ExecutionLogWidget::showMsgTypes(const Log::MsgTypes &types)
     m_msgList->showMsgTypes(types);
 }
 
+void ExecutionLogWidget::addLogMessages(const QVector<Log::Msg> &messages)
+{
+    m_msgList->setUpdatesEnabled(false);
+    for (const Log::Msg &msg : messages)
+        addLogMessage(msg);
+    m_msgList->setUpdatesEnabled(true);
+}
+
+void ExecutionLogWidget::addPeerMessages(const QVector<Log::Peer> &peers)
+{
+    m_peerList->setUpdatesEnabled(false);
+    for (const Log::Peer &peer : peers)
+        addPeerMessage(peer);
+    m_peerList->setUpdatesEnabled(true);
+}
+
 void ExecutionLogWidget::addLogMessage(const Log::Msg &msg)
 {
     QString colorName;
@@ -89,7 +102,7 @@ void ExecutionLogWidget::addLogMessage(const Log::Msg &msg)
 
     const QDateTime time = QDateTime::fromMSecsSinceEpoch(msg.timestamp);
     const QString text = QString(QLatin1String("<font color='grey'>%1</font> - <font color='%2'>%3</font>"))
-        .arg(time.toString(Qt::SystemLocaleShortDate), colorName, msg.message);
+        .arg(time.toString(Qt::SystemLocaleShortDate), colorName, msg.message.toHtmlEscaped());
     m_msgList->appendLine(text, msg.type);
 }
 
@@ -97,10 +110,10 @@ void ExecutionLogWidget::addPeerMessage(const Log::Peer &peer)
 {
     const QDateTime time = QDateTime::fromMSecsSinceEpoch(peer.timestamp);
     const QString msg = QString(QLatin1String("<font color='grey'>%1</font> - <font color='red'>%2</font>"))
-        .arg(time.toString(Qt::SystemLocaleShortDate), peer.ip);
+        .arg(time.toString(Qt::SystemLocaleShortDate), peer.ip.toHtmlEscaped());
 
     const QString text = peer.blocked
-        ? tr("%1 was blocked %2", "0.0.0.0 was blocked due to reason").arg(msg, peer.reason)
+        ? tr("%1 was blocked %2", "0.0.0.0 was blocked due to reason").arg(msg, peer.reason.toHtmlEscaped())
         : tr("%1 was banned", "0.0.0.0 was banned").arg(msg);
     m_peerList->appendLine(text, Log::NORMAL);
 }
@@ -49,10 +49,13 @@ public:
     ~ExecutionLogWidget();
 
 private slots:
+    void addLogMessages(const QVector<Log::Msg> &messages);
+    void addPeerMessages(const QVector<Log::Peer> &peers);
+
+private:
     void addLogMessage(const Log::Msg &msg);
     void addPeerMessage(const Log::Peer &peer);
 
-private:
     Ui::ExecutionLogWidget *m_ui;
 
     LogListWidget *m_msgList;
@@ -40,6 +40,7 @@ HEADERS += \
     $$PWD/search/pluginsourcedialog.h \
     $$PWD/search/searchjobwidget.h \
     $$PWD/search/searchlistdelegate.h \
+    $$PWD/search/searchresultsmodel.h \
     $$PWD/search/searchsortmodel.h \
     $$PWD/search/searchwidget.h \
     $$PWD/shutdownconfirmdialog.h \
@@ -52,8 +53,6 @@ HEADERS += \
     $$PWD/torrentcategorydialog.h \
     $$PWD/torrentcontentfiltermodel.h \
     $$PWD/torrentcontentmodel.h \
-    $$PWD/torrentcontentmodelfile.h \
-    $$PWD/torrentcontentmodelfolder.h \
     $$PWD/torrentcontentmodelitem.h \
     $$PWD/torrentcontenttreeview.h \
     $$PWD/torrentcreatordialog.h \
@@ -103,6 +102,7 @@ SOURCES += \
     $$PWD/search/pluginsourcedialog.cpp \
     $$PWD/search/searchjobwidget.cpp \
     $$PWD/search/searchlistdelegate.cpp \
+    $$PWD/search/searchresultsmodel.cpp \
     $$PWD/search/searchsortmodel.cpp \
     $$PWD/search/searchwidget.cpp \
     $$PWD/shutdownconfirmdialog.cpp \
@@ -115,9 +115,6 @@ SOURCES += \
     $$PWD/torrentcategorydialog.cpp \
     $$PWD/torrentcontentfiltermodel.cpp \
     $$PWD/torrentcontentmodel.cpp \
-    $$PWD/torrentcontentmodelfile.cpp \
-    $$PWD/torrentcontentmodelfolder.cpp \
-    $$PWD/torrentcontentmodelitem.cpp \
     $$PWD/torrentcontenttreeview.cpp \
     $$PWD/torrentcreatordialog.cpp \
     $$PWD/trackerentriesdialog.cpp \
@@ -32,6 +32,8 @@
 
 #include <QDebug>
 
+#include "base/utils/bitarray.h"
+
 DownloadedPiecesBar::DownloadedPiecesBar(QWidget *parent)
     : base {parent}
     , m_dlPieceColor {0, 0xd0, 0}
@@ -86,9 +88,10 @@ QVector<float> DownloadedPiecesBar::bitfieldToFloatVector(const QBitArray &vecin
             }
 
             // subcase (16 >= x < 17)
-            for (; x2 < toCMinusOne; ++x2)
-                if (vecin[x2])
-                    value += 1.0;
+            if (x2 < toCMinusOne) {
+                value += Utils::BitArray::count(vecin, x2, toCMinusOne);
+                x2 = toCMinusOne;
+            }
 
             // subcase (17 >= x < 17.8)
             if (x2 == toCMinusOne) {
@@ -138,6 +138,11 @@ PeerListWidget::PeerListWidget(PropertiesWidget *parent)
     const auto *copyHotkey = new QShortcut(QKeySequence::Copy, this, nullptr, nullptr, Qt::WidgetShortcut);
     connect(copyHotkey, &QShortcut::activated, this, &PeerListWidget::copySelectedPeers);
 
+    connect(BitTorrent::Session::instance(), &BitTorrent::Session::IPsBanned, this, [this]()
+    {
+        loadPeers(m_properties->getCurrentTorrent());
+    });
+
     // This hack fixes reordering of first column with Qt5.
     // https://github.com/qtproject/qtbase/commit/e0fc088c0c8bc61dbcaf5928b24986cd61a22777
     QTableView unused;
@@ -282,15 +287,17 @@ void PeerListWidget::banSelectedPeers()
     if (ret) return;
 
     const QModelIndexList selectedIndexes = selectionModel()->selectedRows();
+    QStringList ips;
+    ips.reserve(selectedIndexes.size());
     for (const QModelIndex &index : selectedIndexes) {
         int row = m_proxyModel->mapToSource(index).row();
         QString ip = m_listModel->data(m_listModel->index(row, PeerListDelegate::IP_HIDDEN)).toString();
         qDebug("Banning peer %s...", ip.toLocal8Bit().data());
         Logger::instance()->addMessage(tr("Manually banning peer '%1'...").arg(ip));
-        BitTorrent::Session::instance()->banIP(ip);
+        ips << ip;
     }
-    // Refresh list
-    loadPeers(m_properties->getCurrentTorrent());
+    // the list is refreshed once the bans are applied
+    BitTorrent::Session::instance()->banIPs(ips);
 }
 
 void PeerListWidget::copySelectedPeers()
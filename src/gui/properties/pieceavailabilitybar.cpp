@@ -29,6 +29,7 @@
 #include "pieceavailabilitybar.h"
 
 #include <cmath>
+#include <numeric>
 
 #include <QDebug>
 
@@ -94,9 +95,12 @@ QVector<float> PieceAvailabilityBar::intToFloatVector(const QVector<int> &vecin,
             }
 
             // subcase (16 >= x < 17)
-            for (; x2 < toCMinusOne; ++x2)
-                if (vecin[x2])
-                    value += vecin[x2];
+            // sum the whole pieces in one go, they have no fractional weight
+            if (x2 < toCMinusOne) {
+                const int *pieces = vecin.constData();
+                value += std::accumulate((pieces + x2), (pieces + toCMinusOne), qint64 {0});
+                x2 = toCMinusOne;
+            }
 
             // subcase (17 >= x < 17.8)
             if (x2 == toCMinusOne) {
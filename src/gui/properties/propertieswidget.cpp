@@ -29,6 +29,7 @@
 #include "propertieswidget.h"
 
 #include <QAction>
+#include <QBitArray>
 #include <QClipboard>
 #include <QDateTime>
 #include <QDebug>
@@ -108,6 +109,9 @@ PropertiesWidget::PropertiesWidget(QWidget *parent)
     connect(m_ui->stackedProperties, &QStackedWidget::currentChanged, this, &PropertiesWidget::loadDynamicData);
     connect(BitTorrent::Session::instance(), &BitTorrent::Session::torrentSavePathChanged, this, &PropertiesWidget::updateSavePath);
     connect(BitTorrent::Session::instance(), &BitTorrent::Session::torrentMetadataLoaded, this, &PropertiesWidget::updateTorrentInfos);
+    connect(BitTorrent::Session::instance(), &BitTorrent::Session::torrentFilesProgressFetched, this, &PropertiesWidget::handleFilesProgressFetched);
+    connect(BitTorrent::Session::instance(), &BitTorrent::Session::torrentPieceAvailabilityFetched, this, &PropertiesWidget::handlePieceAvailabilityFetched);
+    connect(BitTorrent::Session::instance(), &BitTorrent::Session::torrentDownloadingPiecesFetched, this, &PropertiesWidget::handleDownloadingPiecesFetched);
     connect(m_ui->filesList->header(), &QHeaderView::sectionMoved, this, &PropertiesWidget::saveSettings);
     connect(m_ui->filesList->header(), &QHeaderView::sectionResized, this, &PropertiesWidget::saveSettings);
     connect(m_ui->filesList->header(), &QHeaderView::sortIndicatorChanged, this, &PropertiesWidget::saveSettings);
@@ -211,8 +215,7 @@ void PropertiesWidget::setVisibility(bool visible)
         hSplitter->handle(1)->setVisible(true);
         hSplitter->setSizes(m_slideSizes);
         m_state = VISIBLE;
-        // Force refresh
-        loadDynamicData();
+        forceRefresh();
     }
 }
 
@@ -296,6 +299,9 @@ void PropertiesWidget::loadTorrentInfos(BitTorrent::TorrentHandle *const torrent
 {
     clear();
     m_torrent = torrent;
+    m_filesProgressPending = false;
+    m_pieceAvailabilityPending = false;
+    m_downloadingPiecesPending = false;
     m_downloadedPieces->setTorrent(m_torrent);
     m_piecesAvailability->setTorrent(m_torrent);
     if (!m_torrent) return;
@@ -328,7 +334,7 @@ void PropertiesWidget::loadTorrentInfos(BitTorrent::TorrentHandle *const torrent
         m_propListModel->model()->updateFilesPriorities(m_torrent->filePriorities());
     }
     // Load dynamic data
-    loadDynamicData();
+    forceRefresh();
 }
 
 void PropertiesWidget::readSettings()
@@ -376,13 +382,25 @@ void PropertiesWidget::reloadPreferences()
     m_peerList->updatePeerCountryResolutionState();
 }
 
+void PropertiesWidget::forceRefresh()
+{
+    m_refreshedTab = -1;
+    loadDynamicData();
+}
+
 void PropertiesWidget::loadDynamicData()
 {
     // Refresh only if the torrent handle is valid and visible
-    if (!m_torrent || (m_state != VISIBLE)) return;
+    if (!m_torrent || (m_state != VISIBLE) || !isVisible()) return;
+
+    // Refresh only if the torrent changed since the current tab was refreshed
+    const int currentTab = m_ui->stackedProperties->currentIndex();
+    if ((currentTab == m_refreshedTab) && (m_torrent->statusStamp() == m_refreshedStatusStamp)) return;
+    m_refreshedTab = currentTab;
+    m_refreshedStatusStamp = m_torrent->statusStamp();
 
     // Transfer infos
-    switch (m_ui->stackedProperties->currentIndex()) {
+    switch (currentTab) {
     case PropTabBar::MainTab: {
             m_ui->labelWastedVal->setText(Utils::Misc::friendlyUnit(m_torrent->wastedSize()));
 
@@ -448,7 +466,10 @@ void PropertiesWidget::loadDynamicData()
                 if (!m_torrent->isSeed() && !m_torrent->isPaused() && !m_torrent->isQueued() && !m_torrent->isChecking()) {
                     // Pieces availability
                     showPiecesAvailability(true);
-                    m_piecesAvailability->setAvailability(m_torrent->pieceAvailability());
+                    if (!m_pieceAvailabilityPending) {
+                        m_pieceAvailabilityPending = true;
+                        m_torrent->fetchPieceAvailability();
+                    }
                     m_ui->labelAverageAvailabilityVal->setText(Utils::String::fromDouble(m_torrent->distributedCopies(), 3));
                 }
                 else {
@@ -458,7 +479,10 @@ void PropertiesWidget::loadDynamicData()
                 // Progress
                 qreal progress = m_torrent->progress() * 100.;
                 m_ui->labelProgressVal->setText(Utils::String::fromDouble(progress, 1) + '%');
-                m_downloadedPieces->setProgress(m_torrent->pieces(), m_torrent->downloadingPieces());
+                if (!m_downloadingPiecesPending) {
+                    m_downloadingPiecesPending = true;
+                    m_torrent->fetchDownloadingPieces();
+                }
             }
             else {
                 showPiecesAvailability(false);
@@ -476,21 +500,68 @@ void PropertiesWidget::loadDynamicData()
     case PropTabBar::FilesTab:
         // Files progress
         if (m_torrent->hasMetadata()) {
-            qDebug("Updating priorities in files tab");
-            m_ui->filesList->setUpdatesEnabled(false);
-            m_propListModel->model()->updateFilesProgress(m_torrent->filesProgress());
-            m_propListModel->model()->updateFilesAvailability(m_torrent->availableFileFractions());
             // XXX: We don't update file priorities regularly for performance
             // reasons. This means that priorities will not be updated if
             // set from the Web UI.
             // PropListModel->model()->updateFilesPriorities(h.file_priorities());
-            m_ui->filesList->setUpdatesEnabled(true);
+            if (!m_filesProgressPending) {
+                m_filesProgressPending = true;
+                m_torrent->fetchFilesProgress();
+            }
+            if (!m_pieceAvailabilityPending) {
+                m_pieceAvailabilityPending = true;
+                m_torrent->fetchPieceAvailability();
+            }
         }
         break;
     default:;
     }
 }
 
+void PropertiesWidget::handleFilesProgressFetched(BitTorrent::TorrentHandle *const torrent, const QVector<qreal> &filesProgress)
+{
+    if (torrent != m_torrent) return;
+
+    m_filesProgressPending = false;
+    if (m_ui->stackedProperties->currentIndex() != PropTabBar::FilesTab) return;
+    if (filesProgress.size() != m_torrent->filesCount()) return;
+
+    m_ui->filesList->setUpdatesEnabled(false);
+    m_propListModel->model()->updateFilesProgress(filesProgress);
+    m_ui->filesList->setUpdatesEnabled(true);
+}
+
+void PropertiesWidget::handlePieceAvailabilityFetched(BitTorrent::TorrentHandle *const torrent, const QVector<int> &pieceAvailability)
+{
+    if (torrent != m_torrent) return;
+
+    m_pieceAvailabilityPending = false;
+    switch (m_ui->stackedProperties->currentIndex()) {
+    case PropTabBar::MainTab:
+        m_piecesAvailability->setAvailability(pieceAvailability);
+        break;
+    case PropTabBar::FilesTab:
+        // libtorrent returns empty array for seeding only torrents
+        if (!pieceAvailability.isEmpty() && (pieceAvailability.size() != m_torrent->piecesCount())) return;
+
+        m_ui->filesList->setUpdatesEnabled(false);
+        m_propListModel->model()->updateFilesAvailability(m_torrent->availableFileFractions(pieceAvailability));
+        m_ui->filesList->setUpdatesEnabled(true);
+        break;
+    default:;
+    }
+}
+
+void PropertiesWidget::handleDownloadingPiecesFetched(BitTorrent::TorrentHandle *const torrent, const QBitArray &downloadingPieces)
+{
+    if (torrent != m_torrent) return;
+
+    m_downloadingPiecesPending = false;
+    if (m_ui->stackedProperties->currentIndex() != PropTabBar::MainTab) return;
+
+    m_downloadedPieces->setProgress(m_torrent->pieces(), downloadingPieces);
+}
+
 void PropertiesWidget::loadUrlSeeds()
 {
     m_ui->listWebSeeds->clear();
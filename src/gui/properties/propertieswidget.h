@@ -30,8 +30,10 @@
 #define PROPERTIESWIDGET_H
 
 #include <QList>
+#include <QVector>
 #include <QWidget>
 
+class QBitArray;
 class QPushButton;
 class QTreeView;
 
@@ -103,12 +105,16 @@ private slots:
     void configure();
     void filterText(const QString &filter);
     void updateSavePath(BitTorrent::TorrentHandle *const torrent);
+    void handleFilesProgressFetched(BitTorrent::TorrentHandle *const torrent, const QVector<qreal> &filesProgress);
+    void handlePieceAvailabilityFetched(BitTorrent::TorrentHandle *const torrent, const QVector<int> &pieceAvailability);
+    void handleDownloadingPiecesFetched(BitTorrent::TorrentHandle *const torrent, const QBitArray &downloadingPieces);
 
 private:
     QPushButton *getButtonFromIndex(int index);
     void applyPriorities();
     void openFile(const QModelIndex &index);
     void openFolder(const QModelIndex &index, bool containingFolder);
+    void forceRefresh();
 
     Ui::PropertiesWidget *m_ui;
     BitTorrent::TorrentHandle *m_torrent;
@@ -123,6 +129,13 @@ private:
     PieceAvailabilityBar *m_piecesAvailability;
     PropTabBar *m_tabBar;
     LineEdit *m_contentFilterLine;
+    // Tab and torrent status stamp of the last refresh, used to skip refreshing unchanged data
+    int m_refreshedTab = -1;
+    quint64 m_refreshedStatusStamp = 0;
+    // Data requested from libtorrent whose results haven't arrived yet
+    bool m_filesProgressPending = false;
+    bool m_pieceAvailabilityPending = false;
+    bool m_downloadingPiecesPending = false;
 };
 
 #endif // PROPERTIESWIDGET_H
@@ -36,7 +36,6 @@
 #include <QKeyEvent>
 #include <QMenu>
 #include <QPalette>
-#include <QStandardItemModel>
 #include <QTableView>
 #include <QUrl>
 
@@ -50,6 +49,7 @@
 #include "addnewtorrentdialog.h"
 #include "lineedit.h"
 #include "searchlistdelegate.h"
+#include "searchresultsmodel.h"
 #include "searchsortmodel.h"
 #include "ui_searchjobwidget.h"
 #include "uithememanager.h"
@@ -74,16 +74,7 @@ SearchJobWidget::SearchJobWidget(SearchHandler *searchHandler, QWidget *parent)
     header()->setStretchLastSection(false);
 
     // Set Search results list model
-    m_searchListModel = new QStandardItemModel(0, SearchSortModel::NB_SEARCH_COLUMNS, this);
-    m_searchListModel->setHeaderData(SearchSortModel::NAME, Qt::Horizontal, tr("Name", "i.e: file name"));
-    m_searchListModel->setHeaderData(SearchSortModel::SIZE, Qt::Horizontal, tr("Size", "i.e: file size"));
-    m_searchListModel->setHeaderData(SearchSortModel::SEEDS, Qt::Horizontal, tr("Seeders", "i.e: Number of full sources"));
-    m_searchListModel->setHeaderData(SearchSortModel::LEECHES, Qt::Horizontal, tr("Leechers", "i.e: Number of partial sources"));
-    m_searchListModel->setHeaderData(SearchSortModel::ENGINE_URL, Qt::Horizontal, tr("Search engine"));
-    // Set columns text alignment
-    m_searchListModel->setHeaderData(SearchSortModel::SIZE, Qt::Horizontal, QVariant(Qt::AlignRight | Qt::AlignVCenter), Qt::TextAlignmentRole);
-    m_searchListModel->setHeaderData(SearchSortModel::SEEDS, Qt::Horizontal, QVariant(Qt::AlignRight | Qt::AlignVCenter), Qt::TextAlignmentRole);
-    m_searchListModel->setHeaderData(SearchSortModel::LEECHES, Qt::Horizontal, QVariant(Qt::AlignRight | Qt::AlignVCenter), Qt::TextAlignmentRole);
+    m_searchListModel = new SearchResultsModel(searchHandler, this);
 
     m_proxyModel = new SearchSortModel(this);
     m_proxyModel->setDynamicSortFilter(true);
@@ -156,7 +147,7 @@ SearchJobWidget::SearchJobWidget(SearchHandler *searchHandler, QWidget *parent)
 
     connect(m_ui->resultsBrowser, &QAbstractItemView::doubleClicked, this, &SearchJobWidget::onItemDoubleClicked);
 
-    connect(searchHandler, &SearchHandler::newSearchResults, this, &SearchJobWidget::appendSearchResults);
+    connect(m_searchListModel, &QAbstractItemModel::rowsInserted, this, &SearchJobWidget::appendSearchResults);
     connect(searchHandler, &SearchHandler::searchFinished, this, &SearchJobWidget::searchFinished);
     connect(searchHandler, &SearchHandler::searchFailed, this, &SearchJobWidget::searchFailed);
     connect(this, &QObject::destroyed, searchHandler, &QObject::deleteLater);
@@ -184,9 +175,8 @@ QHeaderView *SearchJobWidget::header() const
 void SearchJobWidget::setRowColor(int row, const QColor &color)
 {
     m_proxyModel->setDynamicSortFilter(false);
-    for (int i = 0; i < m_proxyModel->columnCount(); ++i)
-        m_proxyModel->setData(m_proxyModel->index(row, i), color, Qt::ForegroundRole);
-
+    // the source model applies the color to the whole row
+    m_proxyModel->setData(m_proxyModel->index(row, 0), color, Qt::ForegroundRole);
     m_proxyModel->setDynamicSortFilter(true);
 }
 
@@ -506,22 +496,9 @@ void SearchJobWidget::searchFailed()
     setStatus(Status::Error);
 }
 
-void SearchJobWidget::appendSearchResults(const QVector<SearchResult> &results)
+void SearchJobWidget::appendSearchResults()
 {
-    for (const SearchResult &result : results) {
-        // Add item to search result list
-        int row = m_searchListModel->rowCount();
-        m_searchListModel->insertRow(row);
-
-        m_searchListModel->setData(m_searchListModel->index(row, SearchSortModel::NAME), result.fileName); // Name
-        m_searchListModel->setData(m_searchListModel->index(row, SearchSortModel::DL_LINK), result.fileUrl); // download URL
-        m_searchListModel->setData(m_searchListModel->index(row, SearchSortModel::SIZE), result.fileSize); // Size
-        m_searchListModel->setData(m_searchListModel->index(row, SearchSortModel::SEEDS), result.nbSeeders); // Seeders
-        m_searchListModel->setData(m_searchListModel->index(row, SearchSortModel::LEECHES), result.nbLeechers); // Leechers
-        m_searchListModel->setData(m_searchListModel->index(row, SearchSortModel::ENGINE_URL), result.siteUrl); // Search site URL
-        m_searchListModel->setData(m_searchListModel->index(row, SearchSortModel::DESC_LINK), result.descrLink); // Description Link
-    }
-
+    // rows are inserted by SearchResultsModel itself
     updateResultsCount();
 }
 
@@ -36,13 +36,12 @@
 
 class QHeaderView;
 class QModelIndex;
-class QStandardItemModel;
 
 class LineEdit;
 class SearchHandler;
 class SearchListDelegate;
+class SearchResultsModel;
 class SearchSortModel;
-struct SearchResult;
 
 template <typename T> class CachedSettingValue;
 
@@ -100,7 +99,7 @@ private:
     void onItemDoubleClicked(const QModelIndex &index);
     void searchFinished(bool cancelled);
     void searchFailed();
-    void appendSearchResults(const QVector<SearchResult> &results);
+    void appendSearchResults();
     void updateResultsCount();
     void setStatus(Status value);
     void downloadTorrent(const QModelIndex &rowIndex);
@@ -122,7 +121,7 @@ private:
 
     Ui::SearchJobWidget *m_ui;
     SearchHandler *m_searchHandler;
-    QStandardItemModel *m_searchListModel;
+    SearchResultsModel *m_searchListModel;
     SearchSortModel *m_proxyModel;
     SearchListDelegate *m_searchDelegate;
     LineEdit *m_lineEditSearchResultsFilter;
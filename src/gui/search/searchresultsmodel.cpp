@@ -0,0 +1,147 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2019  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#include "searchresultsmodel.h"
+
+#include "base/search/searchhandler.h"
+#include "searchsortmodel.h"
+
+SearchResultsModel::SearchResultsModel(const SearchHandler *searchHandler, QObject *parent)
+    : QAbstractTableModel(parent)
+    , m_searchHandler(searchHandler)
+    , m_rowCount(searchHandler->results().size())
+{
+    connect(searchHandler, &SearchHandler::newSearchResults, this
+            , [this](const QVector<SearchResult> &results) { appendResults(results.size()); });
+}
+
+int SearchResultsModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : m_rowCount;
+}
+
+int SearchResultsModel::columnCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : SearchSortModel::NB_SEARCH_COLUMNS;
+}
+
+QVariant SearchResultsModel::data(const QModelIndex &index, const int role) const
+{
+    if (!index.isValid() || (index.row() >= m_rowCount)) return {};
+
+    if (role == Qt::ForegroundRole) {
+        const auto it = m_rowColors.constFind(index.row());
+        return (it != m_rowColors.cend()) ? QVariant(it.value()) : QVariant();
+    }
+
+    if (role != Qt::DisplayRole) return {};
+
+    const SearchResult &searchResult = result(index.row());
+    switch (index.column()) {
+    case SearchSortModel::NAME:
+        return searchResult.fileName;
+    case SearchSortModel::SIZE:
+        return searchResult.fileSize;
+    case SearchSortModel::SEEDS:
+        return searchResult.nbSeeders;
+    case SearchSortModel::LEECHES:
+        return searchResult.nbLeechers;
+    case SearchSortModel::ENGINE_URL:
+        return searchResult.siteUrl;
+    case SearchSortModel::DL_LINK:
+        return searchResult.fileUrl;
+    case SearchSortModel::DESC_LINK:
+        return searchResult.descrLink;
+    default:
+        return {};
+    }
+}
+
+QVariant SearchResultsModel::headerData(const int section, const Qt::Orientation orientation, const int role) const
+{
+    if (orientation != Qt::Horizontal) return {};
+
+    if (role == Qt::DisplayRole) {
+        switch (section) {
+        case SearchSortModel::NAME:
+            return tr("Name", "i.e: file name");
+        case SearchSortModel::SIZE:
+            return tr("Size", "i.e: file size");
+        case SearchSortModel::SEEDS:
+            return tr("Seeders", "i.e: Number of full sources");
+        case SearchSortModel::LEECHES:
+            return tr("Leechers", "i.e: Number of partial sources");
+        case SearchSortModel::ENGINE_URL:
+            return tr("Search engine");
+        default:
+            return {};
+        }
+    }
+
+    if (role == Qt::TextAlignmentRole) {
+        switch (section) {
+        case SearchSortModel::SIZE:
+        case SearchSortModel::SEEDS:
+        case SearchSortModel::LEECHES:
+            return QVariant(Qt::AlignRight | Qt::AlignVCenter);
+        default:
+            return {};
+        }
+    }
+
+    return {};
+}
+
+bool SearchResultsModel::setData(const QModelIndex &index, const QVariant &value, const int role)
+{
+    if (!index.isValid() || (index.row() >= m_rowCount) || (role != Qt::ForegroundRole))
+        return false;
+
+    m_rowColors[index.row()] = value.value<QColor>();
+    emit dataChanged(this->index(index.row(), 0), this->index(index.row(), (columnCount() - 1)), {role});
+    return true;
+}
+
+const SearchResult &SearchResultsModel::result(const int row) const
+{
+    return m_searchHandler->results().at(row);
+}
+
+const Utils::String::NaturalSortKey &SearchResultsModel::nameSortKey(const int row) const
+{
+    return m_searchHandler->results().nameSortKey(row);
+}
+
+void SearchResultsModel::appendResults(const int count)
+{
+    if (count <= 0) return;
+
+    beginInsertRows({}, m_rowCount, (m_rowCount + count - 1));
+    m_rowCount += count;
+    endInsertRows();
+}
@@ -29,7 +29,9 @@
 #include "searchsortmodel.h"
 
 #include "base/global.h"
+#include "base/search/searchresultstore.h"
 #include "base/utils/string.h"
+#include "searchresultsmodel.h"
 
 SearchSortModel::SearchSortModel(QObject *parent)
     : base(parent)
@@ -108,17 +110,30 @@ qint64 SearchSortModel::maxSize() const
     return m_maxSize;
 }
 
+const SearchResult &SearchSortModel::sourceResult(const int sourceRow) const
+{
+    return static_cast<const SearchResultsModel *>(sourceModel())->result(sourceRow);
+}
+
+// Values are read from the results directly rather than through QVariant
 bool SearchSortModel::lessThan(const QModelIndex &left, const QModelIndex &right) const
 {
+    const SearchResult &resultL = sourceResult(left.row());
+    const SearchResult &resultR = sourceResult(right.row());
+
     switch (sortColumn()) {
-    case NAME:
-    case ENGINE_URL: {
-            const QString strL = left.data().toString();
-            const QString strR = right.data().toString();
-            const int result = Utils::String::naturalCompare(strL, strR, Qt::CaseInsensitive);
-            return (result < 0);
-    }
-        break;
+    case NAME: {
+            const auto *model = static_cast<const SearchResultsModel *>(sourceModel());
+            return (model->nameSortKey(left.row()) < model->nameSortKey(right.row()));
+        }
+    case ENGINE_URL:
+        return (Utils::String::naturalCompare(resultL.siteUrl, resultR.siteUrl, Qt::CaseInsensitive) < 0);
+    case SIZE:
+        return (resultL.fileSize < resultR.fileSize);
+    case SEEDS:
+        return (resultL.nbSeeders < resultR.nbSeeders);
+    case LEECHES:
+        return (resultL.nbLeechers < resultR.nbLeechers);
     default:
         return base::lessThan(left, right);
     };
@@ -126,11 +141,10 @@ bool SearchSortModel::lessThan(const QModelIndex &left, const QModelIndex &right
 
 bool SearchSortModel::filterAcceptsRow(int sourceRow, const QModelIndex &sourceParent) const
 {
-    const QAbstractItemModel *const sourceModel = this->sourceModel();
+    const SearchResult &result = sourceResult(sourceRow);
     if (m_isNameFilterEnabled && !m_searchTerm.isEmpty()) {
-        QString name = sourceModel->data(sourceModel->index(sourceRow, NAME, sourceParent)).toString();
         for (const QString &word : asConst(m_searchTermWords)) {
-            int i = name.indexOf(word, 0, Qt::CaseInsensitive);
+            int i = result.fileName.indexOf(word, 0, Qt::CaseInsensitive);
             if (i == -1) {
                 return false;
             }
@@ -138,7 +152,7 @@ bool SearchSortModel::filterAcceptsRow(int sourceRow, const QModelIndex &sourceP
     }
 
     if ((m_minSize > 0) || (m_maxSize >= 0)) {
-        qlonglong size = sourceModel->data(sourceModel->index(sourceRow, SIZE, sourceParent)).toLongLong();
+        const qlonglong size = result.fileSize;
         if (((m_minSize > 0) && (size < m_minSize))
             || ((m_maxSize > 0) && (size > m_maxSize))) {
             return false;
@@ -146,7 +160,7 @@ bool SearchSortModel::filterAcceptsRow(int sourceRow, const QModelIndex &sourceP
     }
 
     if ((m_minSeeds > 0) || (m_maxSeeds >= 0)) {
-        int seeds = sourceModel->data(sourceModel->index(sourceRow, SEEDS, sourceParent)).toInt();
+        const qlonglong seeds = result.nbSeeders;
         if (((m_minSeeds > 0) && (seeds < m_minSeeds))
             || ((m_maxSeeds > 0) && (seeds > m_maxSeeds))) {
             return false;
@@ -154,7 +168,7 @@ bool SearchSortModel::filterAcceptsRow(int sourceRow, const QModelIndex &sourceP
     }
 
     if ((m_minLeeches > 0) || (m_maxLeeches >= 0)) {
-        int leeches = sourceModel->data(sourceModel->index(sourceRow, LEECHES, sourceParent)).toInt();
+        const qlonglong leeches = result.nbLeechers;
         if (((m_minLeeches > 0) && (leeches < m_minLeeches))
             || ((m_maxLeeches > 0) && (leeches > m_maxLeeches))) {
             return false;
@@ -32,6 +32,10 @@
 #include <QSortFilterProxyModel>
 #include <QStringList>
 
+struct SearchResult;
+
+// Expects SearchResultsModel as source model
+
 class SearchSortModel : public QSortFilterProxyModel
 {
     using base = QSortFilterProxyModel;
@@ -84,6 +88,8 @@ protected:
     bool filterAcceptsRow(int sourceRow, const QModelIndex &sourceParent) const override;
 
 private:
+    const SearchResult &sourceResult(int sourceRow) const;
+
     bool m_isNameFilterEnabled;
     QString m_searchTerm;
     QStringList m_searchTermWords;
@@ -29,6 +29,7 @@
 #include "tagfiltermodel.h"
 
 #include <QDebug>
+#include <QHash>
 #include <QIcon>
 
 #include "base/bittorrent/session.h"
@@ -263,23 +264,26 @@ QString TagFilterModel::tagDisplayName(const QString &tag)
 
 void TagFilterModel::populate()
 {
-    using Torrent = BitTorrent::TorrentHandle;
-
     const auto *session = BitTorrent::Session::instance();
     const auto torrents = session->torrents();
 
+    // Count torrents of all tags in a single pass
+    int untaggedCount = 0;
+    QHash<QString, int> tagCounts;
+    for (const BitTorrent::TorrentHandle *torrent : torrents) {
+        const QSet<QString> tags = torrent->tags();
+        if (tags.isEmpty())
+            ++untaggedCount;
+        for (const QString &tag : tags)
+            ++tagCounts[tag];
+    }
+
     // All torrents
     addToModel(getSpecialAllTag(), torrents.count());
-
-    const int untaggedCount = std::count_if(torrents.cbegin(), torrents.cend(),
-                                             [](Torrent *torrent) { return torrent->tags().isEmpty(); });
     addToModel(getSpecialUntaggedTag(), untaggedCount);
 
-    for (const QString &tag : asConst(session->tags())) {
-        const int count = std::count_if(torrents.cbegin(), torrents.cend(),
-                                        [tag](Torrent *torrent) { return torrent->hasTag(tag); });
-        addToModel(tag, count);
-    }
+    for (const QString &tag : asConst(session->tags()))
+        addToModel(tag, tagCounts.value(tag));
 }
 
 void TagFilterModel::addToModel(const QString &tag, int count)
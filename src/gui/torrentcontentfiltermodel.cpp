@@ -87,9 +87,9 @@ bool TorrentContentFilterModel::lessThan(const QModelIndex &left, const QModelIn
             const TorrentContentModelItem::ItemType rightType = m_model->itemType(m_model->index(right.row(), 0, right.parent()));
 
             if (leftType == rightType) {
-                const QString strL = left.data().toString();
-                const QString strR = right.data().toString();
-                return Utils::String::naturalLessThan<Qt::CaseInsensitive>(strL, strR);
+                const Utils::String::NaturalSortKey &keyL = m_model->nameSortKey(m_model->index(left.row(), 0, left.parent()));
+                const Utils::String::NaturalSortKey &keyR = m_model->nameSortKey(m_model->index(right.row(), 0, right.parent()));
+                return (keyL < keyR);
             }
             if ((leftType == TorrentContentModelItem::FolderType) && (sortOrder() == Qt::AscendingOrder)) {
                 return true;
@@ -32,7 +32,9 @@
 
 #include <QFileIconProvider>
 #include <QFileInfo>
+#include <QHash>
 #include <QIcon>
+#include <QPair>
 
 #if defined(Q_OS_WIN)
 #include <Windows.h>
@@ -49,11 +51,10 @@
 #endif
 
 #include "base/bittorrent/downloadpriority.h"
+#include "base/bittorrent/torrenthandle.h"
 #include "base/bittorrent/torrentinfo.h"
 #include "base/global.h"
 #include "base/utils/fs.h"
-#include "torrentcontentmodelfile.h"
-#include "torrentcontentmodelfolder.h"
 #include "torrentcontentmodelitem.h"
 #include "uithememanager.h"
 
@@ -194,11 +195,19 @@ namespace
         QMimeDatabase m_db;
     };
 #endif // Q_OS_WIN
+
+    QString displayName(QString name)
+    {
+        // Do not display incomplete extensions
+        if (name.endsWith(QB_EXT))
+            name.chop(QB_EXT.size());
+        return name;
+    }
 }
 
 TorrentContentModel::TorrentContentModel(QObject *parent)
     : QAbstractItemModel(parent)
-    , m_rootItem(new TorrentContentModelFolder(QVector<QVariant>({ tr("Name"), tr("Size"), tr("Progress"), tr("Download Priority"), tr("Remaining"), tr("Availability") })))
+    , m_nodes(1)
 {
 #if defined(Q_OS_WIN)
     m_fileIconProvider = new WinShellFileIconProvider();
@@ -213,74 +222,92 @@ TorrentContentModel::TorrentContentModel(QObject *parent)
 TorrentContentModel::~TorrentContentModel()
 {
     delete m_fileIconProvider;
-    delete m_rootItem;
 }
 
 void TorrentContentModel::updateFilesProgress(const QVector<qreal> &fp)
 {
-    Q_ASSERT(m_filesIndex.size() == fp.size());
+    Q_ASSERT(m_fileNodes.size() == fp.size());
     // XXX: Why is this necessary?
-    if (m_filesIndex.size() != fp.size()) return;
-
-    emit layoutAboutToBeChanged();
-    for (int i = 0; i < fp.size(); ++i)
-        m_filesIndex[i]->setProgress(fp[i]);
-    // Update folders progress in the tree
-    m_rootItem->recalculateProgress();
-    m_rootItem->recalculateAvailability();
-    emit dataChanged(index(0, 0), index(rowCount(), columnCount()));
+    if (m_fileNodes.size() != fp.size()) return;
+
+    QVector<int> dirtyFolders;
+    QVector<int> changedNodes;
+    for (int i = 0; i < fp.size(); ++i) {
+        Node &file = m_nodes[m_fileNodes[i]];
+        const qulonglong remaining = static_cast<qulonglong>(file.size * (1.0 - fp[i]));
+        if ((file.progress == fp[i]) && (file.remaining == remaining))
+            continue;
+
+        file.progress = fp[i];
+        file.remaining = remaining;
+        Q_ASSERT(file.progress <= 1.);
+        changedNodes.append(m_fileNodes[i]);
+        dirtyFolders.append(file.parent);
+    }
+    // Update progress of the folders above the changed files only
+    updateFolders(dirtyFolders, changedNodes);
+    notifyNodesChanged(changedNodes);
 }
 
 void TorrentContentModel::updateFilesPriorities(const QVector<BitTorrent::DownloadPriority> &fprio)
 {
-    Q_ASSERT(m_filesIndex.size() == fprio.size());
+    Q_ASSERT(m_fileNodes.size() == fprio.size());
     // XXX: Why is this necessary?
-    if (m_filesIndex.size() != fprio.size())
+    if (m_fileNodes.size() != fprio.size())
         return;
 
-    emit layoutAboutToBeChanged();
+    QVector<int> dirtyFolders;
+    QVector<int> changedNodes;
     for (int i = 0; i < fprio.size(); ++i)
-        m_filesIndex[i]->setPriority(static_cast<BitTorrent::DownloadPriority>(fprio[i]));
-    emit dataChanged(index(0, 0), index(rowCount(), columnCount()));
+        setNodePriority(m_fileNodes[i], fprio[i], dirtyFolders, changedNodes);
+    updateFolders(dirtyFolders, changedNodes);
+    notifyNodesChanged(changedNodes);
 }
 
 void TorrentContentModel::updateFilesAvailability(const QVector<qreal> &fa)
 {
-    Q_ASSERT(m_filesIndex.size() == fa.size());
+    Q_ASSERT(m_fileNodes.size() == fa.size());
     // XXX: Why is this necessary?
-    if (m_filesIndex.size() != fa.size()) return;
-
-    emit layoutAboutToBeChanged();
-    for (int i = 0; i < fa.size(); ++i)
-        m_filesIndex[i]->setAvailability(fa[i]);
-    // Update folders progress in the tree
-    m_rootItem->recalculateProgress();
-    emit dataChanged(index(0, 0), index(rowCount(), columnCount()));
+    if (m_fileNodes.size() != fa.size()) return;
+
+    QVector<int> dirtyFolders;
+    QVector<int> changedNodes;
+    for (int i = 0; i < fa.size(); ++i) {
+        Node &file = m_nodes[m_fileNodes[i]];
+        if (file.availability == fa[i])
+            continue;
+
+        file.availability = fa[i];
+        Q_ASSERT(file.availability <= 1.);
+        changedNodes.append(m_fileNodes[i]);
+        dirtyFolders.append(file.parent);
+    }
+    // Update availability of the folders above the changed files only
+    updateFolders(dirtyFolders, changedNodes);
+    notifyNodesChanged(changedNodes);
 }
 
 QVector<BitTorrent::DownloadPriority> TorrentContentModel::getFilePriorities() const
 {
     QVector<BitTorrent::DownloadPriority> prio;
-    prio.reserve(m_filesIndex.size());
-    for (const TorrentContentModelFile *file : asConst(m_filesIndex))
-        prio.push_back(file->priority());
+    prio.reserve(m_fileNodes.size());
+    for (const int file : asConst(m_fileNodes))
+        prio.push_back(m_nodes.at(file).priority);
     return prio;
 }
 
 bool TorrentContentModel::allFiltered() const
 {
-    return std::all_of(m_filesIndex.cbegin(), m_filesIndex.cend(), [](const TorrentContentModelFile *fileItem)
+    return std::all_of(m_fileNodes.cbegin(), m_fileNodes.cend(), [this](const int file)
     {
-        return (fileItem->priority() == BitTorrent::DownloadPriority::Ignored);
+        return (m_nodes.at(file).priority == BitTorrent::DownloadPriority::Ignored);
     });
 }
 
 int TorrentContentModel::columnCount(const QModelIndex &parent) const
 {
-    if (parent.isValid())
-        return static_cast<TorrentContentModelItem*>(parent.internalPointer())->columnCount();
-
-    return m_rootItem->columnCount();
+    Q_UNUSED(parent);
+    return TorrentContentModelItem::NB_COL;
 }
 
 bool TorrentContentModel::setData(const QModelIndex &index, const QVariant &value, int role)
@@ -288,40 +315,46 @@ bool TorrentContentModel::setData(const QModelIndex &index, const QVariant &valu
     if (!index.isValid())
         return false;
 
+    const int node = nodeIndex(index);
+
     if ((index.column() == TorrentContentModelItem::COL_NAME) && (role == Qt::CheckStateRole)) {
-        auto *item = static_cast<TorrentContentModelItem*>(index.internalPointer());
-        qDebug("setData(%s, %d", qUtf8Printable(item->name()), value.toInt());
-        if (static_cast<int>(item->priority()) != value.toInt()) {
+        qDebug("setData(%s, %d", qUtf8Printable(m_nodes.at(node).name), value.toInt());
+        if (static_cast<int>(m_nodes.at(node).priority) != value.toInt()) {
             BitTorrent::DownloadPriority prio = BitTorrent::DownloadPriority::Normal;
             if (value.toInt() == Qt::PartiallyChecked)
                 prio = BitTorrent::DownloadPriority::Mixed;
             else if (value.toInt() == Qt::Unchecked)
                 prio = BitTorrent::DownloadPriority::Ignored;
 
-            item->setPriority(prio);
+            QVector<int> dirtyFolders;
+            QVector<int> changedNodes;
+            setNodePriority(node, prio, dirtyFolders, changedNodes);
             // Update folders progress in the tree
-            m_rootItem->recalculateProgress();
-            m_rootItem->recalculateAvailability();
-            emit dataChanged(this->index(0, 0), this->index(rowCount() - 1, columnCount() - 1));
+            updateFolders(dirtyFolders, changedNodes);
+            notifyNodesChanged(changedNodes);
             emit filteredFilesChanged();
         }
         return true;
     }
 
     if (role == Qt::EditRole) {
-        Q_ASSERT(index.isValid());
-        auto *item = static_cast<TorrentContentModelItem*>(index.internalPointer());
         switch (index.column()) {
         case TorrentContentModelItem::COL_NAME:
-            item->setName(value.toString());
+            m_nodes[node].name = value.toString();
+            m_nodes[node].hasNameSortKey = false;
+            emit dataChanged(index, index);
             break;
-        case TorrentContentModelItem::COL_PRIO:
-            item->setPriority(static_cast<BitTorrent::DownloadPriority>(value.toInt()));
+        case TorrentContentModelItem::COL_PRIO: {
+                QVector<int> dirtyFolders;
+                QVector<int> changedNodes;
+                setNodePriority(node, static_cast<BitTorrent::DownloadPriority>(value.toInt()), dirtyFolders, changedNodes);
+                updateFolders(dirtyFolders, changedNodes);
+                notifyNodesChanged(changedNodes);
+            }
             break;
         default:
             return false;
         }
-        emit dataChanged(index, index);
         return true;
     }
 
@@ -330,17 +363,27 @@ bool TorrentContentModel::setData(const QModelIndex &index, const QVariant &valu
 
 TorrentContentModelItem::ItemType TorrentContentModel::itemType(const QModelIndex &index) const
 {
-    return static_cast<const TorrentContentModelItem*>(index.internalPointer())->itemType();
+    return m_nodes.at(nodeIndex(index)).isFolder()
+        ? TorrentContentModelItem::FolderType
+        : TorrentContentModelItem::FileType;
 }
 
-int TorrentContentModel::getFileIndex(const QModelIndex &index)
+const Utils::String::NaturalSortKey &TorrentContentModel::nameSortKey(const QModelIndex &index) const
 {
-    auto *item = static_cast<TorrentContentModelItem*>(index.internalPointer());
-    if (item->itemType() == TorrentContentModelItem::FileType)
-        return static_cast<TorrentContentModelFile*>(item)->fileIndex();
+    const Node &node = m_nodes.at(nodeIndex(index));
+    if (!node.hasNameSortKey) {
+        node.nameSortKey = {node.name, Qt::CaseInsensitive};
+        node.hasNameSortKey = true;
+    }
+
+    return node.nameSortKey;
+}
 
-    Q_ASSERT(item->itemType() == TorrentContentModelItem::FileType);
-    return -1;
+int TorrentContentModel::getFileIndex(const QModelIndex &index)
+{
+    const Node &node = m_nodes.at(nodeIndex(index));
+    Q_ASSERT(!node.isFolder());
+    return node.fileIndex;
 }
 
 QVariant TorrentContentModel::data(const QModelIndex &index, int role) const
@@ -348,25 +391,42 @@ QVariant TorrentContentModel::data(const QModelIndex &index, int role) const
     if (!index.isValid())
         return {};
 
-    auto *item = static_cast<TorrentContentModelItem*>(index.internalPointer());
+    const Node &node = m_nodes.at(nodeIndex(index));
 
     if ((index.column() == TorrentContentModelItem::COL_NAME) && (role == Qt::DecorationRole)) {
-        if (item->itemType() == TorrentContentModelItem::FolderType)
+        if (node.isFolder())
             return m_fileIconProvider->icon(QFileIconProvider::Folder);
 
-        return m_fileIconProvider->icon(QFileInfo(item->name()));
+        return m_fileIconProvider->icon(QFileInfo(node.name));
     }
 
     if ((index.column() == TorrentContentModelItem::COL_NAME) && (role == Qt::CheckStateRole)) {
-        if (item->data(TorrentContentModelItem::COL_PRIO).toInt() == static_cast<int>(BitTorrent::DownloadPriority::Ignored))
+        if (node.priority == BitTorrent::DownloadPriority::Ignored)
             return Qt::Unchecked;
-        if (item->data(TorrentContentModelItem::COL_PRIO).toInt() == static_cast<int>(BitTorrent::DownloadPriority::Mixed))
+        if (node.priority == BitTorrent::DownloadPriority::Mixed)
             return Qt::PartiallyChecked;
         return Qt::Checked;
     }
 
-    if (role == Qt::DisplayRole)
-        return item->data(index.column());
+    if (role == Qt::DisplayRole) {
+        switch (index.column()) {
+        case TorrentContentModelItem::COL_NAME:
+            return node.name;
+        case TorrentContentModelItem::COL_PRIO:
+            return static_cast<int>(node.priority);
+        case TorrentContentModelItem::COL_PROGRESS:
+            return node.displayedProgress();
+        case TorrentContentModelItem::COL_SIZE:
+            return node.size;
+        case TorrentContentModelItem::COL_REMAINING:
+            return node.displayedRemaining();
+        case TorrentContentModelItem::COL_AVAILABILITY:
+            return node.displayedAvailability();
+        default:
+            Q_ASSERT(false);
+            return {};
+        }
+    }
 
     return {};
 }
@@ -384,10 +444,25 @@ Qt::ItemFlags TorrentContentModel::flags(const QModelIndex &index) const
 
 QVariant TorrentContentModel::headerData(int section, Qt::Orientation orientation, int role) const
 {
-    if ((orientation == Qt::Horizontal) && (role == Qt::DisplayRole))
-        return m_rootItem->data(section);
+    if ((orientation != Qt::Horizontal) || (role != Qt::DisplayRole))
+        return {};
 
-    return {};
+    switch (section) {
+    case TorrentContentModelItem::COL_NAME:
+        return tr("Name");
+    case TorrentContentModelItem::COL_SIZE:
+        return tr("Size");
+    case TorrentContentModelItem::COL_PROGRESS:
+        return tr("Progress");
+    case TorrentContentModelItem::COL_PRIO:
+        return tr("Download Priority");
+    case TorrentContentModelItem::COL_REMAINING:
+        return tr("Remaining");
+    case TorrentContentModelItem::COL_AVAILABILITY:
+        return tr("Availability");
+    default:
+        return {};
+    }
 }
 
 QModelIndex TorrentContentModel::index(int row, int column, const QModelIndex &parent) const
@@ -395,23 +470,14 @@ QModelIndex TorrentContentModel::index(int row, int column, const QModelIndex &p
     if (parent.isValid() && (parent.column() != 0))
         return {};
 
-    if (column >= TorrentContentModelItem::NB_COL)
+    if ((column < 0) || (column >= TorrentContentModelItem::NB_COL))
         return {};
 
-    TorrentContentModelFolder *parentItem;
-    if (!parent.isValid())
-        parentItem = m_rootItem;
-    else
-        parentItem = static_cast<TorrentContentModelFolder*>(parent.internalPointer());
-    Q_ASSERT(parentItem);
-
-    if (row >= parentItem->childCount())
+    const Node &parentNode = m_nodes.at(nodeIndex(parent));
+    if ((row < 0) || (row >= parentNode.childCount))
         return {};
 
-    TorrentContentModelItem *childItem = parentItem->child(row);
-    if (childItem)
-        return createIndex(row, column, childItem);
-    return {};
+    return createIndex(row, column, static_cast<quintptr>(m_childNodes.at(parentNode.firstChild + row)));
 }
 
 QModelIndex TorrentContentModel::parent(const QModelIndex &index) const
@@ -419,15 +485,11 @@ QModelIndex TorrentContentModel::parent(const QModelIndex &index) const
     if (!index.isValid())
         return {};
 
-    auto *childItem = static_cast<TorrentContentModelItem*>(index.internalPointer());
-    if (!childItem)
+    const int parentNode = m_nodes.at(nodeIndex(index)).parent;
+    if (parentNode <= 0)
         return {};
 
-    TorrentContentModelItem *parentItem = childItem->parent();
-    if (parentItem == m_rootItem)
-        return {};
-
-    return createIndex(parentItem->row(), 0, parentItem);
+    return createIndex(m_nodes.at(parentNode).row, 0, static_cast<quintptr>(parentNode));
 }
 
 int TorrentContentModel::rowCount(const QModelIndex &parent) const
@@ -435,21 +497,16 @@ int TorrentContentModel::rowCount(const QModelIndex &parent) const
     if (parent.column() > 0)
         return 0;
 
-    TorrentContentModelFolder *parentItem;
-    if (!parent.isValid())
-        parentItem = m_rootItem;
-    else
-        parentItem = dynamic_cast<TorrentContentModelFolder*>(static_cast<TorrentContentModelItem*>(parent.internalPointer()));
-
-    return parentItem ? parentItem->childCount() : 0;
+    return m_nodes.at(nodeIndex(parent)).childCount;
 }
 
 void TorrentContentModel::clear()
 {
     qDebug("clear called");
     beginResetModel();
-    m_filesIndex.clear();
-    m_rootItem->deleteAllChildren();
+    m_nodes = QVector<Node>(1);
+    m_childNodes.clear();
+    m_fileNodes.clear();
     endResetModel();
 }
 
@@ -460,50 +517,239 @@ void TorrentContentModel::setupModelData(const BitTorrent::TorrentInfo &info)
     if (filesCount <= 0)
         return;
 
-    emit layoutAboutToBeChanged();
-    // Initialize files_index array
+    beginResetModel();
     qDebug("Torrent contains %d files", filesCount);
-    m_filesIndex.reserve(filesCount);
-
-    TorrentContentModelFolder *currentParent;
+    m_nodes = QVector<Node>(1);
+    m_nodes.reserve(filesCount + 1);
+    m_fileNodes.clear();
+    m_fileNodes.reserve(filesCount);
+
+    // Folders are looked up by their parent and name so that each
+    // path component shared by several files is stored only once
+    QHash<QPair<int, QString>, int> folderNodes;
     // Iterate over files
     for (int i = 0; i < filesCount; ++i) {
-        currentParent = m_rootItem;
-        QString path = Utils::Fs::toUniformPath(info.filePath(i));
+        int parent = 0;
+        const QString path = Utils::Fs::toUniformPath(info.filePath(i));
         // Iterate of parts of the path to create necessary folders
         QStringList pathFolders = path.split('/', QString::SkipEmptyParts);
         pathFolders.removeLast();
         for (const QString &pathPart : asConst(pathFolders)) {
             if (pathPart == ".unwanted")
                 continue;
-            TorrentContentModelFolder* newParent = currentParent->childFolderWithName(pathPart);
-            if (!newParent) {
-                newParent = new TorrentContentModelFolder(pathPart, currentParent);
-                currentParent->appendChild(newParent);
+
+            const QPair<int, QString> key {parent, pathPart};
+            int folder = folderNodes.value(key, -1);
+            if (folder < 0) {
+                Node folderNode;
+                folderNode.name = displayName(pathPart);
+                folderNode.parent = parent;
+                folder = m_nodes.size();
+                m_nodes.append(folderNode);
+                folderNodes.insert(key, folder);
             }
-            currentParent = newParent;
+            parent = folder;
         }
         // Actually create the file
-        TorrentContentModelFile *fileItem = new TorrentContentModelFile(info.fileName(i), info.fileSize(i), currentParent, i);
-        currentParent->appendChild(fileItem);
-        m_filesIndex.push_back(fileItem);
+        Node fileNode;
+        fileNode.name = displayName(info.fileName(i));
+        fileNode.parent = parent;
+        fileNode.fileIndex = i;
+        fileNode.size = info.fileSize(i);
+        m_fileNodes.append(m_nodes.size());
+        m_nodes.append(fileNode);
+    }
+
+    // Lay out the children of each node next to each other, keeping the insertion order
+    for (int node = 1; node < m_nodes.size(); ++node)
+        ++m_nodes[m_nodes[node].parent].childCount;
+    int offset = 0;
+    for (Node &node : m_nodes) {
+        node.firstChild = offset;
+        offset += node.childCount;
+        node.childCount = 0;
     }
-    emit layoutChanged();
+    m_childNodes.resize(m_nodes.size() - 1);
+    for (int node = 1; node < m_nodes.size(); ++node) {
+        Node &parentNode = m_nodes[m_nodes[node].parent];
+        m_nodes[node].row = parentNode.childCount++;
+        m_childNodes[parentNode.firstChild + m_nodes[node].row] = node;
+    }
+
+    // Children are always placed after their parents
+    // so folder sizes can be accumulated in a single backward pass
+    for (int node = (m_nodes.size() - 1); node > 0; --node)
+        m_nodes[m_nodes[node].parent].size += m_nodes[node].size;
+
+    endResetModel();
 }
 
 void TorrentContentModel::selectAll()
 {
-    for (int i = 0; i < m_rootItem->childCount(); ++i) {
-        TorrentContentModelItem* child = m_rootItem->child(i);
-        if (child->priority() == BitTorrent::DownloadPriority::Ignored)
-            child->setPriority(BitTorrent::DownloadPriority::Normal);
+    QVector<int> dirtyFolders;
+    QVector<int> changedNodes;
+    const int firstChild = m_nodes.at(0).firstChild;
+    const int childCount = m_nodes.at(0).childCount;
+    for (int i = firstChild; i < (firstChild + childCount); ++i) {
+        const int child = m_childNodes.at(i);
+        if (m_nodes.at(child).priority == BitTorrent::DownloadPriority::Ignored)
+            setNodePriority(child, BitTorrent::DownloadPriority::Normal, dirtyFolders, changedNodes);
     }
-    emit dataChanged(index(0, 0), index(rowCount(), columnCount()));
+    updateFolders(dirtyFolders, changedNodes);
+    notifyNodesChanged(changedNodes);
 }
 
 void TorrentContentModel::selectNone()
 {
-    for (int i = 0; i < m_rootItem->childCount(); ++i)
-        m_rootItem->child(i)->setPriority(BitTorrent::DownloadPriority::Ignored);
-    emit dataChanged(index(0, 0), index(rowCount(), columnCount()));
+    QVector<int> dirtyFolders;
+    QVector<int> changedNodes;
+    const int firstChild = m_nodes.at(0).firstChild;
+    const int childCount = m_nodes.at(0).childCount;
+    for (int i = firstChild; i < (firstChild + childCount); ++i)
+        setNodePriority(m_childNodes.at(i), BitTorrent::DownloadPriority::Ignored, dirtyFolders, changedNodes);
+    updateFolders(dirtyFolders, changedNodes);
+    notifyNodesChanged(changedNodes);
+}
+
+int TorrentContentModel::nodeIndex(const QModelIndex &index) const
+{
+    // the root node is addressed by an invalid index
+    return index.isValid() ? static_cast<int>(index.internalId()) : 0;
+}
+
+void TorrentContentModel::setNodePriority(const int node, const BitTorrent::DownloadPriority prio
+    , QVector<int> &dirtyFolders, QVector<int> &changedNodes)
+{
+    if (m_nodes.at(node).priority == prio)
+        return;
+
+    Q_ASSERT(m_nodes.at(node).isFolder() || (prio != BitTorrent::DownloadPriority::Mixed));
+
+    m_nodes[node].priority = prio;
+    changedNodes.append(node);
+    // Update parent priority
+    dirtyFolders.append(m_nodes.at(node).parent);
+
+    if (!m_nodes.at(node).isFolder() || (prio == BitTorrent::DownloadPriority::Mixed))
+        return;
+
+    // Update children. Folder aggregates skip ignored items
+    // so every folder whose children changed has to be recalculated.
+    dirtyFolders.append(node);
+    QVector<int> folders {node};
+    while (!folders.isEmpty()) {
+        const int folder = folders.takeLast();
+        const int firstChild = m_nodes.at(folder).firstChild;
+        const int childCount = m_nodes.at(folder).childCount;
+        for (int i = firstChild; i < (firstChild + childCount); ++i) {
+            const int child = m_childNodes.at(i);
+            if (m_nodes.at(child).priority == prio)
+                continue;
+
+            m_nodes[child].priority = prio;
+            changedNodes.append(child);
+            if (m_nodes.at(child).isFolder()) {
+                dirtyFolders.append(child);
+                folders.append(child);
+            }
+        }
+    }
+}
+
+void TorrentContentModel::updateFolders(QVector<int> &dirtyFolders, QVector<int> &changedNodes)
+{
+    // Parents always have lower indexes than their children, so processing the
+    // dirty folders from the highest index down visits each folder once and
+    // only after all of its dirty descendants have been recalculated.
+    std::make_heap(dirtyFolders.begin(), dirtyFolders.end());
+    int lastFolder = -1;
+    while (!dirtyFolders.isEmpty()) {
+        std::pop_heap(dirtyFolders.begin(), dirtyFolders.end());
+        const int folder = dirtyFolders.takeLast();
+        // the root item isn't displayed
+        if ((folder == lastFolder) || (folder <= 0))
+            continue;
+
+        lastFolder = folder;
+        if (recalculateFolder(folder)) {
+            changedNodes.append(folder);
+            dirtyFolders.append(m_nodes.at(folder).parent);
+            std::push_heap(dirtyFolders.begin(), dirtyFolders.end());
+        }
+    }
+}
+
+bool TorrentContentModel::recalculateFolder(const int folder)
+{
+    const int firstChild = m_nodes.at(folder).firstChild;
+    const int childCount = m_nodes.at(folder).childCount;
+    Q_ASSERT(childCount > 0);
+
+    // If all children have the same priority
+    // then the folder should have the same
+    // priority
+    BitTorrent::DownloadPriority prio = m_nodes.at(m_childNodes.at(firstChild)).priority;
+    qreal tProgress = 0;
+    qulonglong tSize = 0;
+    qulonglong tRemaining = 0;
+    qreal tAvailability = 0;
+    bool foundAnyData = false;
+    for (int i = firstChild; i < (firstChild + childCount); ++i) {
+        const Node &child = m_nodes.at(m_childNodes.at(i));
+        if (child.priority != prio)
+            prio = BitTorrent::DownloadPriority::Mixed;
+
+        if (child.priority == BitTorrent::DownloadPriority::Ignored)
+            continue;
+
+        tProgress += child.displayedProgress() * child.size;
+        tSize += child.size;
+        tRemaining += child.displayedRemaining();
+        const qreal childAvailability = child.displayedAvailability();
+        if (childAvailability >= 0) { // -1 means "no data"
+            tAvailability += childAvailability * child.size;
+            foundAnyData = true;
+        }
+    }
+
+    Node &node = m_nodes[folder];
+    const qreal progress = (tSize > 0) ? (tProgress / tSize) : node.progress;
+    const qulonglong remaining = (tSize > 0) ? tRemaining : node.remaining;
+    const qreal availability = ((tSize > 0) && foundAnyData) ? (tAvailability / tSize) : -1.;
+    if ((node.priority == prio) && (node.progress == progress)
+        && (node.remaining == remaining) && (node.availability == availability))
+        return false;
+
+    node.priority = prio;
+    node.progress = progress;
+    node.remaining = remaining;
+    node.availability = availability;
+    Q_ASSERT(node.progress <= 1.);
+    Q_ASSERT(node.availability <= 1.);
+    return true;
+}
+
+void TorrentContentModel::notifyNodesChanged(const QVector<int> &changedNodes)
+{
+    // Emit one signal per parent covering the range of its changed rows
+    QHash<int, QPair<int, int>> changedRows;
+    for (const int node : changedNodes) {
+        const Node &item = m_nodes.at(node);
+        const auto iter = changedRows.find(item.parent);
+        if (iter == changedRows.end()) {
+            changedRows.insert(item.parent, {item.row, item.row});
+        }
+        else {
+            iter->first = std::min(iter->first, item.row);
+            iter->second = std::max(iter->second, item.row);
+        }
+    }
+
+    for (auto iter = changedRows.cbegin(); iter != changedRows.cend(); ++iter) {
+        const QModelIndex parentIndex = (iter.key() > 0)
+            ? createIndex(m_nodes.at(iter.key()).row, 0, static_cast<quintptr>(iter.key()))
+            : QModelIndex();
+        emit dataChanged(index(iter->first, 0, parentIndex)
+            , index(iter->second, (TorrentContentModelItem::NB_COL - 1), parentIndex));
+    }
 }
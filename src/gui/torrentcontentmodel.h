@@ -32,14 +32,14 @@
 #include <QAbstractItemModel>
 #include <QVector>
 
+#include "base/bittorrent/downloadpriority.h"
+#include "base/utils/string.h"
 #include "torrentcontentmodelitem.h"
 
 class QFileIconProvider;
 class QModelIndex;
 class QVariant;
 
-class TorrentContentModelFile;
-
 namespace BitTorrent
 {
     class TorrentInfo;
@@ -62,6 +62,7 @@ public:
     int columnCount(const QModelIndex &parent = {}) const override;
     bool setData(const QModelIndex &index, const QVariant &value, int role = Qt::EditRole) override;
     TorrentContentModelItem::ItemType itemType(const QModelIndex &index) const;
+    const Utils::String::NaturalSortKey &nameSortKey(const QModelIndex &index) const;
     int getFileIndex(const QModelIndex &index);
     QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
     Qt::ItemFlags flags(const QModelIndex &index) const override;
@@ -80,8 +81,41 @@ public slots:
     void selectNone();
 
 private:
-    TorrentContentModelFolder *m_rootItem;
-    QVector<TorrentContentModelFile *> m_filesIndex;
+    // Tree node. Nodes are stored in a flat array where node 0 is the (invisible)
+    // root and every node is placed after its parent. The children of a node
+    // occupy a contiguous range of m_childNodes.
+    struct Node
+    {
+        QString name;
+        int parent = -1;
+        int row = 0;
+        int firstChild = 0;
+        int childCount = 0;
+        int fileIndex = -1; // -1 for folders
+        qulonglong size = 0;
+        qulonglong remaining = 0;
+        qreal progress = 0;
+        qreal availability = -1;
+        BitTorrent::DownloadPriority priority = BitTorrent::DownloadPriority::Normal;
+        // built on first use and dropped on rename
+        mutable Utils::String::NaturalSortKey nameSortKey;
+        mutable bool hasNameSortKey = false;
+
+        bool isFolder() const { return (fileIndex < 0); }
+        qreal displayedProgress() const { return (size > 0) ? progress : 1; }
+        qulonglong displayedRemaining() const { return (priority == BitTorrent::DownloadPriority::Ignored) ? 0 : remaining; }
+        qreal displayedAvailability() const { return (size > 0) ? availability : 0; }
+    };
+
+    int nodeIndex(const QModelIndex &index) const;
+    void setNodePriority(int node, BitTorrent::DownloadPriority prio, QVector<int> &dirtyFolders, QVector<int> &changedNodes);
+    void updateFolders(QVector<int> &dirtyFolders, QVector<int> &changedNodes);
+    bool recalculateFolder(int folder);
+    void notifyNodesChanged(const QVector<int> &changedNodes);
+
+    QVector<Node> m_nodes;
+    QVector<int> m_childNodes;
+    QVector<int> m_fileNodes;
     QFileIconProvider *m_fileIconProvider;
 };
 
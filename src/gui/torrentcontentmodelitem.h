@@ -29,14 +29,6 @@
 #ifndef TORRENTCONTENTMODELITEM_H
 #define TORRENTCONTENTMODELITEM_H
 
-#include <QVector>
-
-#include "base/bittorrent/downloadpriority.h"
-
-class QVariant;
-
-class TorrentContentModelFolder;
-
 class TorrentContentModelItem
 {
 public:
@@ -56,41 +48,6 @@ public:
         FileType,
         FolderType
     };
-
-    explicit TorrentContentModelItem(TorrentContentModelFolder *parent);
-    virtual ~TorrentContentModelItem();
-
-    bool isRootItem() const;
-    TorrentContentModelFolder *parent() const;
-    virtual ItemType itemType() const = 0;
-
-    QString name() const;
-    void setName(const QString &name);
-
-    qulonglong size() const;
-    qreal progress() const;
-    qulonglong remaining() const;
-
-    qreal availability() const;
-
-    BitTorrent::DownloadPriority priority() const;
-    virtual void setPriority(BitTorrent::DownloadPriority newPriority, bool updateParent = true) = 0;
-
-    int columnCount() const;
-    QVariant data(int column) const;
-    int row() const;
-
-protected:
-    TorrentContentModelFolder *m_parentItem;
-    // Root item members
-    QVector<QVariant> m_itemData;
-    // Non-root item members
-    QString m_name;
-    qulonglong m_size;
-    qulonglong m_remaining;
-    BitTorrent::DownloadPriority m_priority;
-    qreal m_progress;
-    qreal m_availability;
 };
 
 #endif // TORRENTCONTENTMODELITEM_H
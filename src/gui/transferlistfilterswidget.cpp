@@ -40,7 +40,7 @@
 
 #include "base/bittorrent/session.h"
 #include "base/bittorrent/torrenthandle.h"
-#include "base/bittorrent/trackerentry.h"
+#include "base/bittorrent/trackerhostindex.h"
 #include "base/global.h"
 #include "base/logger.h"
 #include "base/net/downloadmanager.h"
@@ -56,6 +56,15 @@
 
 namespace
 {
+    enum TrackerFilterRow
+    {
+        ALL_ROW = 0,
+        TRACKERLESS_ROW = 1,
+        ERROR_ROW = 2,
+        WARNING_ROW = 3,
+        FIRST_HOST_ROW = 4
+    };
+
     QString getScheme(const QString &tracker)
     {
         const QUrl url {tracker};
@@ -231,7 +240,19 @@ TrackerFiltersList::TrackerFiltersList(QWidget *parent, TransferListWidget *tran
     auto *warningTracker = new QListWidgetItem(this);
     warningTracker->setData(Qt::DisplayRole, QVariant(tr("Warning (0)")));
     warningTracker->setData(Qt::DecorationRole, style()->standardIcon(QStyle::SP_MessageBoxWarning));
-    m_trackers.insert("", QStringList());
+
+    const BitTorrent::TrackerHostIndex *trackerHostIndex = BitTorrent::Session::instance()->trackerHostIndex();
+    for (const QString &host : asConst(trackerHostIndex->hosts()))
+        addHost(host, {});
+    updateHost({});
+    updateErroredCount();
+    updateWarnedCount();
+
+    connect(trackerHostIndex, &BitTorrent::TrackerHostIndex::hostAdded, this, &TrackerFiltersList::addHost);
+    connect(trackerHostIndex, &BitTorrent::TrackerHostIndex::hostRemoved, this, &TrackerFiltersList::removeHost);
+    connect(trackerHostIndex, &BitTorrent::TrackerHostIndex::hostTorrentsChanged, this, &TrackerFiltersList::updateHost);
+    connect(trackerHostIndex, &BitTorrent::TrackerHostIndex::erroredTorrentsChanged, this, &TrackerFiltersList::updateErroredCount);
+    connect(trackerHostIndex, &BitTorrent::TrackerHostIndex::warnedTorrentsChanged, this, &TrackerFiltersList::updateWarnedCount);
 
     setCurrentRow(0, QItemSelectionModel::SelectCurrent);
     toggleFilter(Preferences::instance()->getTrackerFilterState());
@@ -243,54 +264,24 @@ TrackerFiltersList::~TrackerFiltersList()
         Utils::Fs::forceRemove(iconPath);
 }
 
-void TrackerFiltersList::addItem(const QString &tracker, const QString &hash)
+void TrackerFiltersList::addHost(const QString &host, const QString &trackerUrl)
 {
-    QStringList tmp;
-    QListWidgetItem *trackerItem = nullptr;
-    QString host = getHost(tracker);
-    bool exists = m_trackers.contains(host);
+    if (m_hostItems.contains(host)) return;
 
-    if (exists) {
-        tmp = m_trackers.value(host);
-        if (tmp.contains(hash))
-            return;
+    auto *trackerItem = new QListWidgetItem;
+    trackerItem->setData(Qt::DecorationRole, UIThemeManager::instance()->getIcon("network-server"));
+    trackerItem->setData(Qt::UserRole, host);
+    trackerItem->setText(QString("%1 (%2)").arg(host).arg(trackerHostIndex()->torrentCount(host)));
+    m_hostItems.insert(host, trackerItem);
 
-        if (host != "") {
-            trackerItem = item(rowFromTracker(host));
-        }
-        else {
-            trackerItem = item(1);
-        }
-    }
-    else {
-        trackerItem = new QListWidgetItem();
-        trackerItem->setData(Qt::DecorationRole, UIThemeManager::instance()->getIcon("network-server"));
+    const QString scheme = getScheme(trackerUrl);
+    downloadFavicon(QString("%1://%2/favicon.ico").arg((scheme.startsWith("http") ? scheme : "http"), host));
 
-        const QString scheme = getScheme(tracker);
-        downloadFavicon(QString("%1://%2/favicon.ico").arg((scheme.startsWith("http") ? scheme : "http"), host));
-    }
-    if (!trackerItem) return;
-
-    tmp.append(hash);
-    m_trackers.insert(host, tmp);
-    if (host == "") {
-        trackerItem->setText(tr("Trackerless (%1)").arg(tmp.size()));
-        if (currentRow() == 1)
-            applyFilter(1);
-        return;
-    }
-
-    trackerItem->setText(QString("%1 (%2)").arg(host).arg(tmp.size()));
-    if (exists) {
-        if (currentRow() == rowFromTracker(host))
-            applyFilter(currentRow());
-        return;
-    }
-
-    Q_ASSERT(count() >= 4);
+    // Keep the list sorted
+    Q_ASSERT(count() >= FIRST_HOST_ROW);
     int insPos = count();
-    for (int i = 4; i < count(); ++i) {
-        if (Utils::String::naturalLessThan<Qt::CaseSensitive>(host, item(i)->text())) {
+    for (int i = FIRST_HOST_ROW; i < count(); ++i) {
+        if (Utils::String::naturalLessThan<Qt::CaseSensitive>(host, hostFromRow(i))) {
             insPos = i;
             break;
         }
@@ -299,50 +290,47 @@ void TrackerFiltersList::addItem(const QString &tracker, const QString &hash)
     updateGeometry();
 }
 
-void TrackerFiltersList::removeItem(const QString &tracker, const QString &hash)
+void TrackerFiltersList::removeHost(const QString &host)
 {
-    QString host = getHost(tracker);
-    QListWidgetItem *trackerItem = nullptr;
-    QStringList tmp = m_trackers.value(host);
-    int row = 0;
+    QListWidgetItem *trackerItem = m_hostItems.take(host);
+    if (!trackerItem) return;
 
-    if (tmp.empty())
-        return;
-    tmp.removeAll(hash);
-
-    if (!host.isEmpty()) {
-        // Remove from 'Error' and 'Warning' view
-        trackerSuccess(hash, tracker);
-        row = rowFromTracker(host);
-        trackerItem = item(row);
-        if (tmp.empty()) {
-            if (currentRow() == row)
-                setCurrentRow(0, QItemSelectionModel::SelectCurrent);
-            delete trackerItem;
-            m_trackers.remove(host);
-            updateGeometry();
-            return;
-        }
-        if (trackerItem != nullptr)
-            trackerItem->setText(QString("%1 (%2)").arg(host).arg(tmp.size()));
+    if (currentItem() == trackerItem)
+        setCurrentRow(0, QItemSelectionModel::SelectCurrent);
+    delete trackerItem;
+    updateGeometry();
+}
+
+void TrackerFiltersList::updateHost(const QString &host)
+{
+    const int torrentCount = trackerHostIndex()->torrentCount(host);
+    QListWidgetItem *trackerItem = nullptr;
+    if (host.isEmpty()) {
+        trackerItem = item(TRACKERLESS_ROW);
+        trackerItem->setText(tr("Trackerless (%1)").arg(torrentCount));
     }
     else {
-        row = 1;
-        trackerItem = item(1);
-        trackerItem->setText(tr("Trackerless (%1)").arg(tmp.size()));
+        trackerItem = m_hostItems.value(host);
+        if (!trackerItem) return;
+        trackerItem->setText(QString("%1 (%2)").arg(host).arg(torrentCount));
     }
 
-    m_trackers.insert(host, tmp);
-    if (currentRow() == row)
-        applyFilter(row);
+    if (currentItem() == trackerItem)
+        applyFilter(currentRow());
 }
 
-void TrackerFiltersList::changeTrackerless(bool trackerless, const QString &hash)
+void TrackerFiltersList::updateErroredCount()
 {
-    if (trackerless)
-        addItem("", hash);
-    else
-        removeItem("", hash);
+    item(ERROR_ROW)->setText(tr("Error (%1)").arg(trackerHostIndex()->erroredTorrentCount()));
+    if (currentRow() == ERROR_ROW)
+        applyFilter(ERROR_ROW);
+}
+
+void TrackerFiltersList::updateWarnedCount()
+{
+    item(WARNING_ROW)->setText(tr("Warning (%1)").arg(trackerHostIndex()->warnedTorrentCount()));
+    if (currentRow() == WARNING_ROW)
+        applyFilter(WARNING_ROW);
 }
 
 void TrackerFiltersList::setDownloadTrackerFavicon(bool value)
@@ -351,79 +339,11 @@ void TrackerFiltersList::setDownloadTrackerFavicon(bool value)
     m_downloadTrackerFavicon = value;
 
     if (m_downloadTrackerFavicon) {
-        for (auto i = m_trackers.cbegin(); i != m_trackers.cend(); ++i) {
-            const QString &tracker = i.key();
-            if (!tracker.isEmpty()) {
-                const QString scheme = getScheme(tracker);
-                downloadFavicon(QString("%1://%2/favicon.ico")
-                                .arg((scheme.startsWith("http") ? scheme : "http"), getHost(tracker)));
-             }
-        }
-    }
-}
-
-void TrackerFiltersList::trackerSuccess(const QString &hash, const QString &tracker)
-{
-    QStringList errored = m_errors.value(hash);
-    QStringList warned = m_warnings.value(hash);
-
-    if (errored.contains(tracker)) {
-        errored.removeAll(tracker);
-        if (errored.empty()) {
-            m_errors.remove(hash);
-            item(2)->setText(tr("Error (%1)").arg(m_errors.size()));
-            if (currentRow() == 2)
-                applyFilter(2);
-        }
-        else {
-            m_errors.insert(hash, errored);
-        }
-    }
-
-    if (warned.contains(tracker)) {
-        warned.removeAll(tracker);
-        if (warned.empty()) {
-            m_warnings.remove(hash);
-            item(3)->setText(tr("Warning (%1)").arg(m_warnings.size()));
-            if (currentRow() == 3)
-                applyFilter(3);
-        }
-        else {
-            m_warnings.insert(hash, warned);
-        }
+        for (auto i = m_hostItems.cbegin(); i != m_hostItems.cend(); ++i)
+            downloadFavicon(QString("http://%1/favicon.ico").arg(i.key()));
     }
 }
 
-void TrackerFiltersList::trackerError(const QString &hash, const QString &tracker)
-{
-    QStringList trackers = m_errors.value(hash);
-
-    if (trackers.contains(tracker))
-        return;
-
-    trackers.append(tracker);
-    m_errors.insert(hash, trackers);
-    item(2)->setText(tr("Error (%1)").arg(m_errors.size()));
-
-    if (currentRow() == 2)
-        applyFilter(2);
-}
-
-void TrackerFiltersList::trackerWarning(const QString &hash, const QString &tracker)
-{
-    QStringList trackers = m_warnings.value(hash);
-
-    if (trackers.contains(tracker))
-        return;
-
-    trackers.append(tracker);
-    m_warnings.insert(hash, trackers);
-    item(3)->setText(tr("Warning (%1)").arg(m_warnings.size()));
-
-    if (currentRow() == 3)
-        applyFilter(3);
-}
-
 void TrackerFiltersList::downloadFavicon(const QString &url)
 {
     if (!m_downloadTrackerFavicon) return;
@@ -440,16 +360,12 @@ void TrackerFiltersList::handleFavicoDownloadFinished(const Net::DownloadResult
         return;
     }
 
-    const QString host = getHost(result.url);
-
-    if (!m_trackers.contains(host)) {
+    QListWidgetItem *trackerItem = m_hostItems.value(BitTorrent::TrackerHostIndex::hostFromUrl(result.url));
+    if (!trackerItem) {
         Utils::Fs::forceRemove(result.filePath);
         return;
     }
 
-    QListWidgetItem *trackerItem = item(rowFromTracker(host));
-    if (!trackerItem) return;
-
     QIcon icon(result.filePath);
     //Detect a non-decodable icon
     QList<QSize> sizes = icon.availableSizes();
@@ -484,84 +400,45 @@ void TrackerFiltersList::showMenu(const QPoint &)
 
 void TrackerFiltersList::applyFilter(int row)
 {
-    if (row == 0)
+    if (row == ALL_ROW)
         transferList->applyTrackerFilterAll();
     else if (isVisible())
         transferList->applyTrackerFilter(getHashes(row));
 }
 
-void TrackerFiltersList::handleNewTorrent(BitTorrent::TorrentHandle *const torrent)
+void TrackerFiltersList::handleNewTorrent(BitTorrent::TorrentHandle *const)
 {
-    QString hash = torrent->hash();
-    const QVector<BitTorrent::TrackerEntry> trackers = torrent->trackers();
-    for (const BitTorrent::TrackerEntry &tracker : trackers)
-        addItem(tracker.url(), hash);
-
-    //Check for trackerless torrent
-    if (trackers.isEmpty())
-        addItem("", hash);
-
-    item(0)->setText(tr("All (%1)", "this is for the tracker filter").arg(++m_totalTorrents));
+    item(ALL_ROW)->setText(tr("All (%1)", "this is for the tracker filter").arg(++m_totalTorrents));
 }
 
-void TrackerFiltersList::torrentAboutToBeDeleted(BitTorrent::TorrentHandle *const torrent)
+void TrackerFiltersList::torrentAboutToBeDeleted(BitTorrent::TorrentHandle *const)
 {
-    QString hash = torrent->hash();
-    const QVector<BitTorrent::TrackerEntry> trackers = torrent->trackers();
-    for (const BitTorrent::TrackerEntry &tracker : trackers)
-        removeItem(tracker.url(), hash);
-
-    //Check for trackerless torrent
-    if (trackers.isEmpty())
-        removeItem("", hash);
-
-    item(0)->setText(tr("All (%1)", "this is for the tracker filter").arg(--m_totalTorrents));
+    item(ALL_ROW)->setText(tr("All (%1)", "this is for the tracker filter").arg(--m_totalTorrents));
 }
 
-QString TrackerFiltersList::trackerFromRow(int row) const
+QString TrackerFiltersList::hostFromRow(int row) const
 {
-    Q_ASSERT(row > 1);
-    const QString tracker = item(row)->text();
-    QStringList parts = tracker.split(' ');
-    Q_ASSERT(parts.size() >= 2);
-    parts.removeLast(); // Remove trailing number
-    return parts.join(' ');
+    Q_ASSERT(row >= FIRST_HOST_ROW);
+    return item(row)->data(Qt::UserRole).toString();
 }
 
-int TrackerFiltersList::rowFromTracker(const QString &tracker) const
+QSet<QString> TrackerFiltersList::getHashes(int row) const
 {
-    Q_ASSERT(!tracker.isEmpty());
-    for (int i = 4; i<count(); ++i)
-        if (tracker == trackerFromRow(i)) return i;
-    return -1;
-}
-
-QString TrackerFiltersList::getHost(const QString &tracker) const
-{
-    QUrl url(tracker);
-    QString longHost = url.host();
-    QString tld = url.topLevelDomain();
-    // We get empty tld when it is invalid or an IPv4/IPv6 address,
-    // so just return the full host
-    if (tld.isEmpty())
-        return longHost;
-    // We want the domain + tld. Subdomains should be disregarded
-    int index = longHost.lastIndexOf('.', -(tld.size() + 1));
-    if (index == -1)
-        return longHost;
-    return longHost.mid(index + 1);
+    switch (row) {
+    case TRACKERLESS_ROW:
+        return trackerHostIndex()->torrents({});
+    case ERROR_ROW:
+        return trackerHostIndex()->erroredTorrents();
+    case WARNING_ROW:
+        return trackerHostIndex()->warnedTorrents();
+    default:
+        return trackerHostIndex()->torrents(hostFromRow(row));
+    }
 }
 
-QStringList TrackerFiltersList::getHashes(int row)
+const BitTorrent::TrackerHostIndex *TrackerFiltersList::trackerHostIndex()
 {
-    if (row == 1)
-        return m_trackers.value("");
-    if (row == 2)
-        return m_errors.keys();
-    if (row == 3)
-        return m_warnings.keys();
-
-     return m_trackers.value(trackerFromRow(row));
+    return BitTorrent::Session::instance()->trackerHostIndex();
 }
 
 TransferListFiltersWidget::TransferListFiltersWidget(QWidget *parent, TransferListWidget *transferList, const bool downloadFavicon)
@@ -651,13 +528,6 @@ TransferListFiltersWidget::TransferListFiltersWidget(QWidget *parent, TransferLi
     connect(statusLabel, &QCheckBox::toggled, pref, &Preferences::setStatusFilterState);
     connect(trackerLabel, &QCheckBox::toggled, m_trackerFilters, &TrackerFiltersList::toggleFilter);
     connect(trackerLabel, &QCheckBox::toggled, pref, &Preferences::setTrackerFilterState);
-
-    connect(this, qOverload<const QString &, const QString &>(&TransferListFiltersWidget::trackerSuccess)
-            , m_trackerFilters, &TrackerFiltersList::trackerSuccess);
-    connect(this, qOverload<const QString &, const QString &>(&TransferListFiltersWidget::trackerError)
-            , m_trackerFilters, &TrackerFiltersList::trackerError);
-    connect(this, qOverload<const QString &, const QString &>(&TransferListFiltersWidget::trackerWarning)
-            , m_trackerFilters, &TrackerFiltersList::trackerWarning);
 }
 
 void TransferListFiltersWidget::setDownloadTrackerFavicon(bool value)
@@ -665,38 +535,6 @@ void TransferListFiltersWidget::setDownloadTrackerFavicon(bool value)
     m_trackerFilters->setDownloadTrackerFavicon(value);
 }
 
-void TransferListFiltersWidget::addTrackers(BitTorrent::TorrentHandle *const torrent, const QVector<BitTorrent::TrackerEntry> &trackers)
-{
-    for (const BitTorrent::TrackerEntry &tracker : trackers)
-        m_trackerFilters->addItem(tracker.url(), torrent->hash());
-}
-
-void TransferListFiltersWidget::removeTrackers(BitTorrent::TorrentHandle *const torrent, const QVector<BitTorrent::TrackerEntry> &trackers)
-{
-    for (const BitTorrent::TrackerEntry &tracker : trackers)
-        m_trackerFilters->removeItem(tracker.url(), torrent->hash());
-}
-
-void TransferListFiltersWidget::changeTrackerless(BitTorrent::TorrentHandle *const torrent, bool trackerless)
-{
-    m_trackerFilters->changeTrackerless(trackerless, torrent->hash());
-}
-
-void TransferListFiltersWidget::trackerSuccess(BitTorrent::TorrentHandle *const torrent, const QString &tracker)
-{
-    emit trackerSuccess(torrent->hash(), tracker);
-}
-
-void TransferListFiltersWidget::trackerWarning(BitTorrent::TorrentHandle *const torrent, const QString &tracker)
-{
-    emit trackerWarning(torrent->hash(), tracker);
-}
-
-void TransferListFiltersWidget::trackerError(BitTorrent::TorrentHandle *const torrent, const QString &tracker)
-{
-    emit trackerError(torrent->hash(), tracker);
-}
-
 void TransferListFiltersWidget::onCategoryFilterStateChanged(bool enabled)
 {
     toggleCategoryFilter(enabled);
@@ -30,7 +30,9 @@
 #define TRANSFERLISTFILTERSWIDGET_H
 
 #include <QFrame>
+#include <QHash>
 #include <QListWidget>
+#include <QSet>
 
 class QCheckBox;
 class QResizeEvent;
@@ -40,7 +42,7 @@ class TransferListWidget;
 namespace BitTorrent
 {
     class TorrentHandle;
-    class TrackerEntry;
+    class TrackerHostIndex;
 }
 
 namespace Net
@@ -102,18 +104,14 @@ public:
     TrackerFiltersList(QWidget *parent, TransferListWidget *transferList, bool downloadFavicon);
     ~TrackerFiltersList() override;
 
-    // Redefine addItem() to make sure the list stays sorted
-    void addItem(const QString &tracker, const QString &hash);
-    void removeItem(const QString &tracker, const QString &hash);
-    void changeTrackerless(bool trackerless, const QString &hash);
     void setDownloadTrackerFavicon(bool value);
 
-public slots:
-    void trackerSuccess(const QString &hash, const QString &tracker);
-    void trackerError(const QString &hash, const QString &tracker);
-    void trackerWarning(const QString &hash, const QString &tracker);
-
 private slots:
+    void addHost(const QString &host, const QString &trackerUrl);
+    void removeHost(const QString &host);
+    void updateHost(const QString &host);
+    void updateErroredCount();
+    void updateWarnedCount();
     void handleFavicoDownloadFinished(const Net::DownloadResult &result);
 
 private:
@@ -123,15 +121,13 @@ private:
     void applyFilter(int row) override;
     void handleNewTorrent(BitTorrent::TorrentHandle *const torrent) override;
     void torrentAboutToBeDeleted(BitTorrent::TorrentHandle *const torrent) override;
-    QString trackerFromRow(int row) const;
-    int rowFromTracker(const QString &tracker) const;
-    QString getHost(const QString &tracker) const;
-    QStringList getHashes(int row);
+    QString hostFromRow(int row) const;
+    QSet<QString> getHashes(int row) const;
     void downloadFavicon(const QString &url);
 
-    QHash<QString, QStringList> m_trackers;
-    QHash<QString, QStringList> m_errors;
-    QHash<QString, QStringList> m_warnings;
+    static const BitTorrent::TrackerHostIndex *trackerHostIndex();
+
+    QHash<QString, QListWidgetItem *> m_hostItems;
     QStringList m_iconPaths;
     int m_totalTorrents;
     bool m_downloadTrackerFavicon;
@@ -148,19 +144,6 @@ public:
     TransferListFiltersWidget(QWidget *parent, TransferListWidget *transferList, bool downloadFavicon);
     void setDownloadTrackerFavicon(bool value);
 
-public slots:
-    void addTrackers(BitTorrent::TorrentHandle *const torrent, const QVector<BitTorrent::TrackerEntry> &trackers);
-    void removeTrackers(BitTorrent::TorrentHandle *const torrent, const QVector<BitTorrent::TrackerEntry> &trackers);
-    void changeTrackerless(BitTorrent::TorrentHandle *const torrent, bool trackerless);
-    void trackerSuccess(BitTorrent::TorrentHandle *const torrent, const QString &tracker);
-    void trackerWarning(BitTorrent::TorrentHandle *const torrent, const QString &tracker);
-    void trackerError(BitTorrent::TorrentHandle *const torrent, const QString &tracker);
-
-signals:
-    void trackerSuccess(const QString &hash, const QString &tracker);
-    void trackerError(const QString &hash, const QString &tracker);
-    void trackerWarning(const QString &hash, const QString &tracker);
-
 private slots:
     void onCategoryFilterStateChanged(bool enabled);
     void onTagFilterStateChanged(bool enabled);
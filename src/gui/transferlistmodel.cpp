@@ -29,11 +29,14 @@
 
 #include "transferlistmodel.h"
 
+#include <algorithm>
+
 #include <QApplication>
 #include <QDateTime>
 #include <QDebug>
 #include <QIcon>
 #include <QPalette>
+#include <QSet>
 
 #include "base/bittorrent/session.h"
 #include "base/bittorrent/torrenthandle.h"
@@ -55,6 +58,51 @@ static QIcon getErrorIcon();
 
 static bool isDarkTheme();
 
+namespace
+{
+    // Cache slots following the per-column DisplayRole values
+    enum CacheSlot
+    {
+        SLOT_TOTAL_SEEDS = TransferListModel::NB_COLUMNS,
+        SLOT_TOTAL_PEERS,
+        SLOT_SEEDING_TIME,
+        SLOT_HASH,
+
+        NB_CACHE_SLOTS
+    };
+
+    int columnOfSlot(const int slot)
+    {
+        switch (slot) {
+        case SLOT_TOTAL_SEEDS:
+            return TransferListModel::TR_SEEDS;
+        case SLOT_TOTAL_PEERS:
+            return TransferListModel::TR_PEERS;
+        case SLOT_SEEDING_TIME:
+            return TransferListModel::TR_TIME_ELAPSED;
+        case SLOT_HASH:
+            return TransferListModel::TR_NAME;
+        default:
+            return slot;
+        }
+    }
+
+    // Slots that change as time goes by even if the torrent status doesn't
+    const int TIME_SLOTS[] = {
+        TransferListModel::TR_ETA,
+        TransferListModel::TR_TIME_ELAPSED,
+        TransferListModel::TR_LAST_ACTIVITY,
+        SLOT_SEEDING_TIME
+    };
+
+    // Limits are queried synchronously from libtorrent so they are
+    // neither cached nor tracked, their cells are refreshed on repaint
+    bool isCachedColumn(const int column)
+    {
+        return ((column != TransferListModel::TR_DLLIMIT) && (column != TransferListModel::TR_UPLIMIT));
+    }
+}
+
 // TransferListModel
 
 TransferListModel::TransferListModel(QObject *parent)
@@ -62,12 +110,11 @@ TransferListModel::TransferListModel(QObject *parent)
 {
     // Load the torrents
     using namespace BitTorrent;
-    for (TorrentHandle *const torrent : asConst(Session::instance()->torrents()))
-        addTorrent(torrent);
+    addTorrents(Session::instance()->torrents().values().toVector());
 
     // Listen for torrent changes
     connect(Session::instance(), &Session::torrentAdded, this, &TransferListModel::addTorrent);
-    connect(Session::instance(), &Session::torrentAboutToBeRemoved, this, &TransferListModel::handleTorrentAboutToBeRemoved);
+    connect(Session::instance(), &Session::torrentsAboutToBeRemoved, this, &TransferListModel::handleTorrentsAboutToBeRemoved);
     connect(Session::instance(), &Session::torrentsUpdated, this, &TransferListModel::handleTorrentsUpdated);
 
     connect(Session::instance(), &Session::torrentFinished, this, &TransferListModel::handleTorrentStatusUpdated);
@@ -75,6 +122,10 @@ TransferListModel::TransferListModel(QObject *parent)
     connect(Session::instance(), &Session::torrentResumed, this, &TransferListModel::handleTorrentStatusUpdated);
     connect(Session::instance(), &Session::torrentPaused, this, &TransferListModel::handleTorrentStatusUpdated);
     connect(Session::instance(), &Session::torrentFinishedChecking, this, &TransferListModel::handleTorrentStatusUpdated);
+    connect(Session::instance(), &Session::torrentSavePathChanged, this, &TransferListModel::handleTorrentStatusUpdated);
+    connect(Session::instance(), &Session::torrentCategoryChanged, this, &TransferListModel::handleTorrentStatusUpdated);
+    connect(Session::instance(), &Session::torrentTagAdded, this, &TransferListModel::handleTorrentStatusUpdated);
+    connect(Session::instance(), &Session::torrentTagRemoved, this, &TransferListModel::handleTorrentStatusUpdated);
 }
 
 int TransferListModel::rowCount(const QModelIndex &index) const
@@ -176,7 +227,12 @@ QVariant TransferListModel::data(const QModelIndex &index, int role) const
     if ((role != Qt::DisplayRole) && (role != Qt::UserRole))
         return {};
 
-    switch (index.column()) {
+    return value(torrent, index.column(), role);
+}
+
+QVariant TransferListModel::value(const BitTorrent::TorrentHandle *torrent, const int column, const int role) const
+{
+    switch (column) {
     case TR_NAME:
         return torrent->name();
     case TR_QUEUE_POSITION:
@@ -249,6 +305,106 @@ QVariant TransferListModel::data(const QModelIndex &index, int role) const
     return {};
 }
 
+TransferListModel::CachedValues TransferListModel::fetchValues(const BitTorrent::TorrentHandle *torrent) const
+{
+    CachedValues values(NB_CACHE_SLOTS);
+    for (int column = 0; column < NB_COLUMNS; ++column) {
+        if (isCachedColumn(column))
+            values[column] = value(torrent, column, Qt::DisplayRole);
+    }
+    values[SLOT_TOTAL_SEEDS] = value(torrent, TR_SEEDS, Qt::UserRole);
+    values[SLOT_TOTAL_PEERS] = value(torrent, TR_PEERS, Qt::UserRole);
+    values[SLOT_SEEDING_TIME] = value(torrent, TR_TIME_ELAPSED, Qt::UserRole);
+    values[SLOT_HASH] = QString(torrent->hash());
+    return values;
+}
+
+// Updates the time based slots of the given values,
+// returns false if none of them changed
+bool TransferListModel::fetchTimeValues(const BitTorrent::TorrentHandle *torrent, CachedValues &values) const
+{
+    bool changed = false;
+    for (const int slot : TIME_SLOTS) {
+        const QVariant newValue = (slot == SLOT_SEEDING_TIME)
+            ? value(torrent, TR_TIME_ELAPSED, Qt::UserRole)
+            : value(torrent, slot, Qt::DisplayRole);
+        // values stay shared with the cache unless something changed
+        if (values.at(slot) != newValue) {
+            values[slot] = newValue;
+            changed = true;
+        }
+    }
+    return changed;
+}
+
+QVariant TransferListModel::cachedData(const int row, const int column, const int role) const
+{
+    if ((row < 0) || (row >= m_cachedRows.size()) || (column < 0) || (column >= NB_COLUMNS))
+        return {};
+
+    if (!isCachedColumn(column))
+        return value(m_torrents.at(row), column, role);
+
+    const CachedValues &values = m_cachedRows.at(row).values;
+    if (role == Qt::UserRole) {
+        switch (column) {
+        case TR_SEEDS:
+            return values.at(SLOT_TOTAL_SEEDS);
+        case TR_PEERS:
+            return values.at(SLOT_TOTAL_PEERS);
+        case TR_TIME_ELAPSED:
+            return values.at(SLOT_SEEDING_TIME);
+        default:
+            break;
+        }
+    }
+
+    return values.at(column);
+}
+
+QString TransferListModel::cachedHash(const int row) const
+{
+    if ((row < 0) || (row >= m_cachedRows.size()))
+        return {};
+
+    return m_cachedRows.at(row).values.at(SLOT_HASH).toString();
+}
+
+const Utils::String::NaturalSortKey &TransferListModel::naturalSortKey(const int row, const int column) const
+{
+    static const Utils::String::NaturalSortKey emptyKey;
+    if ((row < 0) || (row >= m_cachedRows.size()))
+        return emptyKey;
+
+    const CachedRow &cachedRow = m_cachedRows.at(row);
+    switch (column) {
+    case TR_NAME:
+        return cachedRow.nameSortKey;
+    case TR_CATEGORY:
+        return cachedRow.categorySortKey;
+    case TR_TAGS:
+        return cachedRow.tagsSortKey;
+    default:
+        return emptyKey;
+    }
+}
+
+// Natural sort keys are costly to build so they are only rebuilt when the text changes
+void TransferListModel::updateSortKeys(CachedRow &cachedRow, const CachedValues &oldValues)
+{
+    const auto needsUpdate = [&cachedRow, &oldValues](const int column)
+    {
+        return (oldValues.isEmpty() || (cachedRow.values.at(column) != oldValues.at(column)));
+    };
+
+    if (needsUpdate(TR_NAME))
+        cachedRow.nameSortKey = {cachedRow.values.at(TR_NAME).toString(), Qt::CaseInsensitive};
+    if (needsUpdate(TR_CATEGORY))
+        cachedRow.categorySortKey = {cachedRow.values.at(TR_CATEGORY).toString(), Qt::CaseInsensitive};
+    if (needsUpdate(TR_TAGS))
+        cachedRow.tagsSortKey = {cachedRow.values.at(TR_TAGS).toString(), Qt::CaseInsensitive};
+}
+
 bool TransferListModel::setData(const QModelIndex &index, const QVariant &value, int role)
 {
     qDebug() << Q_FUNC_INFO << value;
@@ -270,17 +426,137 @@ bool TransferListModel::setData(const QModelIndex &index, const QVariant &value,
         return false;
     }
 
+    refreshRows({index.row()});
     return true;
 }
 
 void TransferListModel::addTorrent(BitTorrent::TorrentHandle *const torrent)
 {
-    if (m_torrents.indexOf(torrent) == -1) {
-        const int row = m_torrents.size();
-        beginInsertRows(QModelIndex(), row, row);
+    // Torrents tend to be added in bursts (on startup, by RSS or by the watched folders)
+    // so they are collected and inserted together once control returns to the event loop
+    m_pendingTorrents << torrent;
+    if (m_pendingTorrents.size() == 1)
+        QMetaObject::invokeMethod(this, "addPendingTorrents", Qt::QueuedConnection);
+}
+
+void TransferListModel::addPendingTorrents()
+{
+    const QVector<BitTorrent::TorrentHandle *> torrents = m_pendingTorrents;
+    m_pendingTorrents.clear();
+    addTorrents(torrents);
+}
+
+void TransferListModel::addTorrents(const QVector<BitTorrent::TorrentHandle *> &torrents)
+{
+    QVector<BitTorrent::TorrentHandle *> newTorrents;
+    newTorrents.reserve(torrents.size());
+    QSet<BitTorrent::TorrentHandle *> seenTorrents;
+    for (BitTorrent::TorrentHandle *const torrent : torrents) {
+        if (!m_torrentRows.contains(torrent) && !seenTorrents.contains(torrent)) {
+            seenTorrents.insert(torrent);
+            newTorrents << torrent;
+        }
+    }
+
+    if (newTorrents.isEmpty()) return;
+
+    const int firstRow = m_torrents.size();
+    beginInsertRows(QModelIndex(), firstRow, (firstRow + newTorrents.size() - 1));
+    m_torrents.reserve(firstRow + newTorrents.size());
+    m_cachedRows.reserve(firstRow + newTorrents.size());
+    for (BitTorrent::TorrentHandle *const torrent : asConst(newTorrents)) {
+        m_torrentRows.insert(torrent, m_torrents.size());
         m_torrents << torrent;
-        endInsertRows();
+        CachedRow cachedRow;
+        cachedRow.values = fetchValues(torrent);
+        updateSortKeys(cachedRow, {});
+        m_cachedRows << cachedRow;
     }
+    endInsertRows();
+}
+
+void TransferListModel::removeTorrents(const QVector<BitTorrent::TorrentHandle *> &torrents)
+{
+    QVector<int> rows;
+    rows.reserve(torrents.size());
+    for (BitTorrent::TorrentHandle *const torrent : torrents) {
+        const int row = m_torrentRows.value(torrent, -1);
+        if (row >= 0)
+            rows << row;
+        else
+            m_pendingTorrents.removeAll(torrent);
+    }
+
+    if (rows.isEmpty()) return;
+
+    std::sort(rows.begin(), rows.end());
+    rows.erase(std::unique(rows.begin(), rows.end()), rows.end());
+
+    // Scattered rows are gathered at the end first, so that
+    // they can be removed as a single range in any case
+    int firstRow = rows.first();
+    if ((rows.last() - rows.first() + 1) != rows.size()) {
+        moveRowsToEnd(rows);
+        firstRow = m_torrents.size() - rows.size();
+    }
+    const int lastRow = firstRow + rows.size() - 1;
+
+    beginRemoveRows(QModelIndex(), firstRow, lastRow);
+    for (int row = firstRow; row <= lastRow; ++row)
+        m_torrentRows.remove(m_torrents.at(row));
+    m_torrents.erase((m_torrents.begin() + firstRow), (m_torrents.begin() + lastRow + 1));
+    m_cachedRows.erase((m_cachedRows.begin() + firstRow), (m_cachedRows.begin() + lastRow + 1));
+    updateRowMap(firstRow);
+    endRemoveRows();
+}
+
+// Moves the given (sorted) rows to the end, preserving the order of the other rows
+void TransferListModel::moveRowsToEnd(const QVector<int> &rows)
+{
+    emit layoutAboutToBeChanged();
+
+    const int rowCount = m_torrents.size();
+    QVector<int> newRows(rowCount);
+    QVector<BitTorrent::TorrentHandle *> torrents;
+    QVector<CachedRow> cachedRows;
+    torrents.reserve(rowCount);
+    cachedRows.reserve(rowCount);
+
+    const auto moveRow = [&](const int row)
+    {
+        newRows[row] = torrents.size();
+        torrents << m_torrents.at(row);
+        cachedRows << std::move(m_cachedRows[row]);
+    };
+
+    auto movedRowIter = rows.cbegin();
+    for (int row = 0; row < rowCount; ++row) {
+        if ((movedRowIter != rows.cend()) && (*movedRowIter == row))
+            ++movedRowIter;
+        else
+            moveRow(row);
+    }
+    for (const int row : rows)
+        moveRow(row);
+
+    m_torrents = torrents;
+    m_cachedRows = cachedRows;
+    updateRowMap(rows.first());
+
+    const QModelIndexList oldIndexes = persistentIndexList();
+    QModelIndexList newIndexes;
+    newIndexes.reserve(oldIndexes.size());
+    for (const QModelIndex &oldIndex : oldIndexes)
+        newIndexes << index(newRows.at(oldIndex.row()), oldIndex.column());
+    changePersistentIndexList(oldIndexes, newIndexes);
+
+    emit layoutChanged();
+}
+
+void TransferListModel::updateRowMap(const int from)
+{
+    for (int row = from; row < m_torrents.size(); ++row)
+        m_torrentRows[m_torrents.at(row)] = row;
 }
 
 Qt::ItemFlags TransferListModel::flags(const QModelIndex &index) const
@@ -298,26 +574,114 @@ BitTorrent::TorrentHandle *TransferListModel::torrentHandle(const QModelIndex &i
     return m_torrents.value(index.row());
 }
 
-void TransferListModel::handleTorrentAboutToBeRemoved(BitTorrent::TorrentHandle *const torrent)
+void TransferListModel::handleTorrentsAboutToBeRemoved(const QVector<BitTorrent::TorrentHandle *> &torrents)
 {
-    const int row = m_torrents.indexOf(torrent);
-    if (row >= 0) {
-        beginRemoveRows(QModelIndex(), row, row);
-        m_torrents.removeAt(row);
-        endRemoveRows();
-    }
+    removeTorrents(torrents);
 }
 
 void TransferListModel::handleTorrentStatusUpdated(BitTorrent::TorrentHandle *const torrent)
 {
-    const int row = m_torrents.indexOf(torrent);
+    const int row = m_torrentRows.value(torrent, -1);
     if (row >= 0)
-        emit dataChanged(index(row, 0), index(row, columnCount() - 1));
+        refreshRows({row});
+}
+
+void TransferListModel::handleTorrentsUpdated(const QVector<BitTorrent::TorrentHandle *> &torrents)
+{
+    QVector<bool> isUpdated(m_torrents.size(), false);
+    QVector<int> rows;
+    rows.reserve(torrents.size());
+    for (BitTorrent::TorrentHandle *const torrent : torrents) {
+        const int row = m_torrentRows.value(torrent, -1);
+        if (row >= 0) {
+            rows << row;
+            isUpdated[row] = true;
+        }
+    }
+
+    refreshRows(rows);
+
+    // The idle torrents aren't reported but their time based columns still change
+    QVector<int> idleRows;
+    idleRows.reserve(m_torrents.size() - rows.size());
+    for (int row = 0; row < m_torrents.size(); ++row) {
+        if (!isUpdated[row])
+            idleRows << row;
+    }
+
+    refreshRows(idleRows, true);
 }
 
-void TransferListModel::handleTorrentsUpdated()
+// Compares the current values of the given rows against the cached ones
+// and emits dataChanged() only for the cells that actually changed, so that
+// the sort/filter proxy model has to re-position only the affected rows and
+// skips re-sorting entirely if the sort column didn't change.
+// Only the time based columns are fetched if timeColumnsOnly is set.
+void TransferListModel::refreshRows(QVector<int> rows, const bool timeColumnsOnly)
 {
-    emit dataChanged(index(0, 0), index(rowCount() - 1, columnCount() - 1));
+    std::sort(rows.begin(), rows.end());
+    rows.erase(std::unique(rows.begin(), rows.end()), rows.end());
+
+    // Adjacent changed rows are reported as a single range
+    int firstRow = -1;
+    int lastRow = -1;
+    int firstColumn = 0;
+    int lastColumn = 0;
+    const auto emitRange = [&]()
+    {
+        if (firstRow >= 0)
+            emit dataChanged(index(firstRow, firstColumn), index(lastRow, lastColumn));
+    };
+
+    for (const int row : asConst(rows)) {
+        CachedRow &cachedRow = m_cachedRows[row];
+        const CachedValues &cachedValues = cachedRow.values;
+
+        CachedValues values;
+        if (timeColumnsOnly) {
+            values = cachedValues;
+            if (!fetchTimeValues(m_torrents.at(row), values))
+                continue;
+        }
+        else {
+            values = fetchValues(m_torrents.at(row));
+        }
+
+        int changedFirst = NB_COLUMNS;
+        int changedLast = -1;
+        for (int slot = 0; slot < NB_CACHE_SLOTS; ++slot) {
+            if (values.at(slot) != cachedValues.at(slot)) {
+                const int column = columnOfSlot(slot);
+                changedFirst = std::min(changedFirst, column);
+                changedLast = std::max(changedLast, column);
+            }
+        }
+        if (changedLast < 0) continue;
+
+        // State affects the icon and the color of the whole row
+        if (values.at(TR_STATUS) != cachedValues.at(TR_STATUS)) {
+            changedFirst = 0;
+            changedLast = NB_COLUMNS - 1;
+        }
+
+        const CachedValues oldValues = cachedValues;
+        cachedRow.values = std::move(values);
+        updateSortKeys(cachedRow, oldValues);
+
+        if ((firstRow >= 0) && (row == (lastRow + 1))) {
+            lastRow = row;
+            firstColumn = std::min(firstColumn, changedFirst);
+            lastColumn = std::max(lastColumn, changedLast);
+        }
+        else {
+            emitRange();
+            firstRow = lastRow = row;
+            firstColumn = changedFirst;
+            lastColumn = changedLast;
+        }
+    }
+
+    emitRange();
 }
 
 // Static functions
@@ -31,7 +31,11 @@
 #define TRANSFERLISTMODEL_H
 
 #include <QAbstractListModel>
-#include <QList>
+#include <QHash>
+#include <QVariant>
+#include <QVector>
+
+#include "base/utils/string.h"
 
 namespace BitTorrent
 {
@@ -93,14 +97,46 @@ public:
 
     BitTorrent::TorrentHandle *torrentHandle(const QModelIndex &index) const;
 
+    // Values as of the last emitted dataChanged(), meant to be used as sort keys
+    QVariant cachedData(int row, int column, int role = Qt::DisplayRole) const;
+    QString cachedHash(int row) const;
+    // Available for TR_NAME, TR_CATEGORY and TR_TAGS
+    const Utils::String::NaturalSortKey &naturalSortKey(int row, int column) const;
+
 private slots:
     void addTorrent(BitTorrent::TorrentHandle *const torrent);
-    void handleTorrentAboutToBeRemoved(BitTorrent::TorrentHandle *const torrent);
+    void addPendingTorrents();
+    void handleTorrentsAboutToBeRemoved(const QVector<BitTorrent::TorrentHandle *> &torrents);
     void handleTorrentStatusUpdated(BitTorrent::TorrentHandle *const torrent);
-    void handleTorrentsUpdated();
+    void handleTorrentsUpdated(const QVector<BitTorrent::TorrentHandle *> &torrents);
 
 private:
-    QList<BitTorrent::TorrentHandle *> m_torrents;
+    using CachedValues = QVector<QVariant>;
+
+    struct CachedRow
+    {
+        CachedValues values;
+        Utils::String::NaturalSortKey nameSortKey;
+        Utils::String::NaturalSortKey categorySortKey;
+        Utils::String::NaturalSortKey tagsSortKey;
+    };
+
+    void addTorrents(const QVector<BitTorrent::TorrentHandle *> &torrents);
+    void removeTorrents(const QVector<BitTorrent::TorrentHandle *> &torrents);
+    void moveRowsToEnd(const QVector<int> &rows);
+    void updateRowMap(int from);
+
+    QVariant value(const BitTorrent::TorrentHandle *torrent, int column, int role) const;
+    CachedValues fetchValues(const BitTorrent::TorrentHandle *torrent) const;
+    bool fetchTimeValues(const BitTorrent::TorrentHandle *torrent, CachedValues &values) const;
+    static void updateSortKeys(CachedRow &cachedRow, const CachedValues &oldValues);
+    void refreshRows(QVector<int> rows, bool timeColumnsOnly = false);
+
+    QVector<BitTorrent::TorrentHandle *> m_torrents;
+    QVector<CachedRow> m_cachedRows;
+    QHash<BitTorrent::TorrentHandle *, int> m_torrentRows;
+    // Torrents added since the last event loop iteration, inserted as a single batch
+    QVector<BitTorrent::TorrentHandle *> m_pendingTorrents;
 };
 
 #endif // TRANSFERLISTMODEL_H
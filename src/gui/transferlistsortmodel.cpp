@@ -33,9 +33,33 @@
 
 #include "base/bittorrent/torrenthandle.h"
 #include "base/types.h"
-#include "base/utils/string.h"
 #include "transferlistmodel.h"
 
+namespace
+{
+    // Same ordering as QSortFilterProxyModel::lessThan() for the types provided by TransferListModel
+    bool variantLessThan(const QVariant &left, const QVariant &right, const Qt::CaseSensitivity caseSensitivity)
+    {
+        switch (left.userType()) {
+        case QMetaType::Int:
+            return (left.toInt() < right.toInt());
+        case QMetaType::UInt:
+            return (left.toUInt() < right.toUInt());
+        case QMetaType::LongLong:
+            return (left.toLongLong() < right.toLongLong());
+        case QMetaType::ULongLong:
+            return (left.toULongLong() < right.toULongLong());
+        case QMetaType::Float:
+        case QMetaType::Double:
+            return (left.toDouble() < right.toDouble());
+        case QMetaType::QDateTime:
+            return (left.toDateTime() < right.toDateTime());
+        default:
+            return (QString::compare(left.toString(), right.toString(), caseSensitivity) < 0);
+        }
+    }
+}
+
 TransferListSortModel::TransferListSortModel(QObject *parent)
     : QSortFilterProxyModel(parent)
 {
@@ -71,9 +95,9 @@ void TransferListSortModel::disableTagFilter()
         invalidateFilter();
 }
 
-void TransferListSortModel::setTrackerFilter(const QStringList &hashes)
+void TransferListSortModel::setTrackerFilter(const QStringSet &hashes)
 {
-    if (m_filter.setHashSet(hashes.toSet()))
+    if (m_filter.setHashSet(hashes))
         invalidateFilter();
 }
 
@@ -89,13 +113,13 @@ bool TransferListSortModel::lessThan(const QModelIndex &left, const QModelIndex
     case TransferListModel::TR_CATEGORY:
     case TransferListModel::TR_TAGS:
     case TransferListModel::TR_NAME: {
-            const QVariant vL = left.data();
-            const QVariant vR = right.data();
+            const QVariant vL = sortValue(left);
+            const QVariant vR = sortValue(right);
             if (!vL.isValid() || !vR.isValid() || (vL == vR))
                 return lowerPositionThan(left, right);
 
-            const int result = Utils::String::naturalCompare(vL.toString(), vR.toString(), Qt::CaseInsensitive);
-            return (result < 0);
+            const auto *model = static_cast<TransferListModel *>(sourceModel());
+            return (model->naturalSortKey(left.row(), sortColumn()) < model->naturalSortKey(right.row(), sortColumn()));
         }
 
     case TransferListModel::TR_STATUS: {
@@ -104,8 +128,8 @@ bool TransferListSortModel::lessThan(const QModelIndex &left, const QModelIndex
             // In this case QSortFilterProxyModel::lessThan() converts other types to QString and
             // sorts them.
             // Thus we can't use the code in the default label.
-            const auto leftValue = left.data().value<BitTorrent::TorrentState>();
-            const auto rightValue = right.data().value<BitTorrent::TorrentState>();
+            const auto leftValue = sortValue(left).value<BitTorrent::TorrentState>();
+            const auto rightValue = sortValue(right).value<BitTorrent::TorrentState>();
             if (leftValue != rightValue)
                 return leftValue < rightValue;
 
@@ -124,10 +148,10 @@ bool TransferListSortModel::lessThan(const QModelIndex &left, const QModelIndex
 
     case TransferListModel::TR_SEEDS:
     case TransferListModel::TR_PEERS: {
-            const int leftActive = left.data().toInt();
-            const int leftTotal = left.data(Qt::UserRole).toInt();
-            const int rightActive = right.data().toInt();
-            const int rightTotal = right.data(Qt::UserRole).toInt();
+            const int leftActive = sortValue(left).toInt();
+            const int leftTotal = sortValue(left, Qt::UserRole).toInt();
+            const int rightActive = sortValue(right).toInt();
+            const int rightTotal = sortValue(right, Qt::UserRole).toInt();
 
             // Active peers/seeds take precedence over total peers/seeds.
             if (leftActive != rightActive)
@@ -140,7 +164,7 @@ bool TransferListSortModel::lessThan(const QModelIndex &left, const QModelIndex
         }
 
     case TransferListModel::TR_ETA: {
-            const TransferListModel *model = qobject_cast<TransferListModel *>(sourceModel());
+            const auto *model = static_cast<TransferListModel *>(sourceModel());
 
             // Sorting rules prioritized.
             // 1. Active torrents at the top
@@ -152,8 +176,8 @@ bool TransferListSortModel::lessThan(const QModelIndex &left, const QModelIndex
             if (isActiveL != isActiveR)
                 return isActiveL;
 
-            const int queuePosL = model->data(model->index(left.row(), TransferListModel::TR_QUEUE_POSITION)).toInt();
-            const int queuePosR = model->data(model->index(right.row(), TransferListModel::TR_QUEUE_POSITION)).toInt();
+            const int queuePosL = model->cachedData(left.row(), TransferListModel::TR_QUEUE_POSITION).toInt();
+            const int queuePosR = model->cachedData(right.row(), TransferListModel::TR_QUEUE_POSITION).toInt();
             const bool isSeedingL = (queuePosL < 0);
             const bool isSeedingR = (queuePosR < 0);
             if (isSeedingL != isSeedingR) {
@@ -164,8 +188,8 @@ bool TransferListSortModel::lessThan(const QModelIndex &left, const QModelIndex
                 return isAscendingOrder;
             }
 
-            const qlonglong etaL = left.data().toLongLong();
-            const qlonglong etaR = right.data().toLongLong();
+            const qlonglong etaL = sortValue(left).toLongLong();
+            const qlonglong etaR = sortValue(right).toLongLong();
             const bool isInvalidL = ((etaL < 0) || (etaL >= MAX_ETA));
             const bool isInvalidR = ((etaR < 0) || (etaR >= MAX_ETA));
             if (isInvalidL && isInvalidR) {
@@ -182,8 +206,8 @@ bool TransferListSortModel::lessThan(const QModelIndex &left, const QModelIndex
         }
 
     case TransferListModel::TR_LAST_ACTIVITY: {
-            const int vL = left.data().toInt();
-            const int vR = right.data().toInt();
+            const int vL = sortValue(left).toInt();
+            const int vR = sortValue(right).toInt();
 
             if (vL < 0) return false;
             if (vR < 0) return true;
@@ -192,8 +216,8 @@ bool TransferListSortModel::lessThan(const QModelIndex &left, const QModelIndex
         }
 
     case TransferListModel::TR_RATIO_LIMIT: {
-            const qreal vL = left.data().toReal();
-            const qreal vR = right.data().toReal();
+            const qreal vL = sortValue(left).toReal();
+            const qreal vR = sortValue(right).toReal();
 
             if (vL < 0) return false;
             if (vR < 0) return true;
@@ -202,8 +226,10 @@ bool TransferListSortModel::lessThan(const QModelIndex &left, const QModelIndex
         }
 
     default: {
-        if (left.data() != right.data())
-            return QSortFilterProxyModel::lessThan(left, right);
+        const QVariant vL = sortValue(left);
+        const QVariant vR = sortValue(right);
+        if (vL != vR)
+            return variantLessThan(vL, vR, sortCaseSensitivity());
 
         return lowerPositionThan(left, right);
         }
@@ -212,11 +238,11 @@ bool TransferListSortModel::lessThan(const QModelIndex &left, const QModelIndex
 
 bool TransferListSortModel::lowerPositionThan(const QModelIndex &left, const QModelIndex &right) const
 {
-    const TransferListModel *model = qobject_cast<TransferListModel *>(sourceModel());
+    const auto *model = static_cast<TransferListModel *>(sourceModel());
 
     // Sort according to TR_QUEUE_POSITION
-    const int queueL = model->data(model->index(left.row(), TransferListModel::TR_QUEUE_POSITION)).toInt();
-    const int queueR = model->data(model->index(right.row(), TransferListModel::TR_QUEUE_POSITION)).toInt();
+    const int queueL = model->cachedData(left.row(), TransferListModel::TR_QUEUE_POSITION).toInt();
+    const int queueR = model->cachedData(right.row(), TransferListModel::TR_QUEUE_POSITION).toInt();
     if ((queueL > 0) || (queueR > 0)) {
         if ((queueL > 0) && (queueR > 0))
             return queueL < queueR;
@@ -233,9 +259,9 @@ bool TransferListSortModel::lowerPositionThan(const QModelIndex &left, const QMo
 // (detailed discussion in #2526 and #2158).
 bool TransferListSortModel::dateLessThan(const int dateColumn, const QModelIndex &left, const QModelIndex &right, bool sortInvalidInBottom) const
 {
-    const TransferListModel *model = qobject_cast<TransferListModel *>(sourceModel());
-    const QDateTime dateL = model->data(model->index(left.row(), dateColumn)).toDateTime();
-    const QDateTime dateR = model->data(model->index(right.row(), dateColumn)).toDateTime();
+    const auto *model = static_cast<TransferListModel *>(sourceModel());
+    const QDateTime dateL = model->cachedData(left.row(), dateColumn).toDateTime();
+    const QDateTime dateR = model->cachedData(right.row(), dateColumn).toDateTime();
     if (dateL.isValid() && dateR.isValid()) {
         if (dateL != dateR)
             return dateL < dateR;
@@ -248,9 +274,15 @@ bool TransferListSortModel::dateLessThan(const int dateColumn, const QModelIndex
     }
 
     // Finally, sort by hash
-    const QString hashL(model->torrentHandle(model->index(left.row()))->hash());
-    const QString hashR(model->torrentHandle(model->index(right.row()))->hash());
-    return hashL < hashR;
+    return model->cachedHash(left.row()) < model->cachedHash(right.row());
+}
+
+// Sort keys are taken from the values cached by TransferListModel instead of
+// querying the torrents via data() on every comparison
+QVariant TransferListSortModel::sortValue(const QModelIndex &index, const int role) const
+{
+    const auto *model = static_cast<TransferListModel *>(sourceModel());
+    return model->cachedData(index.row(), index.column(), role);
 }
 
 bool TransferListSortModel::filterAcceptsRow(int sourceRow, const QModelIndex &sourceParent) const
@@ -32,8 +32,6 @@
 #include <QSortFilterProxyModel>
 #include "base/torrentfilter.h"
 
-class QStringList;
-
 class TransferListSortModel : public QSortFilterProxyModel
 {
     Q_OBJECT
@@ -46,13 +44,14 @@ public:
     void disableCategoryFilter();
     void setTagFilter(const QString &tag);
     void disableTagFilter();
-    void setTrackerFilter(const QStringList &hashes);
+    void setTrackerFilter(const QStringSet &hashes);
     void disableTrackerFilter();
 
 private:
     bool lessThan(const QModelIndex &left, const QModelIndex &right) const override;
     bool lowerPositionThan(const QModelIndex &left, const QModelIndex &right) const;
     bool dateLessThan(int dateColumn, const QModelIndex &left, const QModelIndex &right, bool sortInvalidInBottom) const;
+    QVariant sortValue(const QModelIndex &index, int role = Qt::DisplayRole) const;
     bool filterAcceptsRow(int sourceRow, const QModelIndex &sourceParent) const override;
     bool matchFilter(int sourceRow, const QModelIndex &sourceParent) const;
 
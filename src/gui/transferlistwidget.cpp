@@ -371,8 +371,8 @@ void TransferListWidget::deleteSelectedTorrents(bool deleteLocalFiles)
     if (Preferences::instance()->confirmTorrentDeletion()
         && !DeletionConfirmationDialog::askForDeletionConfirmation(this, deleteLocalFiles, torrents.size(), torrents[0]->name()))
         return;
-    for (BitTorrent::TorrentHandle *const torrent : torrents)
-        BitTorrent::Session::instance()->deleteTorrent(torrent->hash(), deleteLocalFiles);
+
+    BitTorrent::Session::instance()->deleteTorrents(extractHashes(torrents), deleteLocalFiles);
 }
 
 void TransferListWidget::deleteVisibleTorrents()
@@ -388,8 +388,7 @@ void TransferListWidget::deleteVisibleTorrents()
         && !DeletionConfirmationDialog::askForDeletionConfirmation(this, deleteLocalFiles, torrents.size(), torrents[0]->name()))
         return;
 
-    for (BitTorrent::TorrentHandle *const torrent : asConst(torrents))
-        BitTorrent::Session::instance()->deleteTorrent(torrent->hash(), deleteLocalFiles);
+    BitTorrent::Session::instance()->deleteTorrents(extractHashes(torrents), deleteLocalFiles);
 }
 
 void TransferListWidget::increaseQueuePosSelectedTorrents()
@@ -1118,7 +1117,7 @@ void TransferListWidget::applyTrackerFilterAll()
     m_sortFilterModel->disableTrackerFilter();
 }
 
-void TransferListWidget::applyTrackerFilter(const QStringList &hashes)
+void TransferListWidget::applyTrackerFilter(const QSet<QString> &hashes)
 {
     m_sortFilterModel->setTrackerFilter(hashes);
 }
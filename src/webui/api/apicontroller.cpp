@@ -95,3 +95,8 @@ void APIController::setResult(const QJsonObject &result)
 {
     m_result = QJsonDocument(result);
 }
+
+void APIController::deferResult(QObject *until)
+{
+    m_result = QVariant::fromValue(until);
+}
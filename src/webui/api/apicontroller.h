@@ -65,6 +65,8 @@ protected:
     void setResult(const QString &result);
     void setResult(const QJsonArray &result);
     void setResult(const QJsonObject &result);
+    // The action will be run again with the same parameters once `until` is destroyed
+    void deferResult(QObject *until);
 
 private:
     ISessionManager *m_sessionManager;
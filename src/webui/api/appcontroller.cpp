@@ -297,6 +297,9 @@ void AppController::preferencesAction()
     data["utp_tcp_mixed_mode"] = static_cast<int>(session->utpMixedMode());
     // Multiple connections per IP
     data["enable_multi_connections_from_same_ip"] = session->multiConnectionsPerIpEnabled();
+    // Automatic peer banning
+    data["peer_auto_ban_enabled"] = session->isPeerAutoBanEnabled();
+    data["peer_auto_ban_threshold"] = session->peerAutoBanThreshold();
     // Embedded tracker
     data["enable_embedded_tracker"] = session->isTrackerEnabled();
     data["embedded_tracker_port"] = pref->getTrackerPort();
@@ -715,6 +718,11 @@ void AppController::setPreferencesAction()
     // Multiple connections per IP
     if (hasKey("enable_multi_connections_from_same_ip"))
         session->setMultiConnectionsPerIpEnabled(it.value().toBool());
+    // Automatic peer banning
+    if (hasKey("peer_auto_ban_enabled"))
+        session->setPeerAutoBanEnabled(it.value().toBool());
+    if (hasKey("peer_auto_ban_threshold"))
+        session->setPeerAutoBanThreshold(it.value().toInt());
     // Embedded tracker
     if (hasKey("enable_embedded_tracker"))
         session->setTrackerEnabled(it.value().toBool());
@@ -28,17 +28,84 @@
 
 #include "authcontroller.h"
 
+#include <algorithm>
+
+#include <QCryptographicHash>
 #include <QDateTime>
+#include <QJsonArray>
+#include <QRunnable>
 #include <QString>
+#include <QStringList>
+#include <QThread>
+#include <QTimer>
 
 #include "base/logger.h"
 #include "base/preferences.h"
 #include "base/utils/password.h"
+#include "base/utils/random.h"
 #include "apierror.h"
 #include "isessionmanager.h"
 
 constexpr int BAN_TIME = 3600000; // 1 hour
 constexpr int MAX_AUTH_FAILED_ATTEMPTS = 5;
+constexpr int MAX_PENDING_LOGINS = 32;
+// deferred requests are replayed right after the verification, a result
+// that is still unused after that belongs to a closed connection
+constexpr int PENDING_LOGIN_RESULT_TIMEOUT = 10000;
+constexpr int API_TOKEN_SIZE = 32;
+
+namespace
+{
+    class PasswordVerifier : public QRunnable
+    {
+    public:
+        PasswordVerifier(AuthController *controller, const QString &clientAddr, const quint64 verificationId
+                         , const QByteArray &secret, const QString &password)
+            : m_controller {controller}
+            , m_clientAddr {clientAddr}
+            , m_verificationId {verificationId}
+            , m_secret {secret}
+            , m_password {password}
+        {
+        }
+
+        void run() override
+        {
+            const bool passwordEqual = Utils::Password::PBKDF2::verify(m_secret, m_password);
+            QMetaObject::invokeMethod(m_controller, "handlePasswordVerified", Qt::QueuedConnection
+                , Q_ARG(QString, m_clientAddr), Q_ARG(quint64, m_verificationId), Q_ARG(bool, passwordEqual));
+        }
+
+    private:
+        AuthController *m_controller;
+        const QString m_clientAddr;
+        const quint64 m_verificationId;
+        const QByteArray m_secret;
+        const QString m_password;
+    };
+
+    QByteArray randomBytes(const int size)
+    {
+        QByteArray result;
+        result.reserve(size);
+        while (result.size() < size) {
+            const quint32 value = Utils::Random::rand();
+            result.append(reinterpret_cast<const char *>(&value), sizeof(value));
+        }
+        result.truncate(size);
+        return result;
+    }
+}
+
+AuthController::AuthController(ISessionManager *sessionManager, QObject *parent)
+    : APIController {sessionManager, parent}
+    , m_passwordSecret {Preferences::instance()->getWebUIPassword()}
+{
+    // leave the rest of the cores to the torrent session
+    m_passwordVerifiers.setMaxThreadCount(std::max(1, (QThread::idealThreadCount() / 2)));
+
+    connect(Preferences::instance(), &Preferences::changed, this, &AuthController::handlePreferencesChanged);
+}
 
 void AuthController::loginAction()
 {
@@ -61,10 +128,50 @@ void AuthController::loginAction()
 
     const Preferences *pref = Preferences::instance();
 
+    // The request is answered once the password is verified in the thread pool
+    const QByteArray credentialsHash = QCryptographicHash::hash((usernameFromWeb + '\n' + passwordFromWeb).toUtf8()
+        , QCryptographicHash::Sha256);
+    auto pendingIter = m_pendingLogins.find(clientAddr);
+    if (pendingIter != m_pendingLogins.end()) {
+        if (pendingIter->verification) {
+            // wait for the verification in progress, then try again
+            deferResult(pendingIter->verification);
+            return;
+        }
+
+        if (pendingIter->credentialsHash != credentialsHash) {
+            // result of an abandoned request
+            m_pendingLogins.erase(pendingIter);
+            pendingIter = m_pendingLogins.end();
+        }
+    }
+
+    if (pendingIter == m_pendingLogins.end()) {
+        const auto pendingCount = std::count_if(m_pendingLogins.cbegin(), m_pendingLogins.cend()
+            , [](const PendingLogin &pendingLogin) { return !pendingLogin.verification.isNull(); });
+        if (pendingCount >= MAX_PENDING_LOGINS) {
+            LogMsg(tr("WebAPI login failure. Reason: too many pending logins, IP: %1, username: %2")
+                    .arg(clientAddr, usernameFromWeb)
+                , Log::WARNING);
+            throw APIError(APIErrorType::AccessDenied, tr("Too many login attempts at the moment, try again later."));
+        }
+
+        PendingLogin &pendingLogin = m_pendingLogins[clientAddr];
+        pendingLogin.credentialsHash = credentialsHash;
+        pendingLogin.verificationId = ++m_lastVerificationId;
+        pendingLogin.verification = new QObject(this);
+        m_passwordVerifiers.start(new PasswordVerifier(this, clientAddr, pendingLogin.verificationId
+            , m_passwordSecret, passwordFromWeb));
+
+        deferResult(pendingLogin.verification);
+        return;
+    }
+
+    const bool passwordEqual = pendingIter->passwordEqual;
+    m_pendingLogins.erase(pendingIter);
+
     const QString username {pref->getWebUiUsername()};
-    const QByteArray secret {pref->getWebUIPassword()};
     const bool usernameEqual = Utils::Password::slowEquals(usernameFromWeb.toUtf8(), username.toUtf8());
-    const bool passwordEqual = Utils::Password::PBKDF2::verify(secret, passwordFromWeb);
 
     if (usernameEqual && passwordEqual) {
         m_clientFailedLogins.remove(clientAddr);
@@ -87,6 +194,106 @@ void AuthController::logoutAction()
     sessionManager()->sessionEnd();
 }
 
+// Creates API token which can be used instead of logging in by sending
+// "Authorization: Bearer <token>" header. Returns the token, it can't be
+// retrieved later since only its keyed hash is stored.
+void AuthController::createTokenAction()
+{
+    checkTokenManagementAllowed();
+    checkParams({"name"});
+
+    const QString name = params()["name"].trimmed();
+    if (name.isEmpty())
+        throw APIError(APIErrorType::BadParams, tr("Token name cannot be empty"));
+
+    Preferences *const pref = Preferences::instance();
+    QVariantMap tokens = pref->getWebUIAPITokens();
+    if (tokens.contains(name))
+        throw APIError(APIErrorType::Conflict, tr("Token with the same name already exists"));
+
+    QByteArray key = pref->getWebUIAPITokenKey();
+    if (key.isEmpty()) {
+        key = randomBytes(API_TOKEN_SIZE);
+        pref->setWebUIAPITokenKey(key);
+    }
+
+    const QByteArray token = randomBytes(API_TOKEN_SIZE).toBase64(QByteArray::Base64UrlEncoding | QByteArray::OmitTrailingEquals);
+    tokens[name] = Utils::Password::hmacSha256(key, token).toBase64();
+    pref->setWebUIAPITokens(tokens);
+    pref->apply();
+
+    LogMsg(tr("WebAPI token created. Name: %1, IP: %2").arg(name, sessionManager()->clientId()));
+    setResult(QString::fromLatin1(token));
+}
+
+void AuthController::revokeTokenAction()
+{
+    checkTokenManagementAllowed();
+    checkParams({"name"});
+
+    const QString name = params()["name"].trimmed();
+
+    Preferences *const pref = Preferences::instance();
+    QVariantMap tokens = pref->getWebUIAPITokens();
+    if (tokens.remove(name) == 0)
+        throw APIError(APIErrorType::NotFound, tr("Token not found"));
+
+    pref->setWebUIAPITokens(tokens);
+    pref->apply();
+
+    LogMsg(tr("WebAPI token revoked. Name: %1, IP: %2").arg(name, sessionManager()->clientId()));
+}
+
+// Returns names of the API tokens in JSON format.
+void AuthController::tokensAction()
+{
+    checkTokenManagementAllowed();
+
+    const QStringList names = Preferences::instance()->getWebUIAPITokens().keys();
+    QJsonArray result;
+    for (const QString &name : names)
+        result << name;
+    setResult(result);
+}
+
+void AuthController::handlePasswordVerified(const QString &clientAddr, const quint64 verificationId, const bool passwordEqual)
+{
+    const auto pendingIter = m_pendingLogins.find(clientAddr);
+    if ((pendingIter == m_pendingLogins.end()) || (pendingIter->verificationId != verificationId))
+        return;
+
+    pendingIter->passwordEqual = passwordEqual;
+    // resumes the deferred request
+    delete pendingIter->verification;
+
+    // the result is removed once it is used, otherwise it expires
+    QTimer::singleShot(PENDING_LOGIN_RESULT_TIMEOUT, this, [this, clientAddr, verificationId]()
+    {
+        const auto iter = m_pendingLogins.find(clientAddr);
+        if ((iter != m_pendingLogins.end()) && (iter->verificationId == verificationId))
+            m_pendingLogins.erase(iter);
+    });
+}
+
+void AuthController::handlePreferencesChanged()
+{
+    const QByteArray passwordSecret = Preferences::instance()->getWebUIPassword();
+    if (passwordSecret == m_passwordSecret) return;
+
+    m_passwordSecret = passwordSecret;
+    clearPendingLogins();
+}
+
+// Results verified against the old password must not be used,
+// the deferred requests are resumed and verified again
+void AuthController::clearPendingLogins()
+{
+    const QHash<QString, PendingLogin> pendingLogins = m_pendingLogins;
+    m_pendingLogins.clear();
+    for (const PendingLogin &pendingLogin : pendingLogins)
+        delete pendingLogin.verification;
+}
+
 bool AuthController::isBanned() const
 {
     const qint64 now = QDateTime::currentMSecsSinceEpoch() / 1000;
@@ -106,6 +313,13 @@ int AuthController::failedAttemptsCount() const
     return m_clientFailedLogins.value(sessionManager()->clientId()).failedAttemptsCount;
 }
 
+void AuthController::checkTokenManagementAllowed() const
+{
+    // otherwise a leaked token could be used to keep the access after it is revoked
+    if (sessionManager()->session()->getData(QLatin1String(SESSION_DATA_API_TOKEN)).isValid())
+        throw APIError(APIErrorType::AccessDenied, tr("API tokens cannot be managed using API token authentication"));
+}
+
 void AuthController::increaseFailedAttempts()
 {
     FailedLogin &failedLogin = m_clientFailedLogins[sessionManager()->clientId()];
@@ -29,6 +29,8 @@
 #pragma once
 
 #include <QHash>
+#include <QPointer>
+#include <QThreadPool>
 
 #include "apicontroller.h"
 
@@ -40,16 +42,24 @@ class AuthController : public APIController
     Q_DISABLE_COPY(AuthController)
 
 public:
-    using APIController::APIController;
+    explicit AuthController(ISessionManager *sessionManager, QObject *parent = nullptr);
 
 private slots:
     void loginAction();
     void logoutAction();
+    void createTokenAction();
+    void revokeTokenAction();
+    void tokensAction();
+
+    void handlePasswordVerified(const QString &clientAddr, quint64 verificationId, bool passwordEqual);
+    void handlePreferencesChanged();
 
 private:
     bool isBanned() const;
     int failedAttemptsCount() const;
     void increaseFailedAttempts();
+    void checkTokenManagementAllowed() const;
+    void clearPendingLogins();
 
     struct FailedLogin
     {
@@ -57,4 +67,20 @@ private:
         qint64 bannedAt = 0;
     };
     mutable QHash<QString, FailedLogin> m_clientFailedLogins;
+
+    // Password verification is slow by design so it runs in the thread pool,
+    // at most one verification per client at a time
+    struct PendingLogin
+    {
+        QByteArray credentialsHash;
+        quint64 verificationId = 0;
+        // alive while the verification is in progress
+        QPointer<QObject> verification;
+        bool passwordEqual = false;
+    };
+    QHash<QString, PendingLogin> m_pendingLogins;
+    quint64 m_lastVerificationId = 0;
+    // results are verified against this one
+    QByteArray m_passwordSecret;
+    QThreadPool m_passwordVerifiers;
 };
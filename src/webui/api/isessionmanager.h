@@ -32,6 +32,9 @@
 
 class QString;
 
+// Session data holding the name of the API token used to open the session
+constexpr char SESSION_DATA_API_TOKEN[] = "apiToken";
+
 struct ISession
 {
     virtual ~ISession() = default;
@@ -43,6 +43,35 @@ const char KEY_LOG_PEER_IP[] = "ip";
 const char KEY_LOG_PEER_BLOCKED[] = "blocked";
 const char KEY_LOG_PEER_REASON[] = "reason";
 
+namespace
+{
+    // Reads the query parameters shared by the log actions
+    Log::Query parseQuery(const StringMap &params)
+    {
+        const auto toInt = [&params](const QString &key, const int defaultValue) -> int
+        {
+            bool ok = false;
+            const int value = params[key].toInt(&ok);
+            return ok ? value : defaultValue;
+        };
+        const auto toLongLong = [&params](const QString &key, const qint64 defaultValue) -> qint64
+        {
+            bool ok = false;
+            const qint64 value = params[key].toLongLong(&ok);
+            return ok ? value : defaultValue;
+        };
+
+        Log::Query query;
+        query.lastKnownId = toInt(QLatin1String("last_known_id"), -1);
+        query.beforeId = toInt(QLatin1String("before_id"), -1);
+        query.minTimestamp = toLongLong(QLatin1String("min_timestamp"), -1);
+        query.maxTimestamp = toLongLong(QLatin1String("max_timestamp"), -1);
+        query.text = params[QLatin1String("search")];
+        query.limit = toInt(QLatin1String("limit"), -1);
+        return query;
+    }
+}
+
 // Returns the log in JSON format.
 // The return value is an array of dictionaries.
 // The dictionary keys are:
@@ -56,35 +85,38 @@ const char KEY_LOG_PEER_REASON[] = "reason";
 //   - warning (bool): include warning messages (default true)
 //   - critical (bool): include critical messages (default true)
 //   - last_known_id (int): exclude messages with id <= 'last_known_id' (default -1)
+//   - before_id (int): exclude messages with id >= 'before_id' (default -1: disabled)
+//   - min_timestamp (int): exclude messages older than 'min_timestamp' (default -1: disabled)
+//   - max_timestamp (int): exclude messages newer than 'max_timestamp' (default -1: disabled)
+//   - search (string): only include messages containing 'search', case insensitive (default "")
+//   - limit (int): only include the 'limit' newest matching messages (default -1: disabled)
 void LogController::mainAction()
 {
     using Utils::String::parseBool;
 
-    const bool isNormal = parseBool(params()["normal"], true);
-    const bool isInfo = parseBool(params()["info"], true);
-    const bool isWarning = parseBool(params()["warning"], true);
-    const bool isCritical = parseBool(params()["critical"], true);
-
-    bool ok = false;
-    int lastKnownId = params()["last_known_id"].toInt(&ok);
-    if (!ok)
-        lastKnownId = -1;
+    Log::MsgTypes types;
+    if (parseBool(params()["normal"], true))
+        types |= Log::NORMAL;
+    if (parseBool(params()["info"], true))
+        types |= Log::INFO;
+    if (parseBool(params()["warning"], true))
+        types |= Log::WARNING;
+    if (parseBool(params()["critical"], true))
+        types |= Log::CRITICAL;
 
-    Logger *const logger = Logger::instance();
     QJsonArray msgList;
+    if (!types) {
+        setResult(msgList);
+        return;
+    }
 
-    for (const Log::Msg &msg : asConst(logger->getMessages(lastKnownId))) {
-        if (!((msg.type == Log::NORMAL && isNormal)
-              || (msg.type == Log::INFO && isInfo)
-              || (msg.type == Log::WARNING && isWarning)
-              || (msg.type == Log::CRITICAL && isCritical)))
-            continue;
-
+    const Logger *const logger = Logger::instance();
+    for (const Log::Msg &msg : asConst(logger->getMessages(parseQuery(params()), types))) {
         msgList.append(QJsonObject {
             {KEY_LOG_ID, msg.id},
             {KEY_LOG_TIMESTAMP, msg.timestamp},
             {KEY_LOG_MSG_TYPE, msg.type},
-            {KEY_LOG_MSG_MESSAGE, msg.message}
+            {KEY_LOG_MSG_MESSAGE, msg.message.toHtmlEscaped()}
         });
     }
 
@@ -101,25 +133,20 @@ void LogController::mainAction()
 //   - "reason": reason of the block
 // GET params:
 //   - last_known_id (int): exclude messages with id <= 'last_known_id' (default -1)
+//   - before_id, min_timestamp, max_timestamp, search, limit: same as for the main log,
+//     'search' is matched against both the IP and the reason
 void LogController::peersAction()
 {
-    int lastKnownId;
-    bool ok;
-
-    lastKnownId = params()["last_known_id"].toInt(&ok);
-    if (!ok)
-        lastKnownId = -1;
-
-    Logger *const logger = Logger::instance();
+    const Logger *const logger = Logger::instance();
     QJsonArray peerList;
 
-    for (const Log::Peer &peer : asConst(logger->getPeers(lastKnownId))) {
+    for (const Log::Peer &peer : asConst(logger->getPeers(parseQuery(params())))) {
         peerList.append(QJsonObject {
             {KEY_LOG_ID, peer.id},
             {KEY_LOG_TIMESTAMP, peer.timestamp},
-            {KEY_LOG_PEER_IP, peer.ip},
+            {KEY_LOG_PEER_IP, peer.ip.toHtmlEscaped()},
             {KEY_LOG_PEER_BLOCKED, peer.blocked},
-            {KEY_LOG_PEER_REASON, peer.reason}
+            {KEY_LOG_PEER_REASON, peer.reason.toHtmlEscaped()}
         });
     }
 
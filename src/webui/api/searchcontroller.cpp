@@ -53,6 +53,14 @@ namespace
     const QLatin1String ACTIVE_SEARCHES("activeSearches");
     const QLatin1String SEARCH_HANDLERS("searchHandlers");
 
+    const QHash<QString, SearchResultStore::SortKey> SORT_KEYS {
+        {QLatin1String("fileName"), SearchResultStore::SortByName},
+        {QLatin1String("fileSize"), SearchResultStore::SortBySize},
+        {QLatin1String("nbSeeders"), SearchResultStore::SortBySeeders},
+        {QLatin1String("nbLeechers"), SearchResultStore::SortByLeechers},
+        {QLatin1String("siteUrl"), SearchResultStore::SortBySiteUrl}
+    };
+
     void removeActiveSearch(ISession *session, const int id)
     {
         auto activeSearches = session->getData<QSet<int>>(ACTIVE_SEARCHES);
@@ -149,6 +157,14 @@ void SearchController::statusAction()
     setResult(statusArray);
 }
 
+// GET params:
+//   - id (int): search id
+//   - limit (int): max number of results to return (default 0: no limit)
+//   - offset (int): number of results to skip, negative values count from the end (default 0).
+//     Results are only ever appended, so the number of results already received
+//     can be passed as offset to get only the new ones
+//   - sort (string): sort results by the given field (fileName, fileSize, nbSeeders, nbLeechers, siteUrl)
+//   - reverse (bool): sort in descending order (default false)
 void SearchController::resultsAction()
 {
     checkParams({"id"});
@@ -156,13 +172,18 @@ void SearchController::resultsAction()
     const int id = params()["id"].toInt();
     int limit = params()["limit"].toInt();
     int offset = params()["offset"].toInt();
+    const QString sortField = params()["sort"];
+    const bool reverse = Utils::String::parseBool(params()["reverse"], false);
+
+    if (!sortField.isEmpty() && !SORT_KEYS.contains(sortField))
+        throw APIError(APIErrorType::BadParams, tr("Unknown sort field"));
 
     const auto searchHandlers = sessionManager()->session()->getData<SearchHandlerDict>(SEARCH_HANDLERS);
     if (!searchHandlers.contains(id))
         throw APIError(APIErrorType::NotFound);
 
     const SearchHandlerPtr searchHandler = searchHandlers[id];
-    const QList<SearchResult> searchResults = searchHandler->results();
+    const SearchResultStore &searchResults = searchHandler->results();
     const int size = searchResults.size();
 
     if (offset > size)
@@ -176,10 +197,10 @@ void SearchController::resultsAction()
     if (limit <= 0)
         limit = -1;
 
-    if ((limit > 0) || (offset > 0))
-        setResult(getResults(searchResults.mid(offset, limit), searchHandler->isActive(), size));
-    else
-        setResult(getResults(searchResults, searchHandler->isActive(), size));
+    const QVector<SearchResult> resultsSlice = sortField.isEmpty()
+        ? searchResults.slice(offset, limit)
+        : searchResults.sortedSlice(SORT_KEYS[sortField], reverse, offset, limit);
+    setResult(getResults(resultsSlice, searchHandler->isActive(), size));
 }
 
 void SearchController::deleteAction()
@@ -314,7 +335,7 @@ int SearchController::generateSearchId() const
  *   - "siteUrl"
  *   - "descrLink"
  */
-QJsonObject SearchController::getResults(const QList<SearchResult> &searchResults, const bool isSearchActive, const int totalResults) const
+QJsonObject SearchController::getResults(const QVector<SearchResult> &searchResults, const bool isSearchActive, const int totalResults) const
 {
     QJsonArray searchResultsArray;
     for (const SearchResult &searchResult : searchResults) {
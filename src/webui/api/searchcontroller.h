@@ -29,7 +29,7 @@
 #pragma once
 
 #include <QHash>
-#include <QList>
+#include <QVector>
 
 #include "base/search/searchpluginmanager.h"
 #include "apicontroller.h"
@@ -70,6 +70,6 @@ private:
     void searchFinished(ISession *session, int id);
     void searchFailed(ISession *session, int id);
     int generateSearchId() const;
-    QJsonObject getResults(const QList<SearchResult> &searchResults, bool isSearchActive, int totalResults) const;
+    QJsonObject getResults(const QVector<SearchResult> &searchResults, bool isSearchActive, int totalResults) const;
     QJsonArray getPluginsInfo(const QStringList &plugins) const;
 };
@@ -28,6 +28,7 @@
 
 #include "torrentscontroller.h"
 
+#include <algorithm>
 #include <functional>
 
 #include <QBitArray>
@@ -46,6 +47,7 @@
 #include "base/bittorrent/torrenthandle.h"
 #include "base/bittorrent/torrentinfo.h"
 #include "base/bittorrent/trackerentry.h"
+#include "base/bittorrent/trackerhostindex.h"
 #include "base/global.h"
 #include "base/logger.h"
 #include "base/net/downloadmanager.h"
@@ -132,6 +134,41 @@ namespace
         }
     }
 
+    // Text values are compared by their natural sort keys, same as in the GUI
+    void sortTorrentList(QVariantList &torrentList, const QString &sortedColumn, const bool reverse)
+    {
+        struct SortItem
+        {
+            QVariant value;
+            Utils::String::NaturalSortKey textKey;
+            QVariant torrent;
+        };
+
+        QVector<SortItem> items;
+        items.reserve(torrentList.size());
+        for (const QVariant &torrent : asConst(torrentList)) {
+            const QVariant value = torrent.toMap().value(sortedColumn);
+            items.append({value, ((value.type() == QVariant::String)
+                                  ? Utils::String::NaturalSortKey(value.toString(), Qt::CaseInsensitive)
+                                  : Utils::String::NaturalSortKey()), torrent});
+        }
+
+        const auto lessThan = [](const SortItem &left, const SortItem &right)
+        {
+            if ((left.value.type() == QVariant::String) && (right.value.type() == QVariant::String))
+                return (left.textKey < right.textKey);
+            return (left.value < right.value);
+        };
+        std::stable_sort(items.begin(), items.end()
+            , [reverse, &lessThan](const SortItem &left, const SortItem &right)
+        {
+            return reverse ? lessThan(right, left) : lessThan(left, right);
+        });
+
+        for (int i = 0; i < items.size(); ++i)
+            torrentList[i] = items[i].torrent;
+    }
+
     QJsonArray getStickyTrackers(const BitTorrent::TorrentHandle *const torrent)
     {
         int seedsDHT = 0, seedsPeX = 0, seedsLSD = 0, leechesDHT = 0, leechesPeX = 0, leechesLSD = 0;
@@ -197,6 +234,25 @@ namespace
 
         return {dht, pex, lsd};
     }
+
+    // 0: piece not downloaded
+    // 1: piece requested or downloading
+    // 2: piece already downloaded
+    int pieceState(const QBitArray &pieces, const QBitArray &downloadingPieces, const int index)
+    {
+        if (downloadingPieces.testBit(index))
+            return 1;
+        return (pieces.testBit(index) ? 2 : 0);
+    }
+
+    QJsonObject bandwidthClassToJson(const BitTorrent::BandwidthClass &bandwidthClass)
+    {
+        return {
+            {"upLimit", bandwidthClass.uploadLimit},
+            {"dlLimit", bandwidthClass.downloadLimit},
+            {"priority", bandwidthClass.priority}
+        };
+    }
 }
 
 // Returns all the torrents in JSON format.
@@ -224,6 +280,7 @@ namespace
 //   - filter (string): all, downloading, seeding, completed, paused, resumed, active, inactive
 //   - category (string): torrent category for filtering by it (empty string means "uncategorized"; no "category" param presented means "any category")
 //   - hashes (string): filter by hashes, can contain multiple hashes separated by |
+//   - tracker (string): tracker host for filtering by it (empty string means "trackerless"; no "tracker" param presented means "any tracker")
 //   - sort (string): name of column for sorting by its value
 //   - reverse (bool): enable reverse sorting
 //   - limit (int): set limit number of torrents returned (if greater than 0, otherwise - unlimited)
@@ -232,11 +289,21 @@ void TorrentsController::infoAction()
 {
     const QString filter {params()["filter"]};
     const QString category {params()["category"]};
+    const QString tracker {params()["tracker"]};
     const QString sortedColumn {params()["sort"]};
     const bool reverse {parseBool(params()["reverse"], false)};
     int limit {params()["limit"].toInt()};
     int offset {params()["offset"].toInt()};
-    const QStringSet hashSet {params()["hashes"].split('|', QString::SkipEmptyParts).toSet()};
+    QStringSet hashSet {params()["hashes"].split('|', QString::SkipEmptyParts).toSet()};
+
+    if (!tracker.isNull()) {
+        const QStringSet trackerHashSet = BitTorrent::Session::instance()->trackerHostIndex()->torrents(tracker);
+        hashSet = (hashSet.isEmpty() ? trackerHashSet : hashSet.intersect(trackerHashSet));
+        if (hashSet.isEmpty()) {
+            setResult(QJsonArray());
+            return;
+        }
+    }
 
     QVariantList torrentList;
     TorrentFilter torrentFilter(filter, (hashSet.isEmpty() ? TorrentFilter::AnyHash : hashSet), category);
@@ -245,13 +312,8 @@ void TorrentsController::infoAction()
             torrentList.append(serialize(*torrent));
     }
 
-    std::sort(torrentList.begin(), torrentList.end()
-              , [sortedColumn, reverse](const QVariant &torrent1, const QVariant &torrent2)
-    {
-        return reverse
-                ? (torrent1.toMap().value(sortedColumn) > torrent2.toMap().value(sortedColumn))
-                : (torrent1.toMap().value(sortedColumn) < torrent2.toMap().value(sortedColumn));
-    });
+    if (!sortedColumn.isEmpty())
+        sortTorrentList(torrentList, sortedColumn, reverse);
 
     const int size = torrentList.size();
     // normalize offset
@@ -496,32 +558,64 @@ void TorrentsController::pieceHashesAction()
     setResult(pieceHashes);
 }
 
-// Returns an array of states (of each pieces respectively) for a torrent in JSON format.
-// The return value is a JSON-formatted array of ints.
+// Returns the states (of each pieces respectively) for a torrent.
 // 0: piece not downloaded
 // 1: piece requested or downloading
 // 2: piece already downloaded
+// GET params:
+//   - hash (string): torrent hash
+//   - format (string): result encoding, one of:
+//       - "json" (default): JSON-formatted array of ints, one per piece
+//       - "rle": JSON-formatted array of [state, count] pairs, one per run of equal states
+//       - "base64": base64 encoded string of 2-bit states, 4 pieces per byte,
+//                   first piece in the most significant bits
 void TorrentsController::pieceStatesAction()
 {
     checkParams({"hash"});
 
     const QString hash {params()["hash"]};
-    QJsonArray pieceStates;
+    const QString format {params()["format"]};
     BitTorrent::TorrentHandle *const torrent = BitTorrent::Session::instance()->findTorrent(hash);
     if (!torrent)
         throw APIError(APIErrorType::NotFound);
 
     const QBitArray states = torrent->pieces();
-    for (int i = 0; i < states.size(); ++i)
-        pieceStates.append(static_cast<int>(states[i]) * 2);
-
     const QBitArray dlstates = torrent->downloadingPieces();
-    for (int i = 0; i < states.size(); ++i) {
-        if (dlstates[i])
-            pieceStates[i] = 1;
+    const int piecesCount = qMin(states.size(), dlstates.size());
+
+    if (format.isEmpty() || (format == QLatin1String("json"))) {
+        QJsonArray pieceStates;
+        for (int i = 0; i < piecesCount; ++i)
+            pieceStates.append(pieceState(states, dlstates, i));
+
+        setResult(pieceStates);
     }
+    else if (format == QLatin1String("rle")) {
+        QJsonArray pieceStateRuns;
+        int runStart = 0;
+        while (runStart < piecesCount) {
+            const int state = pieceState(states, dlstates, runStart);
+            int runEnd = runStart + 1;
+            while ((runEnd < piecesCount) && (pieceState(states, dlstates, runEnd) == state))
+                ++runEnd;
+
+            pieceStateRuns.append(QJsonArray {state, (runEnd - runStart)});
+            runStart = runEnd;
+        }
 
-    setResult(pieceStates);
+        setResult(pieceStateRuns);
+    }
+    else if (format == QLatin1String("base64")) {
+        QByteArray packedStates(((piecesCount + 3) / 4), 0);
+        char *data = packedStates.data();
+        for (int i = 0; i < piecesCount; ++i)
+            data[i / 4] = static_cast<char>(static_cast<uchar>(data[i / 4]) | (pieceState(states, dlstates, i) << (6 - (2 * (i % 4)))));
+
+        setResult(QString::fromLatin1(packedStates.toBase64()));
+    }
+    else {
+        throw APIError(APIErrorType::BadParams, tr("Unknown piece states format"));
+    }
 }
 
 void TorrentsController::addAction()
@@ -886,10 +980,12 @@ void TorrentsController::deleteAction()
 
     const QStringList hashes {params()["hashes"].split('|')};
     const bool deleteFiles {parseBool(params()["deleteFiles"], false)};
-    applyToTorrents(hashes, [deleteFiles](BitTorrent::TorrentHandle *const torrent)
+    QStringList torrentHashes;
+    applyToTorrents(hashes, [&torrentHashes](BitTorrent::TorrentHandle *const torrent)
     {
-        BitTorrent::Session::instance()->deleteTorrent(torrent->hash(), deleteFiles);
+        torrentHashes << torrent->hash();
     });
+    BitTorrent::Session::instance()->deleteTorrents(torrentHashes, deleteFiles);
 }
 
 void TorrentsController::increasePrioAction()
@@ -1078,6 +1174,62 @@ void TorrentsController::categoriesAction()
     setResult(categories);
 }
 
+// Returns the bandwidth classes of categories and tags in JSON format.
+// The return value is a JSON-formatted dictionary with "categories" and "tags"
+// dictionaries mapping names to classes. Each class has the following keys:
+//   - "upLimit": Upload limit of the whole class (bytes/s), 0 means unlimited
+//   - "dlLimit": Download limit of the whole class (bytes/s), 0 means unlimited
+//   - "priority": Share of global limits (1..255)
+void TorrentsController::bandwidthClassesAction()
+{
+    const BitTorrent::Session *session = BitTorrent::Session::instance();
+
+    QJsonObject categories;
+    for (auto it = session->categories().cbegin(); it != session->categories().cend(); ++it) {
+        const BitTorrent::BandwidthClass bandwidthClass = session->categoryBandwidthClass(it.key());
+        if (!bandwidthClass.isDefault())
+            categories[it.key()] = bandwidthClassToJson(bandwidthClass);
+    }
+
+    QJsonObject tags;
+    for (const QString &tag : asConst(session->tags())) {
+        const BitTorrent::BandwidthClass bandwidthClass = session->tagBandwidthClass(tag);
+        if (!bandwidthClass.isDefault())
+            tags[tag] = bandwidthClassToJson(bandwidthClass);
+    }
+
+    setResult(QJsonObject {{"categories", categories}, {"tags", tags}});
+}
+
+// Sets the bandwidth class of a category ("category" parameter) or a tag ("tag" parameter).
+// Omitted values are reset to defaults, resetting all of them removes the class.
+void TorrentsController::setBandwidthClassAction()
+{
+    const bool isCategory = params().contains("category");
+    if (!isCategory && !params().contains("tag"))
+        throw APIError(APIErrorType::BadParams, tr("Either category or tag must be specified"));
+
+    BitTorrent::BandwidthClass bandwidthClass;
+    bandwidthClass.uploadLimit = std::max(0, params()["upLimit"].toInt());
+    bandwidthClass.downloadLimit = std::max(0, params()["dlLimit"].toInt());
+    if (params().contains("priority")) {
+        bool ok = false;
+        bandwidthClass.priority = params()["priority"].toInt(&ok);
+        if (!ok || (bandwidthClass.priority < 1) || (bandwidthClass.priority > 255))
+            throw APIError(APIErrorType::BadParams, tr("Priority must be between 1 and 255"));
+    }
+
+    BitTorrent::Session *const session = BitTorrent::Session::instance();
+    if (isCategory) {
+        if (!session->setCategoryBandwidthClass(params()["category"].trimmed(), bandwidthClass))
+            throw APIError(APIErrorType::Conflict, tr("Incorrect category name"));
+    }
+    else {
+        if (!session->setTagBandwidthClass(params()["tag"].trimmed(), bandwidthClass))
+            throw APIError(APIErrorType::Conflict, tr("Incorrect tag name"));
+    }
+}
+
 void TorrentsController::addTagsAction()
 {
     checkParams({"hashes", "tags"});
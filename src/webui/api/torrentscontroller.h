@@ -61,6 +61,8 @@ private slots:
     void createTagsAction();
     void deleteTagsAction();
     void tagsAction();
+    void bandwidthClassesAction();
+    void setBandwidthClassAction();
     void addAction();
     void deleteAction();
     void addTrackersAction();
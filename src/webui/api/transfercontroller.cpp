@@ -29,11 +29,16 @@
 #include "transfercontroller.h"
 
 #include <QJsonObject>
+#include <QMap>
+#include <QStringList>
 #include <QVector>
 
 #include "base/bittorrent/peeraddress.h"
 #include "base/bittorrent/peerinfo.h"
 #include "base/bittorrent/session.h"
+#include "base/bittorrent/sessionmetric.h"
+#include "base/bittorrent/torrenthandle.h"
+#include "base/bittorrent/trackerhostindex.h"
 #include "base/global.h"
 #include "apierror.h"
 
@@ -46,6 +51,74 @@ const char KEY_TRANSFER_UPRATELIMIT[] = "up_rate_limit";
 const char KEY_TRANSFER_DHT_NODES[] = "dht_nodes";
 const char KEY_TRANSFER_CONNECTION_STATUS[] = "connection_status";
 
+namespace
+{
+    struct TorrentAggregate
+    {
+        qint64 torrents = 0;
+        qint64 downloadRate = 0;
+        qint64 uploadRate = 0;
+        qint64 downloaded = 0;
+        qint64 uploaded = 0;
+        qint64 seeds = 0;
+        qint64 leechers = 0;
+
+        void add(const BitTorrent::TorrentHandle *torrent)
+        {
+            ++torrents;
+            downloadRate += torrent->downloadPayloadRate();
+            uploadRate += torrent->uploadPayloadRate();
+            downloaded += torrent->totalDownload();
+            uploaded += torrent->totalUpload();
+            seeds += torrent->seedsCount();
+            leechers += torrent->leechsCount();
+        }
+    };
+
+    QString escapeLabelValue(QString value)
+    {
+        return value.replace('\\', QLatin1String("\\\\"))
+                .replace('"', QLatin1String("\\\""))
+                .replace('\n', QLatin1String("\\n"));
+    }
+
+    void appendMetricHeader(QString &out, const QString &name, const QString &help, const char *type)
+    {
+        out += QLatin1String("# HELP ") + name + ' ' + help + '\n';
+        out += QLatin1String("# TYPE ") + name + ' ' + QLatin1String(type) + '\n';
+    }
+
+    void appendAggregates(QString &out, const char *label, const QMap<QString, TorrentAggregate> &aggregates)
+    {
+        // Aggregated totals go down when torrents are removed so all of them are gauges
+        const struct
+        {
+            const char *name;
+            const char *help;
+            qint64 TorrentAggregate::*field;
+        } aggregateMetrics[] = {
+            {"torrents", "Number of torrents", &TorrentAggregate::torrents},
+            {"download_rate_bytes", "Payload download rate in bytes per second", &TorrentAggregate::downloadRate},
+            {"upload_rate_bytes", "Payload upload rate in bytes per second", &TorrentAggregate::uploadRate},
+            {"downloaded_bytes", "Payload downloaded by the torrents", &TorrentAggregate::downloaded},
+            {"uploaded_bytes", "Payload uploaded by the torrents", &TorrentAggregate::uploaded},
+            {"connected_seeds", "Number of connected seeds", &TorrentAggregate::seeds},
+            {"connected_leechers", "Number of connected leechers", &TorrentAggregate::leechers}
+        };
+
+        for (const auto &metric : aggregateMetrics) {
+            const QString name = QLatin1String("qbittorrent_") + QLatin1String(label)
+                    + '_' + QLatin1String(metric.name);
+            appendMetricHeader(out, name, QString::fromLatin1("%1 per %2").arg(metric.help, label), "gauge");
+            for (auto it = aggregates.cbegin(); it != aggregates.cend(); ++it) {
+                out += name + '{' + QLatin1String(label) + QLatin1String("=\"")
+                        + escapeLabelValue(it.key()) + QLatin1String("\"} ")
+                        + QString::number(it.value().*metric.field) + '\n';
+            }
+        }
+    }
+}
+
 // Returns the global transfer information in JSON format.
 // The return value is a JSON-formatted dictionary.
 // The dictionary keys are:
@@ -78,6 +151,84 @@ void TransferController::infoAction()
     setResult(dict);
 }
 
+// Returns the session metrics in the Prometheus text exposition format.
+// Every libtorrent session statistic is exported as "qbittorrent_lt_<name>".
+// Counters get the "_total" suffix and are accompanied by a "_per_second"
+// gauge holding the rate measured between the last two stats updates, so
+// scrapers don't need to compute rates themselves.
+// Alert pipeline counters are exported as "qbittorrent_alert*" counters.
+// Torrent aggregates are exported per category (label "category", empty
+// for uncategorized torrents) and per tracker host (label "tracker", empty
+// for trackerless torrents).
+void TransferController::metricsAction()
+{
+    const BitTorrent::Session *const session = BitTorrent::Session::instance();
+
+    QString out;
+    out.reserve(64 * 1024);
+
+    for (const BitTorrent::SessionMetric &metric : session->metrics()) {
+        const QString baseName = QLatin1String("qbittorrent_lt_") + QString(metric.name).replace('.', '_');
+        const QString help = QLatin1String("libtorrent metric ") + metric.name;
+        if (metric.isGauge) {
+            appendMetricHeader(out, baseName, help, "gauge");
+            out += baseName + ' ' + QString::number(metric.value) + '\n';
+        }
+        else {
+            const QString counterName = baseName + QLatin1String("_total");
+            appendMetricHeader(out, counterName, help, "counter");
+            out += counterName + ' ' + QString::number(metric.value) + '\n';
+
+            const QString rateName = baseName + QLatin1String("_per_second");
+            appendMetricHeader(out, rateName, help + QLatin1String(" per second"), "gauge");
+            out += rateName + ' ' + QString::number(metric.rate, 'f', 2) + '\n';
+        }
+    }
+
+    const BitTorrent::AlertStatistics alertStatistics = session->alertStatistics();
+    const struct
+    {
+        const char *name;
+        const char *help;
+        qint64 value;
+    } alertMetrics[] = {
+        {"qbittorrent_alerts_received_total", "Alerts read from libtorrent", alertStatistics.receivedAlerts},
+        {"qbittorrent_alerts_coalesced_total", "Alerts superseded by newer ones before being handled", alertStatistics.coalescedAlerts},
+        {"qbittorrent_alert_batches_total", "Batches of alerts read from libtorrent", alertStatistics.batches},
+        {"qbittorrent_alert_queue_overflows_total", "Times libtorrent alert queue overflowed", alertStatistics.queueOverflows},
+        {"qbittorrent_alert_dropped_types_total", "Alert types dropped on alert queue overflows", alertStatistics.droppedAlertTypes}
+    };
+    for (const auto &metric : alertMetrics) {
+        appendMetricHeader(out, QLatin1String(metric.name), QLatin1String(metric.help), "counter");
+        out += QLatin1String(metric.name) + ' ' + QString::number(metric.value) + '\n';
+    }
+
+    const QHash<BitTorrent::InfoHash, BitTorrent::TorrentHandle *> torrents = session->torrents();
+
+    QMap<QString, TorrentAggregate> categoryAggregates;
+    for (const BitTorrent::TorrentHandle *torrent : torrents)
+        categoryAggregates[torrent->category()].add(torrent);
+    appendAggregates(out, "category", categoryAggregates);
+
+    QMap<QString, TorrentAggregate> trackerAggregates;
+    const BitTorrent::TrackerHostIndex *trackerHostIndex = session->trackerHostIndex();
+    // hosts() leaves out the empty host of the trackerless torrents
+    QStringList trackerHosts = trackerHostIndex->hosts();
+    if (trackerHostIndex->torrentCount({}) > 0)
+        trackerHosts << QString();
+    for (const QString &host : asConst(trackerHosts)) {
+        TorrentAggregate &aggregate = trackerAggregates[host];
+        for (const QString &hash : asConst(trackerHostIndex->torrents(host))) {
+            const BitTorrent::TorrentHandle *torrent = torrents.value(hash);
+            if (torrent)
+                aggregate.add(torrent);
+        }
+    }
+    appendAggregates(out, "tracker", trackerAggregates);
+
+    setResult(out);
+}
+
 void TransferController::uploadLimitAction()
 {
     setResult(QString::number(BitTorrent::Session::instance()->uploadSpeedLimit()));
@@ -122,9 +273,12 @@ void TransferController::banPeersAction()
     checkParams({"peers"});
 
     const QStringList peers = params()["peers"].split('|');
+    QStringList ips;
+    ips.reserve(peers.size());
     for (const QString &peer : peers) {
         const BitTorrent::PeerAddress addr = BitTorrent::PeerAddress::parse(peer.trimmed());
         if (!addr.ip.isNull())
-            BitTorrent::Session::instance()->banIP(addr.ip.toString());
+            ips << addr.ip.toString();
     }
+    BitTorrent::Session::instance()->banIPs(ips);
 }
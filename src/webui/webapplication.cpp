@@ -49,6 +49,7 @@
 #include "base/utils/bytearray.h"
 #include "base/utils/fs.h"
 #include "base/utils/misc.h"
+#include "base/utils/password.h"
 #include "base/utils/random.h"
 #include "base/utils/string.h"
 #include "api/apierror.h"
@@ -135,6 +136,7 @@ WebApplication::~WebApplication()
 {
     // cleanup sessions data
     qDeleteAll(m_sessions);
+    qDeleteAll(m_apiTokenSessions);
 }
 
 void WebApplication::sendWebUIFile()
@@ -273,6 +275,9 @@ void WebApplication::doProcessRequest()
         case QMetaType::QJsonDocument:
             print(result.toJsonDocument().toJson(QJsonDocument::Compact), Http::CONTENT_TYPE_JSON);
             break;
+        case QMetaType::QObjectStar:
+            defer(result.value<QObject *>());
+            break;
         default:
             print(result.toString(), Http::CONTENT_TYPE_TXT);
             break;
@@ -334,6 +339,21 @@ void WebApplication::configure()
     m_authSubnetWhitelist = pref->getWebUiAuthSubnetWhitelist();
     m_sessionTimeout = pref->getWebUISessionTimeout();
 
+    m_apiTokenKey = pref->getWebUIAPITokenKey();
+    m_apiTokens.clear();
+    const QVariantMap apiTokens = pref->getWebUIAPITokens();
+    for (auto it = apiTokens.cbegin(); it != apiTokens.cend(); ++it)
+        m_apiTokens[QByteArray::fromBase64(it.value().toByteArray())] = it.key();
+    // sessions of revoked tokens end immediately
+    Algorithm::removeIf(m_apiTokenSessions, [&apiTokens](const QString &name, const WebSession *session)
+    {
+        if (!apiTokens.contains(name)) {
+            delete session;
+            return true;
+        }
+        return false;
+    });
+
     m_domainList = pref->getServerDomains().split(';', QString::SkipEmptyParts);
     std::for_each(m_domainList.begin(), m_domainList.end(), [](QString &entry) { entry = entry.trimmed(); });
 
@@ -415,8 +435,8 @@ Http::Response WebApplication::processRequest(const Http::Request &request, cons
     m_params.clear();
 
     if (m_request.method == Http::METHOD_GET) {
-        for (auto iter = m_request.query.cbegin(); iter != m_request.query.cend(); ++iter)
-            m_params[iter.key()] = QString::fromUtf8(iter.value());
+        for (const QString &key : asConst(m_request.query.uniqueKeys()))
+            m_params[key] = QString::fromUtf8(m_request.query.value(key));
     }
     else {
         m_params = m_request.posts;
@@ -486,10 +506,44 @@ void WebApplication::sessionInitialize()
         }
     }
 
+    if (!m_currentSession) {
+        const QString authorization = m_request.headers.value(QLatin1String(Http::HEADER_AUTHORIZATION));
+        if (authorization.startsWith(QLatin1String("Bearer "), Qt::CaseInsensitive))
+            m_currentSession = apiTokenSession(authorization.mid(7).trimmed());
+    }
+
     if (!m_currentSession && !isAuthNeeded())
         sessionStart();
 }
 
+// API tokens are random so a fast keyed hash is enough to store them,
+// unlike passwords they don't need expensive PBKDF2 verification.
+// Each token gets its own session which isn't bound to any cookie.
+WebSession *WebApplication::apiTokenSession(const QString &token)
+{
+    if (m_apiTokens.isEmpty() || token.isEmpty())
+        return nullptr;
+
+    const QString name = m_apiTokens.value(Utils::Password::hmacSha256(m_apiTokenKey, token.toLatin1()));
+    if (name.isEmpty()) {
+        qDebug() << Q_FUNC_INFO << "unknown API token!";
+        return nullptr;
+    }
+
+    WebSession *&session = m_apiTokenSessions[name];
+    if (session && session->hasExpired(m_sessionTimeout)) {
+        delete session;
+        session = nullptr;
+    }
+    if (!session) {
+        session = new WebSession(generateSid());
+        session->setData(QLatin1String(SESSION_DATA_API_TOKEN), name);
+    }
+
+    session->updateTimestamp();
+    return session;
+}
+
 QString WebApplication::generateSid() const
 {
     QString sid;
@@ -553,7 +607,11 @@ void WebApplication::sessionEnd()
     cookie.setPath(QLatin1String("/"));
     cookie.setExpirationDate(QDateTime::currentDateTime().addDays(-1));
 
-    delete m_sessions.take(m_currentSession->id());
+    const QString apiTokenName = m_currentSession->getData(QLatin1String(SESSION_DATA_API_TOKEN)).toString();
+    if (apiTokenName.isEmpty())
+        delete m_sessions.take(m_currentSession->id());
+    else
+        delete m_apiTokenSessions.take(apiTokenName);
     m_currentSession = nullptr;
 
     header(Http::HEADER_SET_COOKIE, cookie.toRawForm());
@@ -43,7 +43,7 @@
 #include "base/utils/net.h"
 #include "base/utils/version.h"
 
-constexpr Utils::Version<int, 3, 2> API_VERSION {2, 2, 0};
+constexpr Utils::Version<int, 3, 2> API_VERSION {2, 9, 0};
 
 class APIController;
 class WebApplication;
@@ -110,6 +110,7 @@ private:
     // Session management
     QString generateSid() const;
     void sessionInitialize();
+    WebSession *apiTokenSession(const QString &token);
     bool isAuthNeeded();
     bool isPublicAPI(const QString &scope, const QString &action) const;
 
@@ -118,6 +119,7 @@ private:
 
     // Persistent data
     QHash<QString, WebSession *> m_sessions;
+    QHash<QString, WebSession *> m_apiTokenSessions;
 
     // Current data
     WebSession *m_currentSession = nullptr;
@@ -147,6 +149,8 @@ private:
     bool m_isAuthSubnetWhitelistEnabled;
     QVector<Utils::Net::Subnet> m_authSubnetWhitelist;
     int m_sessionTimeout;
+    QByteArray m_apiTokenKey;
+    QHash<QByteArray, QString> m_apiTokens; // keyed hash -> token name
 
     // security related
     QStringList m_domainList;